@@ -0,0 +1,34 @@
+#include "alloc_count.h"
+#include <stddef.h>
+
+// glibc entry points behind the public allocator symbols. Defining malloc
+// and friends in the executable interposes them for libc as well.
+extern void *__libc_malloc(size_t size);
+extern void *__libc_calloc(size_t count, size_t size);
+extern void *__libc_realloc(void *ptr, size_t size);
+extern void __libc_free(void *ptr);
+
+static unsigned long long allocations = 0;
+
+void *malloc(size_t size) {
+    allocations++;
+    return __libc_malloc(size);
+}
+
+void *calloc(size_t count, size_t size) {
+    allocations++;
+    return __libc_calloc(count, size);
+}
+
+void *realloc(void *ptr, size_t size) {
+    allocations++;
+    return __libc_realloc(ptr, size);
+}
+
+void free(void *ptr) {
+    __libc_free(ptr);
+}
+
+unsigned long long alloc_count(void) {
+    return allocations;
+}
@@ -0,0 +1,8 @@
+#ifndef ALLOC_COUNT_H
+#define ALLOC_COUNT_H
+
+// Number of malloc/calloc/realloc calls made by the whole process,
+// including those made inside libc (fopen, opendir, ...)
+unsigned long long alloc_count(void);
+
+#endif // ALLOC_COUNT_H
@@ -0,0 +1,435 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+#include "sysmon.h"
+#include "panels.h"
+#include "selfstat.h"
+#include "recorder.h"
+#include "query.h"
+#include "batchread.h"
+#include "fixture.h"
+#include "alloc_count.h"
+
+// The instance under test
+static SystemMonitor monitor;
+
+// One benchmarked collector
+typedef struct {
+    const char *name;
+    void (*sample)(void);
+} Collector;
+
+static void sample_cpu(void) {
+    sysmon_update_cpu(&monitor);
+}
+
+static void sample_memory(void) {
+    sysmon_update_memory(&monitor);
+}
+
+static void sample_kernel(void) {
+    sysmon_update_kernel(&monitor);
+}
+
+static void sample_disks(void) {
+    sysmon_update_disks(&monitor);
+}
+
+static void sample_network(void) {
+    sysmon_update_network(&monitor);
+}
+
+static void sample_processes(void) {
+    sysmon_update_processes(&monitor);
+}
+
+static void sample_interrupts(void) {
+    sysmon_update_interrupts(&monitor);
+}
+
+static void sample_netstack(void) {
+    sysmon_update_netstack(&monitor);
+}
+
+static void sample_numa(void) {
+    sysmon_update_numa(&monitor);
+}
+
+// Detail fetches for a screenful of rows, with the cache defeated
+static void fetch_details(void) {
+    for (int i = 0; i < 20 && i < monitor.process_count; i++) {
+        ProcessStats *proc = sysmon_get_process(&monitor, i);
+        memset(proc->detail_ns, 0, sizeof(proc->detail_ns));
+        sysmon_process_details(&monitor, proc, PROCESS_DETAIL_ALL);
+    }
+}
+
+// Ordering a screenful of the process list by CPU, against a full sort
+static void order_top(void) {
+    RenderList list;
+    panels_build_process(&list, &monitor);
+    render_list_top(&list, PROCESS_COLUMN_CPU, true, 20);
+}
+
+static void order_full(void) {
+    RenderList list;
+    panels_build_process(&list, &monitor);
+    render_list_order(&list, PROCESS_COLUMN_CPU, true);
+}
+
+// Scoring a large bank of series, as a fleet-wide detector would
+#define BENCH_SERIES 4096
+
+static AnomalyBank bench_anomalies;
+
+static void score_series(void) {
+    static unsigned int step;
+    step++;
+    for (int i = 0; i < BENCH_SERIES; i++) {
+        anomaly_bank_push(&bench_anomalies, i, 1, (double)((step * 7 + i * 13) % 100));
+    }
+}
+
+static void sample_all(void) {
+    sysmon_update_all(&monitor);
+}
+
+static const Collector collectors[] = {
+    { "cpu",     sample_cpu },
+    { "memory",  sample_memory },
+    { "kernel",  sample_kernel },
+    { "disk",    sample_disks },
+    { "network", sample_network },
+    { "process", sample_processes },
+    { "irq",     sample_interrupts },
+    { "netstack", sample_netstack },
+    { "numa",    sample_numa },
+    { "anomaly", score_series },
+    { "details", fetch_details },
+    { "top20",   order_top },
+    { "sortall", order_full },
+    { "all",     sample_all },
+};
+
+// A recording of days at 1 Hz: a daily CPU cycle with rare spikes, and one
+// hour of blocked tasks on day 10
+static int write_ring(const char *path, int days, unsigned long long end_ns) {
+    unsigned long long samples = (unsigned long long)days * 86400ULL;
+    Recorder rec;
+    if (recorder_open(&rec, path, RECORDER_HEADER_SIZE + (samples + samples / 16) * RECORDER_SLOT_SIZE,
+                      1000000000ULL, 0) != 0) {
+        return -1;
+    }
+
+    int cpu = recorder_metric_column(METRIC_CPU_USAGE);
+    int memory = recorder_metric_column(METRIC_MEM_USAGE);
+    int blocked = recorder_metric_column(METRIC_KERNEL_BLOCKED);
+    RecorderSlot sample;
+    memset(&sample, 0, sizeof(sample));
+    for (unsigned long long i = 0; i < samples; i++) {
+        unsigned long long second = i % 86400ULL;
+        sample.wall_ns = end_ns - (samples - i) * 1000000000ULL;
+        sample.mono_ns = i * 1000000000ULL;
+        sample.values[cpu] = (float)(20 + 15 * (second / 3600 % 12) + (i * 7919 % 97 == 0 ? 40 : 0));
+        sample.values[memory] = (float)(40 + i % 600 / 60);
+        sample.values[blocked] = (float)(i / 3600 == 240);
+        recorder_append(&rec, &sample);
+    }
+    recorder_close(&rec);
+    return 0;
+}
+
+// Queries over a recording: a full scan with percentiles, an hour of it,
+// and a rare condition that the block index mostly rules out
+static void bench_query(const char *root, int days) {
+    char path[600];
+    snprintf(path, sizeof(path), "%s/bench.ring", root);
+    unsigned long long end_ns = 1800000000ULL * 1000000000ULL;
+
+    printf("Writing a %d-day ring at 1 Hz\n", days);
+    unsigned long long start = selfstat_now();
+    if (write_ring(path, days, end_ns) != 0) {
+        fprintf(stderr, "Error: Failed to write ring %s\n", path);
+        return;
+    }
+    printf("%-10s %10d %14.0f\n", "ring-write", days * 86400, (double)(selfstat_now() - start) / (days * 86400.0));
+
+    FILE *sink = fopen("/dev/null", "w");
+    if (!sink) return;
+
+    struct {
+        const char *name;
+        unsigned long long from_ns;
+        unsigned long long bucket_ns;
+        const char *condition;
+    } queries[] = {
+        { "query-all",   0, 86400000000000ULL, NULL },
+        { "query-1h",    end_ns - 22 * 3600000000000ULL, 0, NULL },
+        { "query-where", 0, 0, "kernel.blocked>=1" },
+    };
+
+    printf("%-12s %14s %14s %12s\n", "query", "ms", "samples read", "blocks read");
+    for (size_t q = 0; q < sizeof(queries) / sizeof(queries[0]); q++) {
+        QuerySpec spec;
+        memset(&spec, 0, sizeof(spec));
+        query_parse_columns(&spec, "cpu.usage,mem.usage");
+        query_parse_aggregates(&spec, "min,avg,max,p99");
+        spec.from_ns = queries[q].from_ns;
+        spec.to_ns = queries[q].from_ns ? queries[q].from_ns + 3600000000000ULL : 0;
+        spec.bucket_ns = queries[q].bucket_ns;
+        if (queries[q].condition) query_parse_condition(&spec, queries[q].condition);
+
+        const char *paths[] = { path };
+        QueryStats stats;
+        if (query_run(&spec, paths, 1, sink, &stats) != 0) {
+            fprintf(stderr, "Error: Query %s failed\n", queries[q].name);
+            continue;
+        }
+        printf("%-12s %14.1f %14llu %8llu/%llu\n", queries[q].name, stats.elapsed_ns / 1e6, stats.samples,
+               stats.blocks_read, stats.blocks);
+    }
+    fclose(sink);
+}
+
+// Real proc and sysfs files, which regenerate their text on every read
+// like the per-process and per-device files collectors poll
+#define BENCH_FILE_SIZE 1024
+
+static int collect_files(char (*paths)[64], int max) {
+    static const char *pid_files[] = { "stat", "statm", "io" };
+    int count = 0;
+
+    DIR *dir = opendir("/proc");
+    struct dirent *entry;
+    while (dir && count < max && (entry = readdir(dir)) != NULL) {
+        if (!isdigit((unsigned char)entry->d_name[0])) continue;
+        for (size_t f = 0; f < sizeof(pid_files) / sizeof(pid_files[0]) && count < max; f++) {
+            snprintf(paths[count], 64, "/proc/%.16s/%s", entry->d_name, pid_files[f]);
+            if (access(paths[count], R_OK) == 0) count++;
+        }
+    }
+    if (dir) closedir(dir);
+
+    dir = opendir("/sys/class/net");
+    while (dir && count < max && (entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] == '.') continue;
+        snprintf(paths[count], 64, "/sys/class/net/%.16s/statistics/rx_bytes", entry->d_name);
+        if (access(paths[count], R_OK) == 0) count++;
+    }
+    if (dir) closedir(dir);
+    return count;
+}
+
+// One tick of count files: open/read/close each, one pread each on cached
+// descriptors, and io_uring batches on the same descriptors
+static void bench_files(int count, int iterations) {
+    // Every file stays open, so lift the soft descriptor limit
+    struct rlimit limit;
+    if (getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur < limit.rlim_max) {
+        limit.rlim_cur = limit.rlim_max;
+        setrlimit(RLIMIT_NOFILE, &limit);
+    }
+
+    char (*unique)[64] = malloc(4096 * sizeof(*unique));
+    BatchRead *reads = calloc((size_t)count, sizeof(BatchRead));
+    char *buffers = malloc((size_t)count * BENCH_FILE_SIZE);
+    int distinct = unique ? collect_files(unique, 4096) : 0;
+    if (!reads || !buffers || distinct == 0) {
+        fprintf(stderr, "Error: No readable proc files to benchmark\n");
+        free(unique);
+        free(reads);
+        free(buffers);
+        return;
+    }
+
+    printf("Reading %d files (%d distinct) per tick\n", count, distinct);
+    printf("%-12s %10s %14s %14s %10s\n", "files", "ticks", "us/tick", "syscalls/tick", "read");
+
+    // Baseline: what a collector without cached descriptors does
+    int ok = 0;
+    unsigned long long start = selfstat_now();
+    for (int it = 0; it < iterations; it++) {
+        ok = 0;
+        for (int i = 0; i < count; i++) {
+            int fd = open(unique[i % distinct], O_RDONLY | O_CLOEXEC);
+            if (fd < 0) continue;
+            if (read(fd, buffers + (size_t)i * BENCH_FILE_SIZE, BENCH_FILE_SIZE - 1) > 0) ok++;
+            close(fd);
+        }
+    }
+    printf("%-12s %10d %14.1f %14.1f %10d\n", "open-read", iterations,
+           (double)(selfstat_now() - start) / iterations / 1000.0, 3.0 * count, ok);
+
+    // The batched readers share one descriptor per file, opened once
+    int opened = 0;
+    for (; opened < count; opened++) {
+        reads[opened].fd = open(unique[opened % distinct], O_RDONLY | O_CLOEXEC);
+        if (reads[opened].fd < 0) break;
+        reads[opened].buffer = buffers + (size_t)opened * BENCH_FILE_SIZE;
+        reads[opened].size = BENCH_FILE_SIZE;
+    }
+    if (opened < count) printf("Only %d descriptors could be opened\n", opened);
+
+    for (int uring = 0; uring <= 1; uring++) {
+        BatchReader reader;
+        batch_reader_init(&reader, uring);
+        if (uring && !batch_reader_uses_uring(&reader)) {
+            printf("%-12s unavailable\n", "io_uring");
+            batch_reader_free(&reader);
+            break;
+        }
+
+        batch_read_run(&reader, reads, opened);
+        unsigned long long syscalls = reader.syscalls;
+        start = selfstat_now();
+        for (int it = 0; it < iterations; it++) {
+            ok = batch_read_run(&reader, reads, opened);
+        }
+        printf("%-12s %10d %14.1f %14.1f %10d\n", uring ? "io_uring" : "pread", iterations,
+               (double)(selfstat_now() - start) / iterations / 1000.0,
+               (double)(reader.syscalls - syscalls) / iterations, ok);
+        batch_reader_free(&reader);
+    }
+
+    for (int i = 0; i < opened; i++) {
+        close(reads[i].fd);
+    }
+    free(unique);
+    free(reads);
+    free(buffers);
+}
+
+// Meminfo lines are resolved by binary search, so the hand-kept key table
+// must stay in strcmp order as keys are added
+static bool meminfo_keys_sorted(void) {
+    for (int k = 1; k < MEMINFO_KEY_COUNT; k++) {
+        if (strcmp(sysmon_meminfo_name(k - 1), sysmon_meminfo_name(k)) >= 0) {
+            fprintf(stderr, "Error: MEMINFO_KEYS is out of strcmp order at \"%s\"\n", sysmon_meminfo_name(k));
+            return false;
+        }
+    }
+    return true;
+}
+
+static void usage(const char *program) {
+    printf("Usage: %s [-n iterations] [--pids N] [--interfaces N] [--cpus N] [--mounts N] [--ring-days N]\n"
+           "          [--nodes N] [--files N]\n", program);
+}
+
+int main(int argc, char *argv[]) {
+    FixtureSpec spec = FIXTURE_DEFAULT_SPEC;
+    int iterations = 200;
+    int ring_days = 0;
+    int files = 0;
+
+    for (int i = 1; i < argc; i++) {
+        int *target = NULL;
+        if (strcmp(argv[i], "-n") == 0) target = &iterations;
+        else if (strcmp(argv[i], "--pids") == 0) target = &spec.pids;
+        else if (strcmp(argv[i], "--interfaces") == 0) target = &spec.interfaces;
+        else if (strcmp(argv[i], "--cpus") == 0) target = &spec.cpus;
+        else if (strcmp(argv[i], "--mounts") == 0) target = &spec.mounts;
+        else if (strcmp(argv[i], "--nodes") == 0) target = &spec.nodes;
+        else if (strcmp(argv[i], "--ring-days") == 0) target = &ring_days;
+        else if (strcmp(argv[i], "--files") == 0) target = &files;
+
+        if (!target || i + 1 >= argc || atoi(argv[i + 1]) <= 0) {
+            usage(argv[0]);
+            return 1;
+        }
+        *target = atoi(argv[++i]);
+    }
+
+    if (!meminfo_keys_sorted()) return 1;
+
+    char root[512];
+    printf("Generating fixture: %d pids, %d interfaces, %d cpus, %d mounts, %d nodes\n",
+           spec.pids, spec.interfaces, spec.cpus, spec.mounts, spec.nodes);
+    if (fixture_create(&spec, root, sizeof(root)) != 0) {
+        fprintf(stderr, "Error: Failed to create fixture tree\n");
+        return 1;
+    }
+
+    char proc_root[600], sys_root[600];
+    snprintf(proc_root, sizeof(proc_root), "%s/proc", root);
+    snprintf(sys_root, sizeof(sys_root), "%s/sys", root);
+
+    if (sysmon_init(&monitor) != 0) {
+        fprintf(stderr, "Error: Failed to initialize system monitor\n");
+        fixture_destroy(root);
+        return 1;
+    }
+    sysmon_set_roots(&monitor, proc_root, sys_root);
+    monitor.collect_processes = true;
+    monitor.collect_interrupts = true;
+    monitor.collect_netstack = true;
+    monitor.collect_numa = true;
+    if (anomaly_bank_init(&bench_anomalies, 1000000000ULL, ANOMALY_DEFAULT_Z, 1.0, true) != 0 ||
+        anomaly_bank_reserve(&bench_anomalies, BENCH_SERIES) != 0) {
+        fprintf(stderr, "Error: Failed to allocate anomaly detectors\n");
+        sysmon_cleanup(&monitor);
+        fixture_destroy(root);
+        return 1;
+    }
+
+    printf("%-10s %10s %14s %14s\n", "collector", "samples", "ns/sample", "allocs/sample");
+
+    for (size_t c = 0; c < sizeof(collectors) / sizeof(collectors[0]); c++) {
+        const Collector *collector = &collectors[c];
+
+        // Warm up tables and previous-sample state
+        collector->sample();
+        collector->sample();
+
+        unsigned long long allocs = alloc_count();
+        unsigned long long start = selfstat_now();
+
+        for (int i = 0; i < iterations; i++) {
+            collector->sample();
+        }
+
+        unsigned long long elapsed = selfstat_now() - start;
+        allocs = alloc_count() - allocs;
+
+        printf("%-10s %10d %14.0f %14.1f\n", collector->name, iterations,
+               (double)elapsed / iterations, (double)allocs / iterations);
+    }
+
+    printf("entries: %d disks, %d interfaces, %d processes, %d irq lines\n", monitor.disk_count,
+           monitor.interface_count, monitor.process_count, monitor.interrupts.irqs.num_lines);
+
+    // Process scans over the fixture, with the stat files read through io_uring
+    if (sysmon_set_io_uring(&monitor, true)) {
+        sample_processes();
+        sample_processes();
+        unsigned long long start = selfstat_now();
+        for (int i = 0; i < iterations; i++) {
+            sample_processes();
+        }
+        printf("%-10s %10d %14.0f\n", "proc-uring", iterations, (double)(selfstat_now() - start) / iterations);
+        sysmon_set_io_uring(&monitor, false);
+    }
+
+    // The recording is about 42 MB a day, so only on request
+    if (ring_days > 0) {
+        bench_query(root, ring_days);
+    }
+
+    anomaly_bank_free(&bench_anomalies);
+    sysmon_cleanup(&monitor);
+    fixture_destroy(root);
+
+    // After cleanup, so the process scan's cached descriptors are closed
+    if (files > 0) {
+        bench_files(files, iterations);
+    }
+    return 0;
+}
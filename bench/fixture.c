@@ -0,0 +1,431 @@
+#define _XOPEN_SOURCE 700
+
+#include "fixture.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ftw.h>
+#include <sys/stat.h>
+
+// Create a directory below the fixture root
+static int make_dir(const char *root, const char *relative) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", root, relative);
+    if (mkdir(path, 0755) != 0) {
+        perror(path);
+        return -1;
+    }
+    return 0;
+}
+
+static FILE* open_file(const char *root, const char *relative) {
+    char path[1024];
+    snprintf(path, sizeof(path), "%s/%s", root, relative);
+
+    FILE *fp = fopen(path, "w");
+    if (!fp) {
+        perror(path);
+    }
+    return fp;
+}
+
+static int write_stat(const char *root, const FixtureSpec *spec) {
+    FILE *fp = open_file(root, "proc/stat");
+    if (!fp) return -1;
+
+    fprintf(fp, "cpu  %d %d %d %d %d 0 %d 0 0 0\n",
+            spec->cpus * 10423, spec->cpus * 37, spec->cpus * 3311,
+            spec->cpus * 884210, spec->cpus * 512, spec->cpus * 120);
+    for (int cpu = 0; cpu < spec->cpus; cpu++) {
+        fprintf(fp, "cpu%d 10423 37 3311 884210 512 0 120 0 0 0\n", cpu);
+    }
+
+    // Wide interrupt line, as on large hosts
+    fprintf(fp, "intr 918273645");
+    for (int irq = 0; irq < 512; irq++) {
+        fprintf(fp, " %d", (irq * 7919) % 100000);
+    }
+    fprintf(fp, "\nctxt 1928374650\nbtime 1700000000\nprocesses %d\n", spec->pids * 3);
+    fprintf(fp, "procs_running 3\nprocs_blocked 0\n");
+    fprintf(fp, "softirq 5566778 1 2233 4 556677 8899 0 1122 334455 6 778899\n");
+
+    fclose(fp);
+    return 0;
+}
+
+static int write_meminfo(const char *root) {
+    static const char *lines[] = {
+        "MemTotal:       263855232 kB", "MemFree:        18222144 kB",
+        "MemAvailable:   201726400 kB", "Buffers:         2361088 kB",
+        "Cached:         176203776 kB", "SwapCached:         12544 kB",
+        "Active:         98224128 kB", "Inactive:       131512320 kB",
+        "Active(anon):   41262848 kB", "Inactive(anon):  11763712 kB",
+        "Active(file):   56961280 kB", "Inactive(file): 119748608 kB",
+        "Unevictable:       36864 kB", "Mlocked:           36864 kB",
+        "SwapTotal:       8388604 kB", "SwapFree:        8214012 kB",
+        "Dirty:              9216 kB", "Writeback:             0 kB",
+        "AnonPages:      53027328 kB", "Mapped:          2879488 kB",
+        "Shmem:           1441792 kB", "KReclaimable:    9437184 kB",
+        "Slab:           13631488 kB", "SReclaimable:    9437184 kB",
+        "SUnreclaim:      4194304 kB", "KernelStack:       73728 kB",
+        "PageTables:       421888 kB", "NFS_Unstable:          0 kB",
+        "Bounce:                0 kB", "WritebackTmp:          0 kB",
+        "CommitLimit:   140316220 kB", "Committed_AS:   92274688 kB",
+        "VmallocTotal:   34359738367 kB", "VmallocUsed:      589824 kB",
+        "VmallocChunk:          0 kB", "Percpu:           344064 kB",
+        "HardwareCorrupted:     0 kB", "AnonHugePages:   6291456 kB",
+        "ShmemHugePages:        0 kB", "ShmemPmdMapped:        0 kB",
+        "FileHugePages:         0 kB", "FilePmdMapped:         0 kB",
+        "HugePages_Total:       0", "HugePages_Free:        0",
+        "HugePages_Rsvd:        0", "HugePages_Surp:        0",
+        "Hugepagesize:       2048 kB", "Hugetlb:               0 kB",
+        "DirectMap4k:     2359296 kB", "DirectMap2M:   104857600 kB",
+        "DirectMap1G:   163577856 kB",
+    };
+
+    FILE *fp = open_file(root, "proc/meminfo");
+    if (!fp) return -1;
+
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+        fprintf(fp, "%s\n", lines[i]);
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+static int write_vmstat(const char *root) {
+    static const char *lines[] = {
+        "nr_free_pages 4555536", "nr_zone_inactive_anon 2940928", "nr_zone_active_anon 10315712",
+        "nr_zone_inactive_file 29937152", "nr_zone_active_file 14240320", "nr_dirty 2304",
+        "nr_writeback 0", "nr_shmem 360448", "workingset_refault_anon 1204",
+        "workingset_refault_file 9981234", "pgpgin 112233445", "pgpgout 556677889",
+        "pswpin 40213", "pswpout 98112", "pgalloc_normal 9182736455", "pgfree 9283746501",
+        "pgactivate 1122334", "pgdeactivate 223344", "pgfault 7788990011", "pgmajfault 334455",
+        "pgrefill 4455667", "pgsteal_kswapd 8899001", "pgsteal_direct 112233",
+        "pgsteal_khugepaged 0", "pgscan_kswapd 9900112", "pgscan_direct 223344",
+        "pgscan_khugepaged 0", "pgscan_direct_throttle 12", "pgscan_anon 3344556",
+        "pgscan_file 6778900", "pgsteal_anon 2233445", "pgsteal_file 6778899",
+        "pginodesteal 0", "slabs_scanned 5566778", "kswapd_inodesteal 0",
+        "pageoutrun 33445", "pgrotated 7788", "thp_fault_alloc 1122", "thp_collapse_alloc 334",
+    };
+
+    FILE *fp = open_file(root, "proc/vmstat");
+    if (!fp) return -1;
+
+    for (size_t i = 0; i < sizeof(lines) / sizeof(lines[0]); i++) {
+        fprintf(fp, "%s\n", lines[i]);
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+// Header of CPU columns, as /proc/interrupts and /proc/softirqs print it
+static void write_cpu_header(FILE *fp, int cpus, int indent) {
+    fprintf(fp, "%*s", indent, "");
+    for (int cpu = 0; cpu < cpus; cpu++) {
+        fprintf(fp, "CPU%-8d", cpu);
+    }
+    fprintf(fp, "\n");
+}
+
+static int write_interrupts(const char *root, const FixtureSpec *spec) {
+    static const char *arch_lines[][2] = {
+        { "NMI", "Non-maskable interrupts" }, { "LOC", "Local timer interrupts" },
+        { "RES", "Rescheduling interrupts" }, { "CAL", "Function call interrupts" },
+        { "TLB", "TLB shootdowns" }, { "MCE", "Machine check exceptions" },
+    };
+
+    FILE *fp = open_file(root, "proc/interrupts");
+    if (!fp) return -1;
+
+    write_cpu_header(fp, spec->cpus, 4);
+
+    // Legacy lines, then one NIC queue per CPU with every queue on cpu0
+    for (int irq = 0; irq < 16 + spec->cpus; irq++) {
+        fprintf(fp, "%4d:", irq);
+        for (int cpu = 0; cpu < spec->cpus; cpu++) {
+            unsigned int count = irq >= 16 && cpu == 0 ? 4000000000u - irq : (unsigned int)(irq * 131 + cpu);
+            fprintf(fp, " %10u", count);
+        }
+        if (irq < 16) {
+            fprintf(fp, "  IO-APIC %4d-edge      i8042\n", irq);
+        } else {
+            fprintf(fp, "  PCI-MSI %d-edge      eth0-TxRx-%d\n", 524288 + irq, irq - 16);
+        }
+    }
+
+    // Local timer counts outgrow the ten-digit columns on long uptimes
+    for (size_t i = 0; i < sizeof(arch_lines) / sizeof(arch_lines[0]); i++) {
+        fprintf(fp, " %s:", arch_lines[i][0]);
+        for (int cpu = 0; cpu < spec->cpus; cpu++) {
+            unsigned long long count = i == 1 ? 12345678901ULL + cpu : (unsigned long long)cpu * 17;
+            fprintf(fp, " %10llu", count);
+        }
+        fprintf(fp, "   %s\n", arch_lines[i][1]);
+    }
+    fprintf(fp, " ERR:          0\n MIS:          0\n");
+
+    fclose(fp);
+    return 0;
+}
+
+static int write_softirqs(const char *root, const FixtureSpec *spec) {
+    static const char *names[] = {
+        "HI", "TIMER", "NET_TX", "NET_RX", "BLOCK", "IRQ_POLL", "TASKLET", "SCHED", "HRTIMER", "RCU",
+    };
+
+    FILE *fp = open_file(root, "proc/softirqs");
+    if (!fp) return -1;
+
+    write_cpu_header(fp, spec->cpus, 20);
+    for (size_t i = 0; i < sizeof(names) / sizeof(names[0]); i++) {
+        fprintf(fp, "%12s:", names[i]);
+        for (int cpu = 0; cpu < spec->cpus; cpu++) {
+            fprintf(fp, " %10u", (unsigned int)(i * 1000003 + cpu * 7));
+        }
+        fprintf(fp, "\n");
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+static int write_net_stack(const char *root, const FixtureSpec *spec) {
+    FILE *fp = open_file(root, "proc/net/softnet_stat");
+    if (!fp) return -1;
+
+    for (int cpu = 0; cpu < spec->cpus; cpu++) {
+        fprintf(fp, "%08x %08x %08x 00000000 00000000 00000000 00000000 00000000 00000000 "
+                    "00000000 00000000 00000000 %08x 00000000 00000000\n",
+                cpu * 104729, cpu % 7, cpu % 13, cpu);
+    }
+    fclose(fp);
+
+    fp = open_file(root, "proc/net/snmp");
+    if (!fp) return -1;
+    fprintf(fp, "Ip: Forwarding DefaultTTL InReceives InHdrErrors InAddrErrors ForwDatagrams InUnknownProtos "
+                "InDiscards InDelivers OutRequests OutDiscards OutNoRoutes ReasmTimeout ReasmReqds ReasmOKs "
+                "ReasmFails FragOKs FragFails FragCreates OutTransmits\n"
+                "Ip: 1 64 9182736455 0 12 0 0 3 9182736400 8877665544 0 0 0 0 0 0 0 0 0 8877665544\n"
+                "Tcp: RtoAlgorithm RtoMin RtoMax MaxConn ActiveOpens PassiveOpens AttemptFails EstabResets "
+                "CurrEstab InSegs OutSegs RetransSegs InErrs OutRsts InCsumErrors\n"
+                "Tcp: 1 200 120000 -1 4455667 8899001 1234 5678 %d 9182736000 8877665000 1122334 12 44556 0\n"
+                "Udp: InDatagrams NoPorts InErrors OutDatagrams RcvbufErrors SndbufErrors InCsumErrors "
+                "IgnoredMulti MemErrors\n"
+                "Udp: 223344556 1234 5678 112233445 5600 0 0 0 0\n",
+            spec->pids);
+    fclose(fp);
+
+    fp = open_file(root, "proc/net/netstat");
+    if (!fp) return -1;
+    fprintf(fp, "TcpExt: SyncookiesSent SyncookiesRecv SyncookiesFailed EmbryonicRsts PruneCalled RcvPruned "
+                "OfoPruned OutOfWindowIcmps LockDroppedIcmps ArpFilter TW TWRecycled TWKilled PAWSActive "
+                "PAWSEstab DelayedACKs DelayedACKLocked DelayedACKLost ListenOverflows ListenDrops "
+                "TCPBacklogDrop TCPTimeouts TCPLossProbes\n"
+                "TcpExt: 0 0 0 12 0 0 0 0 0 0 998877 0 0 0 0 5566778 12 334 4455 4460 77 88990 12345\n"
+                "IpExt: InNoRoutes InTruncatedPkts InMcastPkts OutMcastPkts InOctets OutOctets\n"
+                "IpExt: 0 0 1234 567 918273645546 887766554433\n");
+    fclose(fp);
+
+    fp = open_file(root, "proc/net/sockstat");
+    if (!fp) return -1;
+    fprintf(fp, "sockets: used %d\nTCP: inuse %d orphan 3 tw 4411 alloc %d mem 2291\n"
+                "UDP: inuse 24 mem 17\nUDPLITE: inuse 0\nRAW: inuse 1\nFRAG: inuse 0 memory 0\n",
+            spec->pids * 2, spec->pids, spec->pids + 40);
+    fclose(fp);
+
+    return 0;
+}
+
+static int write_net_dev(const char *root, const FixtureSpec *spec) {
+    FILE *fp = open_file(root, "proc/net/dev");
+    if (!fp) return -1;
+
+    fprintf(fp, "Inter-|   Receive                                                |  Transmit\n");
+    fprintf(fp, " face |bytes    packets errs drop fifo frame compressed multicast|"
+                "bytes    packets errs drop fifo colls carrier compressed\n");
+    fprintf(fp, "    lo: 912837465  817263    0    0    0     0          0         0 "
+                "912837465  817263    0    0    0     0       0          0\n");
+
+    for (int i = 0; i < spec->interfaces; i++) {
+        unsigned long long base = 1000003ULL * (i + 1);
+        fprintf(fp, "veth%05d: %llu %llu 0 0 0 0 0 0 %llu %llu 0 0 0 0 0 0\n",
+                i, base * 1500, base, base * 900, base / 2);
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+// Node directories with the files the NUMA collector reads; CPUs are dealt
+// out in contiguous ranges as on most multi-socket hosts
+static int write_nodes(const char *root, const FixtureSpec *spec) {
+    if (make_dir(root, "sys/devices") != 0 || make_dir(root, "sys/devices/system") != 0 ||
+        make_dir(root, "sys/devices/system/node") != 0) {
+        return -1;
+    }
+
+    int nodes = spec->nodes > 0 ? spec->nodes : 1;
+    int per_node = (spec->cpus + nodes - 1) / nodes;
+    for (int node = 0; node < nodes; node++) {
+        char relative[96];
+        snprintf(relative, sizeof(relative), "sys/devices/system/node/node%d", node);
+        if (make_dir(root, relative) != 0) return -1;
+
+        snprintf(relative, sizeof(relative), "sys/devices/system/node/node%d/cpulist", node);
+        FILE *fp = open_file(root, relative);
+        if (!fp) return -1;
+        int first = node * per_node;
+        int last = first + per_node - 1 < spec->cpus - 1 ? first + per_node - 1 : spec->cpus - 1;
+        if (first <= last) fprintf(fp, "%d-%d", first, last);
+        fputc('\n', fp);
+        fclose(fp);
+
+        // The last node is nearly full and reclaiming
+        unsigned long long total = 67108864ULL;
+        unsigned long long free_kb = node == nodes - 1 ? 262144ULL : 41943040ULL - node * 1048576ULL;
+        snprintf(relative, sizeof(relative), "sys/devices/system/node/node%d/meminfo", node);
+        fp = open_file(root, relative);
+        if (!fp) return -1;
+        fprintf(fp, "Node %d MemTotal:       %llu kB\nNode %d MemFree:        %llu kB\n"
+                    "Node %d MemUsed:        %llu kB\nNode %d SwapCached:          0 kB\n"
+                    "Node %d Active:         %llu kB\nNode %d Inactive:       %llu kB\n"
+                    "Node %d Dirty:              1024 kB\nNode %d Writeback:             0 kB\n"
+                    "Node %d FilePages:      %llu kB\nNode %d Mapped:          524288 kB\n"
+                    "Node %d AnonPages:      %llu kB\nNode %d Shmem:            65536 kB\n"
+                    "Node %d KernelStack:     32768 kB\nNode %d PageTables:     131072 kB\n"
+                    "Node %d Slab:           1048576 kB\nNode %d SReclaimable:    786432 kB\n"
+                    "Node %d SUnreclaim:      262144 kB\nNode %d HugePages_Total:     0\n"
+                    "Node %d HugePages_Free:      0\nNode %d HugePages_Surp:      0\n",
+                node, total, node, free_kb, node, total - free_kb, node,
+                node, (total - free_kb) / 2, node, (total - free_kb) / 4, node, node,
+                node, (total - free_kb) / 3, node, node, (total - free_kb) / 2, node,
+                node, node, node, node, node, node, node, node);
+        fclose(fp);
+
+        snprintf(relative, sizeof(relative), "sys/devices/system/node/node%d/numastat", node);
+        fp = open_file(root, relative);
+        if (!fp) return -1;
+        fprintf(fp, "numa_hit %llu\nnuma_miss %llu\nnuma_foreign %llu\ninterleave_hit %d\n"
+                    "local_node %llu\nother_node %llu\n",
+                9182736455ULL + node, 1234567ULL * node, 7654321ULL * node, 40960 + node,
+                9182000000ULL + node, 736455ULL * (node + 1));
+        fclose(fp);
+    }
+    return 0;
+}
+
+// Mount points are real directories inside the fixture so statvfs succeeds
+static int write_mounts(const char *root, const FixtureSpec *spec) {
+    if (make_dir(root, "mnt") != 0) return -1;
+
+    FILE *fp = open_file(root, "proc/mounts");
+    if (!fp) return -1;
+
+    fprintf(fp, "proc /proc proc rw,nosuid,nodev,noexec,relatime 0 0\n");
+    fprintf(fp, "sysfs /sys sysfs rw,nosuid,nodev,noexec,relatime 0 0\n");
+
+    for (int i = 0; i < spec->mounts; i++) {
+        char relative[64];
+        snprintf(relative, sizeof(relative), "mnt/vol%04d", i);
+        if (make_dir(root, relative) != 0) {
+            fclose(fp);
+            return -1;
+        }
+        fprintf(fp, "/dev/mapper/vg-vol%04d %s/%s ext4 rw,relatime 0 0\n", i, root, relative);
+    }
+
+    fclose(fp);
+    return 0;
+}
+
+static int write_pids(const char *root, const FixtureSpec *spec) {
+    for (int i = 0; i < spec->pids; i++) {
+        int pid = 100 + i * 3;
+        char relative[64];
+
+        snprintf(relative, sizeof(relative), "proc/%d", pid);
+        if (make_dir(root, relative) != 0) return -1;
+
+        snprintf(relative, sizeof(relative), "proc/%d/stat", pid);
+        FILE *fp = open_file(root, relative);
+        if (!fp) return -1;
+
+        fprintf(fp, "%d (worker-%d) S 1 %d %d 0 -1 4194560 %d 0 %d 0 %d %d 0 0 20 0 4 0 %d "
+                    "%d %d 18446744073709551615 1 1 0 0 0 0 0 4096 17410 0 0 0 17 %d 0 0 0 0 0 "
+                    "0 0 0 0 0 0 0 0 0\n",
+                pid, i, pid, pid, i * 13, i % 7, i * 31 % 100000, i * 17 % 50000,
+                1000 + i, (i % 512 + 16) * 1048576, (i % 256 + 4) * 256, i % spec->cpus);
+        fclose(fp);
+
+        // Detail files, read only for rows on screen
+        snprintf(relative, sizeof(relative), "proc/%d/smaps_rollup", pid);
+        fp = open_file(root, relative);
+        if (!fp) return -1;
+        fprintf(fp, "00400000-7ffffffff000 ---p 00000000 00:00 0 [rollup]\n"
+                    "Rss:               %d kB\nPss:               %d kB\n"
+                    "Shared_Clean:       512 kB\nPrivate_Dirty:     %d kB\n"
+                    "Referenced:        %d kB\nAnonymous:         %d kB\n"
+                    "Swap:              %d kB\nSwapPss:           %d kB\nLocked:              0 kB\n",
+                (i % 256 + 4) * 1024, (i % 256 + 2) * 1024, (i % 256) * 512,
+                (i % 256 + 4) * 1024, (i % 256) * 512, i % 64, i % 64);
+        fclose(fp);
+
+        snprintf(relative, sizeof(relative), "proc/%d/io", pid);
+        fp = open_file(root, relative);
+        if (!fp) return -1;
+        fprintf(fp, "rchar: %d\nwchar: %d\nsyscr: %d\nsyscw: %d\n"
+                    "read_bytes: %d\nwrite_bytes: %d\ncancelled_write_bytes: 0\n",
+                i * 4096, i * 1024, i * 8, i * 2, i * 512, i * 256);
+        fclose(fp);
+
+        snprintf(relative, sizeof(relative), "proc/%d/fd", pid);
+        if (make_dir(root, relative) != 0) return -1;
+        for (int fd = 0; fd < 3; fd++) {
+            snprintf(relative, sizeof(relative), "proc/%d/fd/%d", pid, fd);
+            fp = open_file(root, relative);
+            if (!fp) return -1;
+            fclose(fp);
+        }
+    }
+
+    return 0;
+}
+
+int fixture_create(const FixtureSpec *spec, char *root, size_t root_size) {
+    if (!spec || !root || root_size < 32) return -1;
+
+    const char *tmp = getenv("TMPDIR");
+    snprintf(root, root_size, "%s/pisysmon-fixture-XXXXXX", tmp ? tmp : "/tmp");
+    if (!mkdtemp(root)) {
+        perror("mkdtemp");
+        return -1;
+    }
+
+    if (make_dir(root, "proc") != 0 || make_dir(root, "proc/net") != 0 ||
+        make_dir(root, "sys") != 0 ||
+        write_stat(root, spec) != 0 || write_meminfo(root) != 0 || write_vmstat(root) != 0 ||
+        write_interrupts(root, spec) != 0 || write_softirqs(root, spec) != 0 ||
+        write_net_dev(root, spec) != 0 || write_net_stack(root, spec) != 0 ||
+        write_mounts(root, spec) != 0 || write_nodes(root, spec) != 0 ||
+        write_pids(root, spec) != 0) {
+        fixture_destroy(root);
+        return -1;
+    }
+
+    return 0;
+}
+
+static int remove_entry(const char *path, const struct stat *sb, int type, struct FTW *ftw) {
+    (void)sb;
+    (void)type;
+    (void)ftw;
+    return remove(path);
+}
+
+void fixture_destroy(const char *root) {
+    if (!root || !root[0]) return;
+    nftw(root, remove_entry, 32, FTW_DEPTH | FTW_PHYS);
+}
@@ -0,0 +1,23 @@
+#ifndef FIXTURE_H
+#define FIXTURE_H
+
+#include <stddef.h>
+
+// Size of a generated procfs/sysfs tree
+typedef struct {
+    int pids;
+    int interfaces;
+    int cpus;
+    int mounts;
+    int nodes;                // NUMA nodes, splitting the CPUs evenly
+} FixtureSpec;
+
+// Large-host defaults used by the benchmark suite
+#define FIXTURE_DEFAULT_SPEC { 10000, 1000, 256, 500, 4 }
+
+// Build a tree under a fresh temporary directory. The procfs root is
+// <root>/proc and the sysfs root is <root>/sys.
+int fixture_create(const FixtureSpec *spec, char *root, size_t root_size);
+void fixture_destroy(const char *root);
+
+#endif // FIXTURE_H
@@ -0,0 +1,49 @@
+#ifndef ALERT_H
+#define ALERT_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "sysmon.h"
+
+// Subsystem a rule watches, used to highlight the matching component
+typedef enum {
+    ALERT_SUBSYSTEM_CPU = 0,
+    ALERT_SUBSYSTEM_MEMORY,
+    ALERT_SUBSYSTEM_DISK,
+    ALERT_SUBSYSTEM_NETWORK,
+    ALERT_SUBSYSTEM_COUNT
+} AlertSubsystem;
+
+// Rule syntax, one rule per line ('#' starts a comment):
+//
+//   <metric> <op> <value>[unit] [for <duration>] [clear <value>[unit]]
+//            [cooldown <duration>] [run <shell command>]
+//
+// Metrics: any name of the registry in metrics.h, e.g. cpu.usage,
+// mem.available, kernel.blocked; per-device metrics take the mount point or
+// interface between prefix and field: disk.<mount>.usage,
+// net.<iface>.rx_rate. Operators: > >= < <= == !=.
+// Units: % for percentages, Kbps/Mbps/Gbps for rates, KB/MB/GB/TB for sizes.
+// Durations: ms, s, m, h (a bare number is seconds).
+//
+// A rule fires once its condition has held for the "for" duration and stays
+// firing until the value crosses the "clear" threshold (hysteresis). The
+// cooldown only rate-limits the "run" hook: a rule that clears and fires
+// again within it shows as firing, but its hook does not run again until
+// the cooldown has passed.
+
+// Compile rules against a monitor, which must outlive them; errors are
+// written to err_buffer and -1 is returned
+int alert_add_rule(const SystemMonitor *mon, const char *text, char *err_buffer, size_t err_size);
+int alert_load_file(const SystemMonitor *mon, const char *path, char *err_buffer, size_t err_size);
+void alert_clear_rules(void);
+int alert_rule_count(void);
+
+// Evaluate every rule against its monitor, right after sysmon_update_all
+void alert_evaluate(unsigned long long now_ns);
+
+// Results of the last evaluation
+int alert_firing_count(void);
+bool alert_subsystem_firing(AlertSubsystem subsystem);
+
+#endif // ALERT_H
@@ -0,0 +1,90 @@
+#ifndef ANOMALY_H
+#define ANOMALY_H
+
+#include <stdbool.h>
+#include <stdio.h>
+
+// Time-of-day slots of the seasonal baseline (30 minutes each)
+#define ANOMALY_SEASON_SLOTS 48
+
+// Samples before a series may be flagged
+#define ANOMALY_WARMUP 30
+
+#define ANOMALY_DEFAULT_Z 3.5
+
+// Verdict for the last sample of a series
+typedef struct {
+    double mean;                // EWMA before the sample
+    double stddev;              // Of that EWMA, without the floor z uses
+    double z;                   // Against the EWMA
+    double seasonal_z;          // Against this time of day, 0 if untrained
+    bool seasonal_ready;
+    bool anomalous;
+} AnomalyState;
+
+// Per-series detector state, fixed size
+typedef struct {
+    float mean;
+    float var;
+    float scored_mean;          // mean and var the last sample was scored against
+    float scored_var;
+    float z;
+    float seasonal_z;
+    unsigned int count;
+    unsigned int tag;           // Owner generation, as in window banks
+    bool anomalous;
+    bool seasonal_ready;
+} AnomalySeries;
+
+// One slot of the seasonal baseline
+typedef struct {
+    float mean;
+    float var;
+    unsigned int count;
+} SeasonSlot;
+
+// A bank of streaming detectors indexed like a counter or window bank. Each
+// series keeps an EWMA mean and variance and flags samples whose z-score
+// passes the threshold. With a seasonal baseline, a sample is only flagged
+// when it is also unusual for this time of day, so a nightly backup stops
+// paging once it has been seen for a day.
+typedef struct {
+    AnomalySeries *series;
+    SeasonSlot *season;         // allocated * ANOMALY_SEASON_SLOTS
+    bool seasonal;              // Keep a time-of-day baseline
+    int count;
+    int allocated;
+    double alpha;               // EWMA weight of a new sample
+    double season_alpha;        // Slower weight for the seasonal slots
+    unsigned int season_warmup; // Slot samples before the slot is trusted
+    double threshold;           // |z| that flags a sample
+    double floor;               // Minimum stddev, in the series' own unit
+    int slot;                   // Time-of-day slot of the current sample
+} AnomalyBank;
+
+// interval_ns sizes the EWMA (five-minute half-life) and the seasonal
+// weights (about three days of memory per slot)
+int anomaly_bank_init(AnomalyBank *bank, unsigned long long interval_ns, double threshold,
+                      double floor, bool seasonal);
+void anomaly_bank_free(AnomalyBank *bank);
+int anomaly_bank_reserve(AnomalyBank *bank, int count);
+
+// Set the time-of-day slot from wall-clock time; call once per sample
+void anomaly_bank_begin(AnomalyBank *bank, long long wall_seconds);
+
+// Score a sample against the series, then fold it in. Returns true when
+// the sample is anomalous. A tag change restarts the series.
+bool anomaly_bank_push(AnomalyBank *bank, int index, unsigned int tag, double value);
+
+bool anomaly_bank_state(const AnomalyBank *bank, int index, AnomalyState *state);
+
+static inline bool anomaly_bank_flagged(const AnomalyBank *bank, int index) {
+    return index >= 0 && index < bank->count && bank->series[index].anomalous;
+}
+
+// Seasonal baseline persistence, one "name slot count mean var" line per
+// trained slot. Load seeds the series whose names are known now.
+int anomaly_bank_save(const AnomalyBank *bank, int index, const char *name, FILE *fp);
+int anomaly_bank_load(AnomalyBank *bank, int index, int slot, unsigned int count, double mean, double var);
+
+#endif // ANOMALY_H
@@ -0,0 +1,54 @@
+#ifndef BATCHREAD_H
+#define BATCHREAD_H
+
+#include <stdbool.h>
+
+// Requests in flight per io_uring submission
+#define BATCH_READ_DEPTH 1024
+
+// One file to read from offset 0 on an open descriptor. Proc and sysfs
+// files regenerate their text on every read from the start, so a
+// descriptor opened once serves every later sample.
+typedef struct {
+    int fd;
+    char *buffer;
+    unsigned int size;                    // Buffer size; the text is NUL-terminated within it
+    int result;                           // Bytes read, or -errno
+} BatchRead;
+
+// Reads large sets of small files with as few system calls as possible.
+// With io_uring a batch costs one io_uring_enter per BATCH_READ_DEPTH
+// files; without it (older kernels, seccomp filters, or not asked for) each
+// file is one pread on its cached descriptor.
+typedef struct {
+    int ring_fd;                          // -1 = synchronous preads
+    unsigned int entries;
+    void *sq_map;
+    unsigned long sq_map_size;
+    void *cq_map;                         // Same as sq_map with a single mapping
+    unsigned long cq_map_size;
+    void *sqes;
+    unsigned long sqes_size;
+    unsigned int *sq_head;
+    unsigned int *sq_tail;
+    unsigned int *sq_mask;
+    unsigned int *sq_array;
+    unsigned int *cq_head;
+    unsigned int *cq_tail;
+    unsigned int *cq_mask;
+    void *cqes;
+    unsigned long long syscalls;          // Issued by batch_read_run so far
+} BatchReader;
+
+// Set up a reader, on io_uring when use_uring is set and the kernel allows
+// it; otherwise, or on any failure, the reader falls back to pread.
+// Returns 0 on success.
+int batch_reader_init(BatchReader *reader, bool use_uring);
+void batch_reader_free(BatchReader *reader);
+bool batch_reader_uses_uring(const BatchReader *reader);
+
+// Read every request and fill in its result; returns the number of
+// requests that read at least one byte
+int batch_read_run(BatchReader *reader, BatchRead *reads, int count);
+
+#endif // BATCHREAD_H
@@ -0,0 +1,42 @@
+#ifndef CADENCE_H
+#define CADENCE_H
+
+#include <stdbool.h>
+
+// Longest stretch, in base intervals and absolute time
+#define CADENCE_MAX_STRIDE 16
+#define CADENCE_MAX_INTERVAL_NS 60000000000ULL
+
+// Quiet samples in a row before the interval doubles
+#define CADENCE_CALM_SAMPLES 3
+
+// Adaptive sampling schedule of one collector. While consecutive samples
+// of its activity measure change by less than the threshold, the interval
+// doubles every CADENCE_CALM_SAMPLES samples up to the stride limit; one
+// larger change, or cadence_wake, brings it straight back to every base
+// interval.
+typedef struct {
+    unsigned int stride;            // Base intervals between samples
+    unsigned int calm;              // Quiet samples in a row at this stride
+    unsigned long long due_ns;      // Monotonic time of the next sample
+    double last;                    // Activity measure of the last sample
+    bool primed;                    // last holds a sample
+} Cadence;
+
+// Start at every base interval, due at once
+void cadence_reset(Cadence *cadence);
+
+// Whether a sample is due at now_ns; deadlines within half a base interval
+// count as reached, so wake-up jitter never skips a whole interval
+bool cadence_due(const Cadence *cadence, unsigned long long now_ns, unsigned long long interval_ns);
+
+// Feed the measure of the sample just taken at now_ns and schedule the next
+// one. The change is in percent of max(|last|, floor): a floor of 100 reads
+// percentage measures in points, a small floor keeps near-zero rates quiet.
+void cadence_observe(Cadence *cadence, double value, double floor, double threshold,
+                     unsigned long long now_ns, unsigned long long interval_ns);
+
+// Back to every base interval, due at once; true if it had backed off
+bool cadence_wake(Cadence *cadence);
+
+#endif // CADENCE_H
@@ -0,0 +1,61 @@
+#ifndef COUNTER_H
+#define COUNTER_H
+
+#include <stdbool.h>
+
+// Per-counter outcome of the last commit
+#define COUNTER_FLAG_RESET   0x01  // Went backwards: reset, delta is 0
+#define COUNTER_FLAG_WRAPPED 0x02  // 32-bit counter wrapped, delta corrected
+
+// A bank of monotonically increasing kernel counters sampled together.
+// Collectors write raw values into `current`; commit turns them into
+// deltas and per-second rates in one pass over contiguous arrays. The
+// previous sample is kept by swapping buffers, never by copying.
+typedef struct {
+    unsigned long long *current;
+    unsigned long long *previous;
+    unsigned long long *deltas;
+    double *rates;                  // Per second
+    unsigned char *flags;           // COUNTER_FLAG_* from the last commit
+    int count;
+    int capacity;
+    unsigned long long sample_ns;   // Monotonic time of the last commit
+    double elapsed_sec;             // Between the last two commits
+    int resets;                     // Counters flagged as reset last commit
+    bool has_prev;                  // A previous sample exists
+} CounterBank;
+
+// Lifecycle; reserve grows the bank, keeping existing counters
+int counter_bank_init(CounterBank *bank, int count);
+void counter_bank_free(CounterBank *bank);
+int counter_bank_reserve(CounterBank *bank, int count);
+
+// Sampling: begin, set every counter in use, then commit
+void counter_bank_begin(CounterBank *bank);
+void counter_bank_commit(CounterBank *bank, unsigned long long now_ns);
+
+static inline void counter_bank_set(CounterBank *bank, int index, unsigned long long value) {
+    bank->current[index] = value;
+}
+
+// First value of a counter that was not sampled last time (a new device),
+// so it reports a zero delta instead of a jump
+static inline void counter_bank_set_fresh(CounterBank *bank, int index, unsigned long long value) {
+    bank->current[index] = value;
+    bank->previous[index] = value;
+}
+
+// Deltas and rates are meaningful once two samples have been committed
+static inline bool counter_bank_has_rates(const CounterBank *bank) {
+    return bank->elapsed_sec > 0;
+}
+
+static inline double counter_bank_rate(const CounterBank *bank, int index) {
+    return bank->rates[index];
+}
+
+static inline unsigned long long counter_bank_delta(const CounterBank *bank, int index) {
+    return bank->deltas[index];
+}
+
+#endif // COUNTER_H
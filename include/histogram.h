@@ -0,0 +1,34 @@
+#ifndef HISTOGRAM_H
+#define HISTOGRAM_H
+
+#include <stdbool.h>
+
+// Log-linear histogram in the style of HdrHistogram: values below 16 get
+// exact buckets, every power of two above is split into 16 linear
+// sub-buckets (at most 6.25% relative error). Values are clamped at 2^40,
+// which is about 18 minutes when recording nanoseconds.
+#define HISTOGRAM_SUB_BITS  4
+#define HISTOGRAM_SUB_COUNT (1 << HISTOGRAM_SUB_BITS)
+#define HISTOGRAM_MAX_BITS  40
+#define HISTOGRAM_BUCKETS   ((HISTOGRAM_MAX_BITS - HISTOGRAM_SUB_BITS + 1) * HISTOGRAM_SUB_COUNT)
+
+typedef struct {
+    unsigned int counts[HISTOGRAM_BUCKETS];
+    unsigned long long total;
+    unsigned long long sum;
+    unsigned long long min;
+    unsigned long long max;
+} Histogram;
+
+void histogram_reset(Histogram *hist);
+void histogram_record(Histogram *hist, unsigned long long value);
+
+// Bucket mapping, exposed for callers that keep their own counts
+int histogram_bucket(unsigned long long value);
+unsigned long long histogram_bucket_value(int bucket);
+
+// Value at a quantile in [0, 1], reported as the bucket midpoint
+unsigned long long histogram_percentile(const Histogram *hist, double quantile);
+double histogram_mean(const Histogram *hist);
+
+#endif // HISTOGRAM_H
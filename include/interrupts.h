@@ -0,0 +1,44 @@
+#ifndef INTERRUPTS_H
+#define INTERRUPTS_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "counter.h"
+
+// One row of /proc/interrupts or /proc/softirqs
+typedef struct {
+    char name[16];            // "24", "LOC", "NET_RX"
+    char device[40];          // Handler names for numbered IRQs, else the label
+} InterruptLine;
+
+// A rows x CPUs matrix of interrupt counts. Counts live in a counter bank,
+// row-major (line * num_cpus + cpu), so per-CPU rates come for free.
+typedef struct {
+    InterruptLine *lines;
+    int num_lines;
+    int lines_capacity;
+    int num_cpus;             // Columns in the file header
+    CounterBank counters;
+    double *line_rates;       // Per line, summed over CPUs, per second
+    char *text;               // Whole-file read buffer, reused every sample
+    size_t text_capacity;
+    bool valid;
+} InterruptMatrix;
+
+typedef struct {
+    InterruptMatrix irqs;     // /proc/interrupts
+    InterruptMatrix softirqs; // /proc/softirqs
+} InterruptStats;
+
+int interrupts_init(InterruptStats *stats);
+void interrupts_free(InterruptStats *stats);
+
+// Parse both files below proc_root and update rates
+bool interrupts_update(InterruptStats *stats, const char *proc_root, unsigned long long now_ns);
+
+// Per-CPU rate of one line
+static inline double interrupts_rate(const InterruptMatrix *matrix, int line, int cpu) {
+    return counter_bank_rate(&matrix->counters, line * matrix->num_cpus + cpu);
+}
+
+#endif // INTERRUPTS_H
@@ -0,0 +1,78 @@
+#ifndef MEMINFO_H
+#define MEMINFO_H
+
+// Every /proc/meminfo key the monitor knows about, as X(ID, "Key").
+// The list is kept in strcmp order of the key so lines can be resolved with
+// one binary search (pisysmon_bench fails when it is not); unknown keys
+// (newer kernels) are skipped. Values are in kB except for the HugePages_*
+// page counts. FilePages and MemUsed only appear in the per-node meminfo
+// files.
+#define MEMINFO_KEYS(X) \
+    X(ACTIVE,             "Active") \
+    X(ACTIVE_ANON,        "Active(anon)") \
+    X(ACTIVE_FILE,        "Active(file)") \
+    X(ANON_HUGE_PAGES,    "AnonHugePages") \
+    X(ANON_PAGES,         "AnonPages") \
+    X(BALLOON,            "Balloon") \
+    X(BOUNCE,             "Bounce") \
+    X(BUFFERS,            "Buffers") \
+    X(CACHED,             "Cached") \
+    X(CMA_FREE,           "CmaFree") \
+    X(CMA_TOTAL,          "CmaTotal") \
+    X(COMMIT_LIMIT,       "CommitLimit") \
+    X(COMMITTED_AS,       "Committed_AS") \
+    X(DIRECT_MAP_1G,      "DirectMap1G") \
+    X(DIRECT_MAP_2M,      "DirectMap2M") \
+    X(DIRECT_MAP_4K,      "DirectMap4k") \
+    X(DIRTY,              "Dirty") \
+    X(FILE_HUGE_PAGES,    "FileHugePages") \
+    X(FILE_PAGES,         "FilePages") \
+    X(FILE_PMD_MAPPED,    "FilePmdMapped") \
+    X(HARDWARE_CORRUPTED, "HardwareCorrupted") \
+    X(HUGE_PAGES_FREE,    "HugePages_Free") \
+    X(HUGE_PAGES_RSVD,    "HugePages_Rsvd") \
+    X(HUGE_PAGES_SURP,    "HugePages_Surp") \
+    X(HUGE_PAGES_TOTAL,   "HugePages_Total") \
+    X(HUGEPAGESIZE,       "Hugepagesize") \
+    X(HUGETLB,            "Hugetlb") \
+    X(INACTIVE,           "Inactive") \
+    X(INACTIVE_ANON,      "Inactive(anon)") \
+    X(INACTIVE_FILE,      "Inactive(file)") \
+    X(KRECLAIMABLE,       "KReclaimable") \
+    X(KERNEL_STACK,       "KernelStack") \
+    X(MAPPED,             "Mapped") \
+    X(MEM_AVAILABLE,      "MemAvailable") \
+    X(MEM_FREE,           "MemFree") \
+    X(MEM_TOTAL,          "MemTotal") \
+    X(MEM_USED,           "MemUsed") \
+    X(MLOCKED,            "Mlocked") \
+    X(NFS_UNSTABLE,       "NFS_Unstable") \
+    X(PAGE_TABLES,        "PageTables") \
+    X(PERCPU,             "Percpu") \
+    X(SRECLAIMABLE,       "SReclaimable") \
+    X(SUNRECLAIM,         "SUnreclaim") \
+    X(SEC_PAGE_TABLES,    "SecPageTables") \
+    X(SHMEM,              "Shmem") \
+    X(SHMEM_HUGE_PAGES,   "ShmemHugePages") \
+    X(SHMEM_PMD_MAPPED,   "ShmemPmdMapped") \
+    X(SLAB,               "Slab") \
+    X(SWAP_CACHED,        "SwapCached") \
+    X(SWAP_FREE,          "SwapFree") \
+    X(SWAP_TOTAL,         "SwapTotal") \
+    X(UNEVICTABLE,        "Unevictable") \
+    X(VMALLOC_CHUNK,      "VmallocChunk") \
+    X(VMALLOC_TOTAL,      "VmallocTotal") \
+    X(VMALLOC_USED,       "VmallocUsed") \
+    X(WRITEBACK,          "Writeback") \
+    X(WRITEBACK_TMP,      "WritebackTmp") \
+    X(ZSWAP,              "Zswap") \
+    X(ZSWAPPED,           "Zswapped")
+
+typedef enum {
+#define MEMINFO_ENUM(id, key) MEMINFO_##id,
+    MEMINFO_KEYS(MEMINFO_ENUM)
+#undef MEMINFO_ENUM
+    MEMINFO_KEY_COUNT
+} MeminfoKey;
+
+#endif // MEMINFO_H
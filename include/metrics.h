@@ -0,0 +1,191 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <stdio.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sysmon.h"
+
+// Metric groups and the name prefix of their metrics
+typedef enum {
+    METRIC_GROUP_CPU = 0,
+    METRIC_GROUP_MEMORY,
+    METRIC_GROUP_KERNEL,
+    METRIC_GROUP_DISK,                    // One series per mount point
+    METRIC_GROUP_NETWORK,                 // One series per interface
+    METRIC_GROUP_COUNT
+} MetricGroup;
+
+#define METRIC_PREFIX_CPU     "cpu"
+#define METRIC_PREFIX_MEMORY  "mem"
+#define METRIC_PREFIX_KERNEL  "kernel"
+#define METRIC_PREFIX_DISK    "disk"
+#define METRIC_PREFIX_NETWORK "net"
+
+typedef enum {
+    METRIC_GAUGE = 0,
+    METRIC_COUNTER                        // Backed by a monotonic total
+} MetricKind;
+
+// C type of the field a metric reads
+typedef enum {
+    METRIC_FLOAT = 0,
+    METRIC_DOUBLE,
+    METRIC_LONG,
+    METRIC_ULL
+} MetricType;
+
+typedef enum {
+    METRIC_PERCENT = 0,
+    METRIC_KB,                            // Sizes kept in kB
+    METRIC_BYTES,
+    METRIC_MBPS,                          // Binary megabits: bytes/s * 8 / 2^20
+    METRIC_PER_SECOND,
+    METRIC_TICKS,                         // USER_HZ clock ticks
+    METRIC_NUMBER
+} MetricUnit;
+
+// Where the field lives
+typedef enum {
+    METRIC_SOURCE_MONITOR = 0,            // offsetof(SystemMonitor, ...)
+    METRIC_SOURCE_KERNEL_RATE,            // KernelCounter: rate of mon->kernel.counters
+    METRIC_SOURCE_ENTRY                   // offsetof(DiskStats or NetworkStats, ...)
+} MetricSource;
+
+// Anomaly detector a metric feeds, if any
+typedef enum {
+    METRIC_ANOMALY_NONE = 0,
+    METRIC_ANOMALY_SYSTEM,                // Series of the metric's SystemWindow
+    METRIC_ANOMALY_DISK,                  // Per disk slot
+    METRIC_ANOMALY_NET_RX,                // Per interface slot, receive
+    METRIC_ANOMALY_NET_TX                 // Per interface slot, transmit
+} MetricAnomaly;
+
+// Flags
+#define METRIC_RECORDED 0x01              // Kept in flight recorder samples
+#define METRIC_SWAP     0x02              // Shown only while swap is configured
+#define METRIC_VMSTAT   0x04              // Needs /proc/vmstat
+
+#define METRIC_NO_WINDOW (-1)
+
+// Every metric the monitor exports, as X(ID, GROUP, "field", "Label", KIND,
+// TYPE, UNIT, SOURCE, locator, window, ANOMALY, flags, "help"). The name is
+// the group prefix and the field, "cpu.usage", as used by alert rules,
+// baselines and queries. Panels show the group's metrics in this order; exporters and the
+// recorder walk the same table, so a metric added here reaches every output.
+#define SYSMON_METRICS(X) \
+    X(CPU_USAGE,       CPU,     "usage",       "Usage",            GAUGE,   FLOAT,  PERCENT,    MONITOR,     offsetof(SystemMonitor, cpu.usage_percent),        SYSTEM_WINDOW_CPU_USAGE,    SYSTEM, METRIC_RECORDED, "CPU time spent outside idle") \
+    X(CPU_USER,        CPU,     "user_time",   "User Time",        COUNTER, LONG,   TICKS,      MONITOR,     offsetof(SystemMonitor, cpu.user_time),            METRIC_NO_WINDOW,           NONE,   0, "CPU time in user mode") \
+    X(CPU_SYSTEM,      CPU,     "system_time", "System Time",      COUNTER, LONG,   TICKS,      MONITOR,     offsetof(SystemMonitor, cpu.system_time),          METRIC_NO_WINDOW,           NONE,   0, "CPU time in kernel mode") \
+    X(CPU_IDLE,        CPU,     "idle_time",   "Idle Time",        COUNTER, LONG,   TICKS,      MONITOR,     offsetof(SystemMonitor, cpu.idle_time),            METRIC_NO_WINDOW,           NONE,   0, "CPU time idle") \
+    X(CPU_TOTAL,       CPU,     "total_time",  "Total Time",       COUNTER, LONG,   TICKS,      MONITOR,     offsetof(SystemMonitor, cpu.total_time),           METRIC_NO_WINDOW,           NONE,   0, "CPU time in all states") \
+    X(MEM_USAGE,       MEMORY,  "usage",       "Usage",            GAUGE,   FLOAT,  PERCENT,    MONITOR,     offsetof(SystemMonitor, memory.usage_percent),     SYSTEM_WINDOW_MEMORY_USAGE, SYSTEM, METRIC_RECORDED, "Memory in use, excluding reclaimable cache") \
+    X(MEM_TOTAL,       MEMORY,  "total",       "Total",            GAUGE,   LONG,   KB,         MONITOR,     offsetof(SystemMonitor, memory.total_kb),          METRIC_NO_WINDOW,           NONE,   0, "Usable physical memory") \
+    X(MEM_USED,        MEMORY,  "used",        "Used",             GAUGE,   LONG,   KB,         MONITOR,     offsetof(SystemMonitor, memory.used_kb),           METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED, "Memory in use: total minus available") \
+    X(MEM_FREE,        MEMORY,  "free",        "Free",             GAUGE,   LONG,   KB,         MONITOR,     offsetof(SystemMonitor, memory.free_kb),           METRIC_NO_WINDOW,           NONE,   0, "Unused memory") \
+    X(MEM_AVAILABLE,   MEMORY,  "available",   "Available",        GAUGE,   LONG,   KB,         MONITOR,     offsetof(SystemMonitor, memory.available_kb),      METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED, "Memory available without swapping") \
+    X(MEM_BUFFERS,     MEMORY,  "buffers",     "Buffers",          GAUGE,   LONG,   KB,         MONITOR,     offsetof(SystemMonitor, memory.buffers_kb),        METRIC_NO_WINDOW,           NONE,   0, "Block device buffers") \
+    X(MEM_CACHED,      MEMORY,  "cached",      "Cached",           GAUGE,   LONG,   KB,         MONITOR,     offsetof(SystemMonitor, memory.cached_kb),         METRIC_NO_WINDOW,           NONE,   0, "Page cache and reclaimable slab") \
+    X(MEM_SHARED,      MEMORY,  "shared",      "Shared",           GAUGE,   LONG,   KB,         MONITOR,     offsetof(SystemMonitor, memory.shared_kb),         METRIC_NO_WINDOW,           NONE,   0, "Shared memory and tmpfs") \
+    X(MEM_SWAP_USAGE,  MEMORY,  "swap_usage",  "Swap Usage",       GAUGE,   FLOAT,  PERCENT,    MONITOR,     offsetof(SystemMonitor, memory.swap_percent),      SYSTEM_WINDOW_SWAP_USAGE,   SYSTEM, METRIC_RECORDED | METRIC_SWAP, "Swap space in use") \
+    X(MEM_SWAP_USED,   MEMORY,  "swap_used",   "Swap Used",        GAUGE,   LONG,   KB,         MONITOR,     offsetof(SystemMonitor, memory.swap_used_kb),      METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED | METRIC_SWAP, "Swap space in use") \
+    X(MEM_SWAP_TOTAL,  MEMORY,  "swap_total",  "Swap Total",       GAUGE,   LONG,   KB,         MONITOR,     offsetof(SystemMonitor, memory.swap_total_kb),     METRIC_NO_WINDOW,           NONE,   METRIC_SWAP, "Swap space configured") \
+    X(MEM_DIRTY,       MEMORY,  "dirty",       "Dirty",            GAUGE,   ULL,    KB,         MONITOR,     offsetof(SystemMonitor, memory.values[MEMINFO_DIRTY]),     METRIC_NO_WINDOW,   NONE,   0, "Memory waiting to be written back") \
+    X(MEM_WRITEBACK,   MEMORY,  "writeback",   "Writeback",        GAUGE,   ULL,    KB,         MONITOR,     offsetof(SystemMonitor, memory.values[MEMINFO_WRITEBACK]), METRIC_NO_WINDOW,   NONE,   0, "Memory being written back") \
+    X(MEM_SLAB,        MEMORY,  "slab",        "Slab",             GAUGE,   ULL,    KB,         MONITOR,     offsetof(SystemMonitor, memory.values[MEMINFO_SLAB]),      METRIC_NO_WINDOW,   NONE,   0, "Kernel slab allocations") \
+    X(KERNEL_CTXSW,    KERNEL,  "ctxsw",       "Context switches", COUNTER, DOUBLE, PER_SECOND, KERNEL_RATE, KERNEL_CONTEXT_SWITCHES,                          METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED, "Context switches") \
+    X(KERNEL_INTR,     KERNEL,  "intr",        "Interrupts",       COUNTER, DOUBLE, PER_SECOND, KERNEL_RATE, KERNEL_INTERRUPTS,                                METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED, "Interrupts serviced") \
+    X(KERNEL_FORK,     KERNEL,  "fork",        "Forks",            COUNTER, DOUBLE, PER_SECOND, KERNEL_RATE, KERNEL_FORKS,                                     METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED, "Processes and threads created") \
+    X(KERNEL_FLT,      KERNEL,  "flt",         "Page faults",      COUNTER, DOUBLE, PER_SECOND, KERNEL_RATE, KERNEL_PAGE_FAULTS,                               METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED | METRIC_VMSTAT, "Page faults") \
+    X(KERNEL_MAJFLT,   KERNEL,  "majflt",      "Major faults",     COUNTER, DOUBLE, PER_SECOND, KERNEL_RATE, KERNEL_MAJOR_FAULTS,                              METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED | METRIC_VMSTAT, "Page faults that needed I/O") \
+    X(KERNEL_SWPIN,    KERNEL,  "swpin",       "Swap in",          COUNTER, DOUBLE, PER_SECOND, KERNEL_RATE, KERNEL_SWAP_IN,                                   METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED | METRIC_VMSTAT, "Pages swapped in") \
+    X(KERNEL_SWPOUT,   KERNEL,  "swpout",      "Swap out",         COUNTER, DOUBLE, PER_SECOND, KERNEL_RATE, KERNEL_SWAP_OUT,                                  METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED | METRIC_VMSTAT, "Pages swapped out") \
+    X(KERNEL_SCAN,     KERNEL,  "scan",        "Pages scanned",    COUNTER, DOUBLE, PER_SECOND, KERNEL_RATE, KERNEL_PAGES_SCANNED,                             METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED | METRIC_VMSTAT, "Pages scanned for reclaim") \
+    X(KERNEL_STEAL,    KERNEL,  "steal",       "Pages reclaimed",  COUNTER, DOUBLE, PER_SECOND, KERNEL_RATE, KERNEL_PAGES_STOLEN,                              METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED | METRIC_VMSTAT, "Pages reclaimed") \
+    X(KERNEL_RUNNING,  KERNEL,  "running",     "Tasks running",    GAUGE,   LONG,   NUMBER,     MONITOR,     offsetof(SystemMonitor, kernel.procs_running),     METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED, "Runnable tasks") \
+    X(KERNEL_BLOCKED,  KERNEL,  "blocked",     "Tasks blocked",    GAUGE,   LONG,   NUMBER,     MONITOR,     offsetof(SystemMonitor, kernel.procs_blocked),     METRIC_NO_WINDOW,           NONE,   METRIC_RECORDED, "Tasks in uninterruptible sleep") \
+    X(DISK_USAGE,      DISK,    "usage",       "Usage",            GAUGE,   FLOAT,  PERCENT,    ENTRY,       offsetof(DiskStats, usage_percent),                METRIC_NO_WINDOW,           DISK,   0, "Filesystem space in use") \
+    X(DISK_TOTAL,      DISK,    "total",       "Total",            GAUGE,   LONG,   KB,         ENTRY,       offsetof(DiskStats, total_kb),                     METRIC_NO_WINDOW,           NONE,   0, "Filesystem size") \
+    X(DISK_USED,       DISK,    "used",        "Used",             GAUGE,   LONG,   KB,         ENTRY,       offsetof(DiskStats, used_kb),                      METRIC_NO_WINDOW,           NONE,   0, "Filesystem space used") \
+    X(DISK_FREE,       DISK,    "free",        "Free",             GAUGE,   LONG,   KB,         ENTRY,       offsetof(DiskStats, available_kb),                 METRIC_NO_WINDOW,           NONE,   0, "Filesystem space available to users") \
+    X(NET_RX_RATE,     NETWORK, "rx_rate",     "RX",               GAUGE,   DOUBLE, MBPS,       ENTRY,       offsetof(NetworkStats, rx_rate_mbps),              METRIC_NO_WINDOW,           NET_RX, 0, "Receive rate") \
+    X(NET_TX_RATE,     NETWORK, "tx_rate",     "TX",               GAUGE,   DOUBLE, MBPS,       ENTRY,       offsetof(NetworkStats, tx_rate_mbps),              METRIC_NO_WINDOW,           NET_TX, 0, "Transmit rate") \
+    X(NET_RX_BYTES,    NETWORK, "rx_bytes",    "RX Bytes",         COUNTER, ULL,    BYTES,      ENTRY,       offsetof(NetworkStats, rx_bytes),                  METRIC_NO_WINDOW,           NONE,   0, "Bytes received") \
+    X(NET_TX_BYTES,    NETWORK, "tx_bytes",    "TX Bytes",         COUNTER, ULL,    BYTES,      ENTRY,       offsetof(NetworkStats, tx_bytes),                  METRIC_NO_WINDOW,           NONE,   0, "Bytes transmitted") \
+    X(NET_RX_PACKETS,  NETWORK, "rx_packets",  "RX Packets",       COUNTER, ULL,    NUMBER,     ENTRY,       offsetof(NetworkStats, rx_packets),                METRIC_NO_WINDOW,           NONE,   0, "Packets received") \
+    X(NET_TX_PACKETS,  NETWORK, "tx_packets",  "TX Packets",       COUNTER, ULL,    NUMBER,     ENTRY,       offsetof(NetworkStats, tx_packets),                METRIC_NO_WINDOW,           NONE,   0, "Packets transmitted")
+
+typedef enum {
+#define METRIC_ENUM(id, group, field, label, kind, type, unit, source, locator, window, anomaly, flags, help) METRIC_##id,
+    SYSMON_METRICS(METRIC_ENUM)
+#undef METRIC_ENUM
+    METRIC_COUNT
+} MetricId;
+
+// Number of METRIC_RECORDED metrics, as a constant expression
+enum {
+#define METRIC_IS_RECORDED(id, group, field, label, kind, type, unit, source, locator, window, anomaly, flags, help) \
+    + (((flags) & METRIC_RECORDED) ? 1 : 0)
+    METRIC_RECORDED_COUNT = 0 SYSMON_METRICS(METRIC_IS_RECORDED)
+#undef METRIC_IS_RECORDED
+};
+
+typedef struct {
+    const char *name;                     // "cpu.usage"
+    const char *field;                    // "usage"
+    const char *label;                    // Panel row label
+    const char *help;
+    MetricGroup group;
+    MetricKind kind;
+    MetricType type;
+    MetricUnit unit;
+    MetricSource source;
+    size_t locator;                       // Field offset, or KernelCounter
+    int window;                           // SystemWindow, METRIC_NO_WINDOW
+    MetricAnomaly anomaly;
+    unsigned int flags;
+} MetricDesc;
+
+extern const MetricDesc metric_table[METRIC_COUNT];
+extern const char *metric_group_prefixes[METRIC_GROUP_COUNT];
+
+// Metric by full name, NULL if unknown
+const MetricDesc* metric_find(const char *name);
+
+// Per-device metrics read an entry of these tables, labelled by its key
+bool metric_keyed(const MetricDesc *metric);
+const StatTable* metric_table_of(const SystemMonitor *mon, const MetricDesc *metric);
+const char* metric_label_name(const MetricDesc *metric);   // "mount", "interface"
+const char* metric_entry_key(const MetricDesc *metric, const void *entry);
+
+// Address of a scalar metric's field, NULL for per-device metrics
+const void* metric_field(const SystemMonitor *mon, const MetricDesc *metric);
+
+// Whether the last sample produced a value: the group was collected, rates
+// have two samples, vmstat counters have /proc/vmstat
+bool metric_available(const SystemMonitor *mon, const MetricDesc *metric);
+
+// Current value; entry is the DiskStats or NetworkStats of a per-device
+// metric and ignored otherwise
+double metric_value(const SystemMonitor *mon, const MetricDesc *metric, const void *entry);
+
+// Monotonic total behind a counter: the counter itself for fields, the raw
+// kernel counter for rates
+double metric_total(const SystemMonitor *mon, const MetricDesc *metric, const void *entry);
+
+// Whether an anomaly detector watches the metric, and whether it flagged
+// the last sample; row is the entry's row for per-device metrics
+bool metric_has_anomaly(const MetricDesc *metric);
+bool metric_anomalous(const SystemMonitor *mon, const MetricDesc *metric, int row);
+
+// Whether any detector of a per-device group flagged the entry at row
+bool metric_entry_anomalous(const SystemMonitor *mon, MetricGroup group, int row);
+
+// Every available metric of the last sample, one document per call, with
+// the verdict of each anomaly detector: JSON lists the flagged series under
+// "anomalous", Prometheus exports pisysmon_anomalous as 0 or 1 per series.
+// Both return 0 on success.
+int metrics_write_json(const SystemMonitor *mon, FILE *out);
+int metrics_write_prometheus(const SystemMonitor *mon, FILE *out);
+
+#endif // METRICS_H
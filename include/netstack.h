@@ -0,0 +1,85 @@
+#ifndef NETSTACK_H
+#define NETSTACK_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "counter.h"
+
+// Network stack counters from /proc/net/{softnet_stat,snmp,netstat}
+typedef enum {
+    NETSTACK_SOFTNET_PROCESSED = 0,   // softnet_stat, summed over CPUs
+    NETSTACK_SOFTNET_DROPPED,         // Input backlog full
+    NETSTACK_SOFTNET_SQUEEZED,        // NAPI budget or time ran out
+    NETSTACK_IP_IN_RECEIVES,          // snmp: Ip
+    NETSTACK_IP_OUT_REQUESTS,
+    NETSTACK_IP_IN_DISCARDS,
+    NETSTACK_TCP_IN_SEGS,             // snmp: Tcp
+    NETSTACK_TCP_OUT_SEGS,
+    NETSTACK_TCP_RETRANS_SEGS,
+    NETSTACK_TCP_IN_ERRS,
+    NETSTACK_TCP_OUT_RSTS,
+    NETSTACK_TCP_ACTIVE_OPENS,
+    NETSTACK_TCP_PASSIVE_OPENS,
+    NETSTACK_TCP_ATTEMPT_FAILS,
+    NETSTACK_TCP_LISTEN_OVERFLOWS,    // netstat: TcpExt
+    NETSTACK_TCP_LISTEN_DROPS,
+    NETSTACK_TCP_BACKLOG_DROPS,
+    NETSTACK_TCP_TIMEOUTS,
+    NETSTACK_UDP_IN_DATAGRAMS,        // snmp: Udp
+    NETSTACK_UDP_OUT_DATAGRAMS,
+    NETSTACK_UDP_NO_PORTS,
+    NETSTACK_UDP_IN_ERRORS,
+    NETSTACK_UDP_RCVBUF_ERRORS,
+    NETSTACK_UDP_SNDBUF_ERRORS,
+    NETSTACK_COUNTER_COUNT
+} NetstackCounter;
+
+// Per-CPU softnet_stat columns
+typedef enum {
+    SOFTNET_PROCESSED = 0,
+    SOFTNET_DROPPED,
+    SOFTNET_SQUEEZED,
+    SOFTNET_FIELD_COUNT
+} SoftnetField;
+
+// Socket gauges from /proc/net/sockstat
+typedef struct {
+    long sockets_used;
+    long tcp_inuse;
+    long tcp_orphan;
+    long tcp_timewait;
+    long tcp_alloc;
+    long tcp_mem_pages;
+    long udp_inuse;
+    long udp_mem_pages;
+} SocketSummary;
+
+typedef struct {
+    CounterBank counters;     // Indexed by NetstackCounter
+    CounterBank softnet;      // Per row: row * SOFTNET_FIELD_COUNT + field
+    int *softnet_cpu_ids;     // CPU id of each softnet_stat row
+    int softnet_cpus;         // Rows, one per online CPU
+    SocketSummary sockets;
+    char *text;               // Read buffer shared by the four files
+    size_t text_capacity;
+    bool has_softnet;
+    bool has_snmp;
+    bool has_netstat;
+    bool has_sockstat;
+    bool valid;
+} NetstackStats;
+
+int netstack_init(NetstackStats *stats);
+void netstack_free(NetstackStats *stats);
+
+// Read every file below proc_root; missing files leave their counters at 0
+bool netstack_update(NetstackStats *stats, const char *proc_root, unsigned long long now_ns);
+
+// Display name of a counter
+const char* netstack_counter_name(NetstackCounter counter);
+
+// softnet_stat row whose field grew fastest last interval, -1 when none
+// did; softnet_cpu_ids gives its CPU
+int netstack_busiest_row(const NetstackStats *stats, SoftnetField field);
+
+#endif // NETSTACK_H
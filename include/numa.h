@@ -0,0 +1,73 @@
+#ifndef NUMA_H
+#define NUMA_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include "counter.h"
+#include "meminfo.h"
+
+// Allocation counters of a node's numastat, in file order
+typedef enum {
+    NUMASTAT_HIT = 0,             // Allocated here, as the policy preferred
+    NUMASTAT_MISS,                // Allocated here though another node was preferred
+    NUMASTAT_FOREIGN,             // Preferred here but allocated elsewhere
+    NUMASTAT_INTERLEAVE_HIT,
+    NUMASTAT_LOCAL_NODE,          // Allocated here for a task running here
+    NUMASTAT_OTHER_NODE,          // Allocated here for a task on another node
+    NUMASTAT_COUNTER_COUNT
+} NumastatCounter;
+
+// One memory node. Its meminfo lines carry the /proc/meminfo keys behind a
+// "Node N" prefix, plus MemUsed and FilePages.
+typedef struct {
+    int id;                       // N of nodeN
+    int meminfo_fd;               // Kept open across samples, -1 if missing
+    int numastat_fd;
+    unsigned long long values[MEMINFO_KEY_COUNT];
+    long total_kb;
+    long free_kb;
+    long used_kb;                 // Total - free: a node has no MemAvailable
+    long file_kb;                 // Page cache, mostly reclaimable
+    long anon_kb;
+    float usage_percent;
+    int first_cpu;                // Range of NumaStats.node_cpus
+    int cpu_count;
+    float cpu_percent;            // Mean of its CPUs
+    bool valid;
+} NumaNode;
+
+// NUMA topology from <sys>/devices/system/node with per-node memory,
+// allocation rates and the CPU collector's per-CPU usage grouped by node.
+// Every file is opened once when the topology is discovered and then read
+// with one pread per sample; a node that stops reading (offlined) triggers
+// a new discovery.
+typedef struct {
+    NumaNode *nodes;              // Ascending node id
+    int num_nodes;
+    int *node_cpus;               // CPU ids grouped by node, ascending within a node
+    int num_cpus;
+    CounterBank numastat;         // node * NUMASTAT_COUNTER_COUNT + counter
+    char *text;                   // Read buffer shared by every file
+    size_t text_capacity;
+    bool discovered;
+    bool valid;
+} NumaStats;
+
+int numa_init(NumaStats *stats);
+void numa_free(NumaStats *stats);
+
+// Discover the topology on first use, then read every node file and
+// average the per-CPU usage, indexed by CPU id, over each node's CPUs.
+// False when the kernel exposes no nodes.
+bool numa_update(NumaStats *stats, const char *sys_root, const float *cpu_percent, int cpu_slots,
+                 unsigned long long now_ns);
+
+// Allocations per second of one node counter
+static inline double numa_rate(const NumaStats *stats, int node, NumastatCounter counter) {
+    return counter_bank_rate(&stats->numastat, node * NUMASTAT_COUNTER_COUNT + counter);
+}
+
+// Display name of a numastat counter, as in the file
+const char* numa_counter_name(NumastatCounter counter);
+
+#endif // NUMA_H
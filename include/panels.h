@@ -0,0 +1,78 @@
+#ifndef PANELS_H
+#define PANELS_H
+
+#include "render.h"
+#include "sysmon.h"
+
+// Build structured component content from a monitor's last sample.
+// Summary panels are small tables; per-device panels are virtual lists whose
+// rows are filled only when scrolled into view.
+void panels_build_cpu(RenderTable *table, const SystemMonitor *mon);
+void panels_build_memory(RenderTable *table, const SystemMonitor *mon);
+void panels_build_disk(RenderList *list, const SystemMonitor *mon);
+void panels_build_network(RenderList *list, const SystemMonitor *mon);
+void panels_build_kernel(RenderTable *table, const SystemMonitor *mon);
+
+// Network stack: softnet, IP/TCP/UDP counters per second and socket gauges
+void panels_build_netstack(RenderTable *table, const SystemMonitor *mon);
+
+// Process list, ordered by partial selection of the rows on screen
+typedef enum {
+    PROCESS_COLUMN_PID = 0,
+    PROCESS_COLUMN_COMMAND,
+    PROCESS_COLUMN_STATE,
+    PROCESS_COLUMN_CPU,
+    PROCESS_COLUMN_RSS,
+    PROCESS_COLUMN_THREADS,
+    PROCESS_COLUMN_PSS,           // Detail columns are only read for rows on screen
+    PROCESS_COLUMN_SWAP,
+    PROCESS_COLUMN_READ,
+    PROCESS_COLUMN_WRITE,
+    PROCESS_COLUMN_FDS,
+    PROCESS_COLUMN_COUNT
+} ProcessColumn;
+
+void panels_build_process(RenderList *list, SystemMonitor *mon);
+
+// TCP sockets by state, then listening ports with their accept queues
+void panels_build_sockets(RenderTable *table, const SystemMonitor *mon);
+
+// Interrupt heatmap: IRQ and softirq lines ordered by rate, with a
+// per-CPU heat strip that makes lines pinned to one CPU stand out
+typedef enum {
+    INTERRUPT_COLUMN_NAME = 0,
+    INTERRUPT_COLUMN_DEVICE,
+    INTERRUPT_COLUMN_RATE,
+    INTERRUPT_COLUMN_TOP,         // Busiest CPU of the line
+    INTERRUPT_COLUMN_SHARE,       // Its share of the line's rate
+    INTERRUPT_COLUMN_HEAT,
+    INTERRUPT_COLUMN_COUNT
+} InterruptColumn;
+
+void panels_build_interrupts(RenderList *list, const SystemMonitor *mon);
+
+// NUMA nodes: each node's memory and allocation rates, followed by the
+// usage of its CPUs, so one exhausted or overloaded node stands out
+typedef enum {
+    NUMA_COLUMN_NAME = 0,
+    NUMA_COLUMN_CPU,
+    NUMA_COLUMN_MEMORY,
+    NUMA_COLUMN_USED,
+    NUMA_COLUMN_FREE,
+    NUMA_COLUMN_FILE,
+    NUMA_COLUMN_HIT,
+    NUMA_COLUMN_MISS,
+    NUMA_COLUMN_FOREIGN,
+    NUMA_COLUMN_LOCAL,            // Share of this node's allocations made from its own CPUs
+    NUMA_COLUMN_COUNT
+} NumaColumn;
+
+void panels_build_numa(RenderList *list, const SystemMonitor *mon);
+
+// Monitor overhead: per-stage latency, effective collector intervals,
+// terminal output in bytes per second (negative = unknown) and the
+// monitor's own usage
+void panels_build_overhead(RenderTable *table, const SystemMonitor *mon, const SelfProcessStats *process,
+                           double output_rate);
+
+#endif // PANELS_H
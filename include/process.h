@@ -0,0 +1,90 @@
+#ifndef PROCESS_H
+#define PROCESS_H
+
+#include <stdbool.h>
+#include "table.h"
+#include "batchread.h"
+
+// Expensive per-process fields, fetched on demand for the rows someone is
+// looking at and cached for a per-field time to live
+typedef enum {
+    PROCESS_DETAIL_MEMORY = 0,    // smaps_rollup: PSS and swap
+    PROCESS_DETAIL_IO,            // io: bytes read and written
+    PROCESS_DETAIL_FDS,           // fd/: open descriptors
+    PROCESS_DETAIL_COUNT
+} ProcessDetail;
+
+#define PROCESS_DETAIL_MASK(detail) (1u << (detail))
+#define PROCESS_DETAIL_ALL ((1u << PROCESS_DETAIL_COUNT) - 1)
+
+// smaps_rollup walks the page tables, so it is refreshed least often
+#define PROCESS_TTL_MEMORY_NS 5000000000ULL
+#define PROCESS_TTL_IO_NS     2000000000ULL
+#define PROCESS_TTL_FDS_NS    5000000000ULL
+
+// Per-process statistics from /proc/[pid]/stat, keyed by the pid as text
+typedef struct {
+    char pid_key[12];
+    int pid;
+    int ppid;
+    char command[32];             // comm, truncated by the kernel to 15 chars
+    char state[2];
+    unsigned long long cpu_ticks; // utime + stime
+    unsigned long long prev_cpu_ticks;
+    unsigned long long vsize;
+    long rss_kb;
+    long threads;
+    double cpu_percent;           // Of one CPU, so busy threads can exceed 100
+    bool has_prev;
+    bool valid;
+
+    // On-demand details, see process_fetch_details
+    long pss_kb;
+    long swap_kb;
+    unsigned long long read_bytes;
+    unsigned long long write_bytes;
+    int fd_count;
+    unsigned long long detail_ns[PROCESS_DETAIL_COUNT];  // Fetch time, 0 = never
+    unsigned int detail_valid;    // PROCESS_DETAIL_MASK bits that were readable
+} ProcessStats;
+
+// Longest /proc/[pid]/stat line read
+#define PROCESS_STAT_SIZE 1024
+
+// Descriptors of /proc/[pid]/stat kept open across scans, by process table
+// slot, and the reader that reads them all in one batch. A descriptor is
+// tied to its process, not its pid: once the process exits, reads fail and
+// the file is opened afresh; descriptors of departed entries are closed
+// when the table sweeps them. At most max_open are kept, half the
+// descriptor limit; processes past that are read with open/read/close.
+typedef struct {
+    int *fds;                     // By slot, -1 = not open
+    int capacity;
+    int open_count;
+    int max_open;
+    BatchReader reader;
+    BatchRead *reads;             // One per process this scan
+    int *read_slots;
+    char *buffers;                // PROCESS_STAT_SIZE per read
+    int reads_capacity;
+} ProcessScan;
+
+// Set up the descriptor cache, reading through io_uring when use_uring is
+// set and available. Returns 0 on success.
+int process_scan_init(ProcessScan *scan, bool use_uring);
+void process_scan_free(ProcessScan *scan);
+
+// Scan every numeric directory below the proc root. elapsed_ns is the time
+// since the previous scan and drives the CPU percentages. With a scan, stat
+// files stay open and are read in one batch; without one, each is opened,
+// read and closed.
+int process_update_all(StatTable *processes, ProcessScan *scan, const char *proc_root,
+                       unsigned long long elapsed_ns);
+
+// Refresh the requested details whose cached value is older than its time
+// to live. Fields that cannot be read (exited, or another user's process)
+// are left out of detail_valid. Returns the details now valid.
+unsigned int process_fetch_details(ProcessStats *proc, const char *proc_root,
+                                   unsigned int mask, unsigned long long now_ns);
+
+#endif // PROCESS_H
@@ -0,0 +1,18 @@
+#ifndef PROCFILE_H
+#define PROCFILE_H
+
+#include <stddef.h>
+#include <sys/types.h>
+
+// Read a whole proc file into a caller-owned buffer that grows as needed
+// and is reused across samples. Proc files report no size, so the buffer
+// doubles until a read comes up short. The text is NUL-terminated.
+// Returns the length, or -1 on error.
+ssize_t procfile_read(const char *path, char **buffer, size_t *capacity);
+
+// Same for a descriptor kept open across samples: proc and sysfs files
+// regenerate on every read from offset 0, so once the buffer has grown to
+// fit, a sample is a single pread.
+ssize_t procfile_pread(int fd, char **buffer, size_t *capacity);
+
+#endif // PROCFILE_H
@@ -0,0 +1,81 @@
+#ifndef QUERY_H
+#define QUERY_H
+
+#include <stdio.h>
+#include <stdbool.h>
+#include "recorder.h"
+
+#define QUERY_MAX_AGGREGATES 16
+#define QUERY_MAX_CONDITIONS 8
+#define QUERY_MAX_BUCKETS 1000000
+
+typedef enum {
+    QUERY_MIN = 0,
+    QUERY_MAX,
+    QUERY_AVG,
+    QUERY_PERCENTILE
+} QueryFunction;
+
+typedef struct {
+    QueryFunction function;
+    double percentile;                    // QUERY_PERCENTILE: 0-100, nearest rank
+} QueryAggregate;
+
+typedef enum {
+    QUERY_LESS = 0,
+    QUERY_LESS_EQUAL,
+    QUERY_GREATER,
+    QUERY_GREATER_EQUAL
+} QueryOperator;
+
+// Sample filter, e.g. cpu.usage>90; all conditions must hold
+typedef struct {
+    int metric;                           // MetricId
+    QueryOperator op;
+    double value;
+} QueryCondition;
+
+typedef struct {
+    int columns[RECORDER_MAX_COLUMNS];    // MetricId of recorded metrics, in output order
+    int column_count;
+    QueryAggregate aggregates[QUERY_MAX_AGGREGATES];
+    int aggregate_count;
+    QueryCondition conditions[QUERY_MAX_CONDITIONS];
+    int condition_count;
+    unsigned long long from_ns;           // CLOCK_REALTIME, inclusive; 0 = open
+    unsigned long long to_ns;             // Exclusive; 0 = open
+    unsigned long long bucket_ns;         // Group length, aligned to local time; 0 = one group
+    bool csv;
+} QuerySpec;
+
+// What a query touched, for the summary line
+typedef struct {
+    int files;
+    unsigned long long blocks;
+    unsigned long long blocks_read;       // Blocks not ruled out by their index entry
+    unsigned long long samples;           // Intact samples read in those blocks
+    unsigned long long matched;
+    unsigned long long elapsed_ns;
+    const char *failed_path;              // File that could not be opened
+} QueryStats;
+
+// Option parsers; each returns false on a malformed argument or a metric
+// that is not recorded
+bool query_parse_columns(QuerySpec *spec, const char *list);      // "cpu.usage,mem.usage"
+bool query_parse_aggregates(QuerySpec *spec, const char *list);   // "min,avg,max,p99.9"
+bool query_parse_condition(QuerySpec *spec, const char *text);    // "cpu.usage>90", "kernel.blocked>=1"
+
+// "2026-01-31", "2026-01-31 02:00[:00]" (or with a T), "02:00[:00]" today,
+// "-2h" before now_ns, or "@<unix seconds>"; local time
+bool query_parse_time(const char *text, unsigned long long now_ns, unsigned long long *wall_ns);
+
+// Aggregate the recordings in paths and print a table, or CSV, to out.
+// Blocks whose index entry lies outside the time range or cannot satisfy
+// the conditions are never read, and only the requested columns are
+// decoded. Columns are matched to each ring by metric name; a ring without
+// a metric adds no samples to its column and fails its conditions.
+// Returns 0 on success, -1 with errno set and stats->failed_path
+// when a file is not a readable ring.
+int query_run(const QuerySpec *spec, const char *const *paths, int path_count, FILE *out, QueryStats *stats);
+
+#endif // QUERY_H
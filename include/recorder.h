@@ -0,0 +1,150 @@
+#ifndef RECORDER_H
+#define RECORDER_H
+
+#include <stdio.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <stdbool.h>
+#include "sysmon.h"
+#include "metrics.h"
+
+#define RECORDER_MAGIC "PISYSREC"
+#define RECORDER_VERSION 4
+#define RECORDER_HEADER_SIZE 12288        // Header and block index; slots stay page aligned
+#define RECORDER_SLOT_SIZE 512
+#define RECORDER_MIN_SLOTS 16
+#define RECORDER_DEFAULT_SIZE (4ULL * 1024 * 1024)
+#define RECORDER_DEFAULT_SYNC_NS 10000000000ULL  // 10 s
+
+// Devices kept per slot: the fullest disks and the busiest interfaces
+#define RECORDER_DEVICES 8
+
+// Index granularity: at most this many blocks, each a multiple of
+// RECORDER_BLOCK_ALIGN slots so blocks start on a page
+#define RECORDER_BLOCKS 48
+#define RECORDER_BLOCK_ALIGN 8
+
+// Scalar columns of a sample: the METRIC_RECORDED metrics of the registry,
+// in registry order. The header names them, so a ring written before a
+// metric was added still reads by name; the slot leaves room to grow.
+#define RECORDER_COLUMN_COUNT METRIC_RECORDED_COUNT
+#define RECORDER_MAX_COLUMNS 22
+#define RECORDER_COLUMN_NAME 24
+
+// Time range and per-column bounds of the samples a block holds. Bounds
+// are widened before a sample is stored and the block is cleared before
+// its entry is reset, so they never miss a sample, even after a crash.
+// A column no sample of the block had a value for stays NAN.
+typedef struct {
+    uint64_t first_ns;                    // CLOCK_REALTIME; 0 = block empty
+    uint64_t last_ns;
+    float min[RECORDER_MAX_COLUMNS];
+    float max[RECORDER_MAX_COLUMNS];
+} RecorderBlock;
+
+// Ring file header: written once when the file is created, except for the
+// block index, which is kept current with the slots
+typedef struct {
+    char magic[8];
+    uint32_t version;
+    uint32_t header_size;
+    uint32_t slot_size;
+    uint32_t slot_count;
+    uint32_t block_slots;                 // Slots per index block
+    uint32_t block_count;
+    uint64_t created_ns;                  // CLOCK_REALTIME
+    uint64_t interval_ns;                 // Sampling interval at creation
+    char hostname[64];
+    uint32_t column_count;
+    uint32_t reserved;
+    char columns[RECORDER_MAX_COLUMNS][RECORDER_COLUMN_NAME];  // Metric names
+    RecorderBlock blocks[RECORDER_BLOCKS];
+} RecorderHeader;
+
+typedef struct {
+    char name[16];                        // Mount point or interface, truncated
+    float value[2];                       // Disk: usage %, 0; interface: rx, tx Mbps
+} RecorderDevice;
+
+// One sample. The checksum is a four-lane FNV-1a over the slot's 64-bit
+// words with the checksum field zeroed, so a slot torn by a crash mid-write
+// is recognised on read.
+typedef struct {
+    uint64_t seq;                         // From 1; 0 = never written
+    uint64_t wall_ns;                     // CLOCK_REALTIME
+    uint64_t mono_ns;                     // CLOCK_MONOTONIC
+    uint64_t checksum;
+    uint8_t disk_count;
+    uint8_t interface_count;
+    uint16_t device_anomalies;            // Bit k: disks[k], bit 8 + k: interfaces[k] (rx or tx)
+    uint32_t anomalies;                   // Bit per header column its detector flagged
+    float values[RECORDER_MAX_COLUMNS];   // By header column; NAN = unavailable
+    RecorderDevice disks[RECORDER_DEVICES];
+    RecorderDevice interfaces[RECORDER_DEVICES];
+} RecorderSlot;
+
+// Flight recorder: a fixed-size ring file mapped shared, so every sample
+// written is in the page cache the moment the stores complete and survives
+// a crash or kill of the process. Writing a sample is plain stores into
+// the map; msync runs only every sync_ns, which bounds what a crash of
+// the whole machine can lose. The ring is recycled a block at a time: the
+// oldest block is cleared whole when the writer reaches it.
+typedef struct {
+    int fd;
+    unsigned char *map;
+    size_t map_size;
+    uint32_t slot_count;
+    uint32_t block_slots;
+    uint64_t seq;                         // Last sequence written
+    unsigned long long sync_ns;           // 0 = only on close
+    unsigned long long last_sync_ns;
+    uint32_t dirty_first;                 // First slot written since the last msync
+    uint32_t dirty_count;
+    int columns[RECORDER_COLUMN_COUNT];   // Ring column of each recorded metric, -1 if it has none
+    int missing;                          // Recorded metrics the ring has no column for
+} Recorder;
+
+// Read-only view of a ring file, for dump and query
+typedef struct {
+    unsigned char *map;
+    size_t map_size;
+    const RecorderHeader *header;
+} RecorderView;
+
+// Open the ring at path, creating (and preallocating) it at size bytes when
+// it is missing or not a ring. An existing ring keeps its own size and is
+// continued after its newest sample; its columns are matched to this
+// build's metrics by name, so one written by another build keeps its
+// layout: its columns this build lacks read NAN from then on, and metrics
+// it has no column for are counted in `missing` and not recorded.
+// Returns 0 on success.
+int recorder_open(Recorder *rec, const char *path, unsigned long long size,
+                  unsigned long long interval_ns, unsigned long long sync_ns);
+void recorder_close(Recorder *rec);
+
+// Append the monitor's last sample, overwriting the oldest slot
+void recorder_write(Recorder *rec, const SystemMonitor *mon);
+
+// Append a prepared sample: wall_ns, mono_ns, values and devices are the
+// caller's, seq and checksum are assigned here
+void recorder_append(Recorder *rec, const RecorderSlot *sample);
+
+// Column a metric is written to in a ring this build created, -1 if it
+// is not recorded
+int recorder_metric_column(MetricId metric);
+
+// Map a ring file read-only. Returns 0 on success, -1 with errno set
+// (EINVAL when the file is not a ring).
+int recorder_view_open(RecorderView *view, const char *path);
+void recorder_view_close(RecorderView *view);
+const RecorderSlot* recorder_view_slot(const RecorderView *view, uint32_t index);
+bool recorder_slot_intact(const RecorderSlot *slot);
+
+// Column of a ring holding the named metric, -1 if it was not recorded
+int recorder_view_column(const RecorderView *view, const char *name);
+
+// Print every intact sample of a ring file, oldest first, with a count of
+// torn slots. Returns 0 on success.
+int recorder_dump(const char *path, FILE *out);
+
+#endif // RECORDER_H
@@ -0,0 +1,124 @@
+#ifndef RENDER_H
+#define RENDER_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Table capacity for a single component
+#define RENDER_MAX_COLS 12
+#define RENDER_MAX_ROWS 64
+
+// Cell value types; the type decides formatting, units and sort order
+typedef enum {
+    CELL_EMPTY = 0,
+    CELL_TEXT,      // Borrowed string, must outlive the frame
+    CELL_INT,       // Signed integer
+    CELL_PERCENT,   // Percentage, rendered with a % suffix
+    CELL_BYTES,     // Byte count, rendered with B/KB/MB/GB/TB units
+    CELL_RATE,      // Rate in Mbps, rendered with Kbps/Mbps/Gbps units
+    CELL_DURATION   // Nanoseconds, rendered with ns/us/ms/s units
+} CellType;
+
+// Column alignment inside its fixed width
+typedef enum {
+    ALIGN_LEFT = 0,
+    ALIGN_RIGHT
+} CellAlign;
+
+// Single typed cell
+typedef struct {
+    CellType type;
+    union {
+        const char *text;
+        long long i;
+        double f;
+        unsigned long long bytes;
+        unsigned long long ns;
+    } v;
+    bool anomaly;   // Value is unusual for its series; drawn highlighted
+} RenderCell;
+
+// Column definition, usually a static const table per component
+typedef struct {
+    const char *header;
+    int width;        // Fixed width in characters, 0 = take the remaining width
+    CellAlign align;
+    double warn;      // Percentages >= warn use COLOR_WARN (0 = disabled)
+    double crit;      // Percentages >= crit use COLOR_CRIT (0 = disabled)
+} RenderColumn;
+
+// Row of cells, indexed by column
+typedef struct {
+    RenderCell cells[RENDER_MAX_COLS];
+} RenderRow;
+
+// Structured content of a component
+typedef struct {
+    const RenderColumn *columns;
+    int num_columns;
+    RenderRow rows[RENDER_MAX_ROWS];
+    int num_rows;
+    bool show_header;
+    bool sortable;        // Rows may be reordered by the component sort state
+    const char *message;  // Drawn instead of the rows when set
+    char row_header[24];  // Replaces the first column's header when set
+} RenderTable;
+
+// Produces one row of a list on demand
+typedef void (*RenderRowFn)(void *ctx, int index, RenderRow *row);
+
+// Virtual list: rows are filled through a callback, and only the rows that
+// end up on screen are ever formatted
+typedef struct {
+    const RenderColumn *columns;
+    int num_columns;
+    int num_rows;
+    RenderRowFn fill_row;
+    RenderRowFn fill_key; // Cheap fill used to extract sort keys, NULL = fill_row
+    void *ctx;
+    bool show_header;
+    bool sortable;
+    bool partial_order;   // Order only the rows up to the end of the window
+    int tiebreak_column;  // Orders equal keys, -1 = collection order
+    const char *message;
+    const char *row_header; // Replaces the first column's header when set
+} RenderList;
+
+// Table construction
+void render_table_init(RenderTable *table, const RenderColumn *columns, int num_columns);
+RenderRow* render_table_add_row(RenderTable *table);
+void render_table_set_message(RenderTable *table, const char *message);
+
+// Cell setters
+void render_cell_text(RenderRow *row, int col, const char *text);
+void render_cell_int(RenderRow *row, int col, long long value);
+void render_cell_percent(RenderRow *row, int col, double value);
+void render_cell_bytes(RenderRow *row, int col, unsigned long long value);
+void render_cell_rate(RenderRow *row, int col, double rate_mbps);
+void render_cell_duration(RenderRow *row, int col, unsigned long long ns);
+
+// Highlight a cell set above as anomalous
+void render_cell_anomaly(RenderRow *row, int col, bool anomaly);
+
+// Cell access
+bool render_cell_is_numeric(const RenderCell *cell);
+double render_cell_value(const RenderCell *cell);
+int render_cell_compare(const RenderCell *a, const RenderCell *b);
+int render_format_cell(const RenderCell *cell, char *buffer, size_t buffer_size);
+
+// List construction
+void render_list_init(RenderList *list, const RenderColumn *columns, int num_columns,
+                      int num_rows, RenderRowFn fill_row, void *ctx);
+void render_list_from_table(RenderList *list, const RenderTable *table);
+
+// Display order of a list sorted by a column. Stable, so equal rows keep
+// their collection order. The returned array is reused by the next call.
+const int* render_list_order(const RenderList *list, int column, bool descending);
+
+// Partial selection of the first `limit` rows in that order, through a
+// bounded heap: O(n log limit) instead of a full sort. Equal keys fall back
+// to the list's tiebreak column so rows do not trade places between frames.
+// Entries past `limit` in the returned array are undefined.
+const int* render_list_top(const RenderList *list, int column, bool descending, int limit);
+
+#endif // RENDER_H
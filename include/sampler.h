@@ -0,0 +1,40 @@
+#ifndef SAMPLER_H
+#define SAMPLER_H
+
+#include <stdbool.h>
+
+// Accepted sampling intervals
+#define SAMPLER_MIN_INTERVAL_NS 10000000ULL        // 10 ms
+#define SAMPLER_MAX_INTERVAL_NS 60000000000ULL     // 60 s
+
+// Sampling clock. Deadlines fall on wall-clock multiples of the interval
+// (every second on the second, every 250 ms on the quarter), but are kept
+// and armed on CLOCK_MONOTONIC as absolute times, so a late wake-up never
+// pushes later samples back and clock steps cannot stall sampling. Where
+// timerfd is unavailable, sampler_wait falls back to a poll timeout.
+typedef struct {
+    int fd;                             // timerfd, -1 = poll timeout only
+    unsigned long long interval_ns;
+    unsigned long long deadline_ns;     // Monotonic time of the next sample
+    unsigned long long sample_ns;       // Monotonic time the last sample was due
+    long long jitter_ns;                // How late the last sample started
+    unsigned long long missed;          // Deadlines skipped by overrunning samples
+} Sampler;
+
+// The first deadline is the next wall-clock boundary
+int sampler_init(Sampler *sampler, unsigned long long interval_ns);
+void sampler_free(Sampler *sampler);
+
+// Block until a sample is due or input_fd (-1 = none) is readable, or a
+// signal arrives. Returns true when a sample is due; the next deadline is
+// armed and jitter_ns updated.
+bool sampler_wait(Sampler *sampler, int input_fd);
+
+// Skip deadlines: the next one becomes the first boundary no more than half
+// an interval before until_ns. Skipped deadlines are not counted as missed.
+void sampler_defer(Sampler *sampler, unsigned long long until_ns);
+
+// Make the next sampler_wait return at once, e.g. after a panel toggle
+void sampler_trigger(Sampler *sampler);
+
+#endif // SAMPLER_H
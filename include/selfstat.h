@@ -0,0 +1,72 @@
+#ifndef SELFSTAT_H
+#define SELFSTAT_H
+
+#include <stdbool.h>
+#include <stdio.h>
+#include "histogram.h"
+
+// Instrumented stages of a monitor tick
+typedef enum {
+    SELFSTAT_CPU = 0,
+    SELFSTAT_MEMORY,
+    SELFSTAT_KERNEL,
+    SELFSTAT_DISK,
+    SELFSTAT_NETWORK,
+    SELFSTAT_PROCESS,
+    SELFSTAT_INTERRUPTS,
+    SELFSTAT_NETSTACK,
+    SELFSTAT_SOCKETS,
+    SELFSTAT_NUMA,
+    SELFSTAT_DISPLAY,
+    SELFSTAT_REFRESH,
+    SELFSTAT_JITTER,        // Lateness of each sample against its deadline
+    SELFSTAT_STAGE_COUNT
+} SelfStatStage;
+
+// Resource usage of the monitor process itself
+typedef struct {
+    double syscalls_per_tick;   // read/write family syscalls, from /proc/self/io
+    long rss_kb;
+    double cpu_percent;         // User + system time over wall time
+    unsigned long long ticks;
+    bool valid;
+} SelfProcessStats;
+
+// Process usage snapshot
+typedef struct {
+    unsigned long long wall_ns;
+    unsigned long long cpu_ns;
+    unsigned long long syscalls;
+    unsigned long long ticks;
+    bool has_syscalls;
+} SelfUsageSnapshot;
+
+// Overhead accounting of one monitor instance. Process usage is that of
+// the whole process, so with several instances it covers them all.
+typedef struct {
+    Histogram stages[SELFSTAT_STAGE_COUNT];
+    unsigned long long ticks;
+    SelfUsageSnapshot start_usage;
+    SelfUsageSnapshot last_usage;
+} SelfStat;
+
+// Reset histograms and take the process usage baseline
+void selfstat_init(SelfStat *stat);
+
+// Monotonic clock in nanoseconds
+unsigned long long selfstat_now(void);
+
+// Stage timing
+void selfstat_record(SelfStat *stat, SelfStatStage stage, unsigned long long elapsed_ns);
+const Histogram* selfstat_histogram(const SelfStat *stat, SelfStatStage stage);
+const char* selfstat_stage_name(SelfStatStage stage);
+
+// Process accounting: call selfstat_tick once per sample, and
+// selfstat_sample_process to get usage since its previous call
+void selfstat_tick(SelfStat *stat);
+bool selfstat_sample_process(SelfStat *stat, SelfProcessStats *stats);
+
+// Summary since start, for --self-stats
+void selfstat_dump(const SelfStat *stat, FILE *fp);
+
+#endif // SELFSTAT_H
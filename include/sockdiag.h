@@ -0,0 +1,55 @@
+#ifndef SOCKDIAG_H
+#define SOCKDIAG_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// TCP states as numbered by the kernel (include/net/tcp_states.h)
+typedef enum {
+    TCP_STATE_ESTABLISHED = 1,
+    TCP_STATE_SYN_SENT,
+    TCP_STATE_SYN_RECV,
+    TCP_STATE_FIN_WAIT1,
+    TCP_STATE_FIN_WAIT2,
+    TCP_STATE_TIME_WAIT,
+    TCP_STATE_CLOSE,
+    TCP_STATE_CLOSE_WAIT,
+    TCP_STATE_LAST_ACK,
+    TCP_STATE_LISTEN,
+    TCP_STATE_CLOSING,
+    TCP_STATE_NEW_SYN_RECV,
+    TCP_STATE_COUNT
+} TcpState;
+
+#define SOCKDIAG_MAX_PORTS 256
+
+// Listening port, merged across address families and SO_REUSEPORT listeners
+typedef struct {
+    unsigned short port;
+    int listeners;
+    unsigned int accept_queue;    // Connections waiting for accept()
+    unsigned int backlog;         // listen() backlog limit
+    unsigned int connections;     // Non-listening sockets on this local port
+} ListenPort;
+
+typedef struct {
+    int fd;                       // NETLINK_SOCK_DIAG socket, kept open
+    unsigned char *buffer;        // Batched receive buffer
+    size_t buffer_size;
+    unsigned int *port_counts;    // Non-listening sockets per local port
+    unsigned int states[TCP_STATE_COUNT];
+    unsigned int total;
+    ListenPort ports[SOCKDIAG_MAX_PORTS];  // Busiest first after an update
+    int num_ports;
+    bool valid;
+} SockDiagStats;
+
+int sockdiag_init(SockDiagStats *stats);
+void sockdiag_free(SockDiagStats *stats);
+
+// Dump every IPv4 and IPv6 TCP socket and aggregate by state and port
+bool sockdiag_update(SockDiagStats *stats);
+
+const char* sockdiag_state_name(TcpState state);
+
+#endif // SOCKDIAG_H
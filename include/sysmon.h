@@ -3,6 +3,25 @@
 
 #include <stdbool.h>
 #include <time.h>
+#include "table.h"
+#include "process.h"
+#include "meminfo.h"
+#include "counter.h"
+#include "interrupts.h"
+#include "netstack.h"
+#include "sockdiag.h"
+#include "numa.h"
+#include "window.h"
+#include "anomaly.h"
+#include "selfstat.h"
+#include "cadence.h"
+
+// Tick counters kept per CPU id, from the cpuN lines of /proc/stat
+typedef enum {
+    CPU_TICKS_BUSY = 0,       // All but idle and iowait
+    CPU_TICKS_TOTAL,
+    CPU_TICKS_COUNT
+} CpuTicks;
 
 // CPU Statistics structure
 typedef struct {
@@ -11,22 +30,36 @@ typedef struct {
     long system_time;
     long idle_time;
     long total_time;
+    CounterBank counters;     // Raw tick counters of the aggregate cpu line
+    CounterBank per_cpu;      // cpu id * CPU_TICKS_COUNT + counter
+    float *cpu_percent;       // Per CPU id, over the last interval
+    int cpu_slots;            // Highest CPU id seen + 1
+    char *text;               // /proc/stat, also parsed for the kernel collector
+    size_t text_capacity;
     bool valid;
 } CPUStats;
 
-// Memory Statistics structure
+// Memory Statistics structure: the raw /proc/meminfo values plus derived
+// figures with free(1) semantics
 typedef struct {
+    unsigned long long values[MEMINFO_KEY_COUNT];
+    bool present[MEMINFO_KEY_COUNT];
     long total_kb;
-    long used_kb;
+    long used_kb;             // Total - available
     long free_kb;
     long available_kb;
     long buffers_kb;
-    long cached_kb;
+    long cached_kb;           // Cached + SReclaimable
+    long shared_kb;           // Shmem
     float usage_percent;
+    long swap_total_kb;
+    long swap_used_kb;
+    long swap_free_kb;
+    float swap_percent;
     bool valid;
 } MemoryStats;
 
-// Disk Statistics structure
+// Disk Statistics structure, keyed by mount point
 typedef struct {
     char device[64];
     char mount_point[128];
@@ -37,7 +70,7 @@ typedef struct {
     bool valid;
 } DiskStats;
 
-// Network Statistics structure
+// Network Statistics structure, keyed by interface name
 typedef struct {
     char interface_name[32];
     unsigned long long rx_bytes;
@@ -49,35 +82,194 @@ typedef struct {
     bool valid;
 } NetworkStats;
 
-// System Monitor main structure
+// Kernel activity counters from /proc/stat and /proc/vmstat
+typedef enum {
+    KERNEL_CONTEXT_SWITCHES = 0,  // stat: ctxt
+    KERNEL_INTERRUPTS,            // stat: intr (total)
+    KERNEL_FORKS,                 // stat: processes
+    KERNEL_PAGE_FAULTS,           // vmstat: pgfault
+    KERNEL_MAJOR_FAULTS,          // vmstat: pgmajfault
+    KERNEL_SWAP_IN,               // vmstat: pswpin, pages
+    KERNEL_SWAP_OUT,              // vmstat: pswpout, pages
+    KERNEL_PAGES_SCANNED,         // vmstat: pgscan_{kswapd,direct,...}
+    KERNEL_PAGES_STOLEN,          // vmstat: pgsteal_{kswapd,direct,...}
+    KERNEL_COUNTER_COUNT
+} KernelCounter;
+
+typedef struct {
+    CounterBank counters;     // Indexed by KernelCounter
+    unsigned long long stat_counters[KERNEL_COUNTER_COUNT];  // Left by the CPU collector's /proc/stat pass
+    bool stat_pending;        // stat_counters not consumed yet
+    long procs_running;
+    long procs_blocked;
+    bool has_vmstat;
+    bool valid;
+} KernelStats;
+
+// Rolling windows and anomaly detectors over the headline system metrics
+typedef enum {
+    SYSTEM_WINDOW_CPU_USAGE = 0,
+    SYSTEM_WINDOW_MEMORY_USAGE,
+    SYSTEM_WINDOW_SWAP_USAGE,
+    SYSTEM_WINDOW_COUNT
+} SystemWindow;
+
+// Collectors with their own adaptive cadence; the others follow one
+typedef enum {
+    SYSMON_CADENCE_CPU = 0,   // Also kernel activity, processes, interrupts
+    SYSMON_CADENCE_MEMORY,
+    SYSMON_CADENCE_DISK,
+    SYSMON_CADENCE_NETWORK,   // Also network stack and sockets
+    SYSMON_CADENCE_COUNT
+} SysmonCadence;
+
+// Default change, in percent, that snaps an adaptive collector back
+#define SYSMON_DEFAULT_ADAPTIVE_DELTA 5.0
+
+// Default rolling window span
+#define SYSMON_DEFAULT_WINDOW_NS 60000000000ULL
+
+// One monitor instance. Everything a sample produces lives here, so any
+// number of instances can run side by side in one process, each driven
+// from one thread at a time. Embedders read the fields and the const
+// accessors below directly: they point at the instance's own storage, are
+// never copied, and stay valid until its next update or cleanup.
 typedef struct {
     CPUStats cpu;
     MemoryStats memory;
-    DiskStats disks[8];
+    KernelStats kernel;
+    StatTable disks;          // DiskStats entries
     int disk_count;
-    NetworkStats interfaces[16];
+    StatTable interfaces;     // NetworkStats entries
+    CounterBank interface_counters;  // Per interface slot: rx/tx bytes and packets
     int interface_count;
-    int update_interval_ms;
+    StatTable processes;      // ProcessStats entries, keyed by pid
+    int process_count;
+    bool collect_processes;   // Process scans only run while someone looks
+    unsigned long long process_sample_ns;  // Monotonic time of the last scan
+    ProcessScan process_scan; // Open stat descriptors, read in one batch
+    InterruptStats interrupts;  // Per-CPU IRQ and softirq matrices
+    bool collect_interrupts;  // Wide on big hosts; parsed only while shown
+    NetstackStats netstack;   // Softnet, SNMP and socket counters
+    bool collect_netstack;
+    SockDiagStats sockets;    // TCP sockets by state and listening port
+    bool collect_sockets;
+    NumaStats numa;           // Per-node memory and per-CPU usage by node
+    bool collect_numa;
+    unsigned long long window_ns;  // Span of every rolling window
+    WindowBank windows;       // Indexed by SystemWindow
+    WindowBank disk_windows;  // Usage percent per disk slot
+    WindowBank interface_windows;  // Per interface slot: rx, tx rate
+    AnomalyBank anomalies;    // Same series as the windows above
+    AnomalyBank disk_anomalies;
+    AnomalyBank interface_anomalies;
+    unsigned long long update_interval_ns;  // Base sampling interval
+    unsigned long long sample_ns;  // Monotonic time the last sample started
+    bool adaptive;            // Back off collectors whose values hold still
+    double adaptive_delta;    // Percent change that snaps one back
+    Cadence cadences[SYSMON_CADENCE_COUNT];
+    unsigned int sampled;     // Bits of SysmonCadence sampled last update
     bool running;
+    SelfStat selfstat;        // Collector timings of this instance
+    char proc_root[256];      // procfs mount, "/proc" unless overridden
+    char sys_root[256];       // sysfs mount, "/sys" unless overridden
 } SystemMonitor;
 
-// Global system monitor instance
-extern SystemMonitor g_sysmon;
+// Initialization and cleanup of a caller-owned instance
+int sysmon_init(SystemMonitor *mon);
+void sysmon_cleanup(SystemMonitor *mon);
+
+// Filesystem roots, so collectors can run against fixture trees.
+// NULL keeps the current root.
+void sysmon_set_roots(SystemMonitor *mon, const char *proc_root, const char *sys_root);
+const char* sysmon_proc_path(const SystemMonitor *mon, const char *relative, char *buffer, size_t buffer_size);
+const char* sysmon_sys_path(const SystemMonitor *mon, const char *relative, char *buffer, size_t buffer_size);
+
+// Rolling window span for every windowed metric; windows start over
+int sysmon_set_window(SystemMonitor *mon, unsigned long long span_ns);
+
+// Anomaly threshold in standard deviations, and whether to keep a daily
+// seasonal baseline; detectors start over
+int sysmon_set_anomaly(SystemMonitor *mon, double threshold, bool seasonal);
+
+// Adaptive sampling: a collector whose activity changes by less than
+// delta percent (points for usage, relative for rates) over consecutive
+// samples is polled every 2, 4, ... base intervals; delta <= 0 turns it off
+// and every collector runs each update again.
+void sysmon_set_adaptive(SystemMonitor *mon, double delta);
+
+// Read the cached per-process stat files through io_uring, in batches of
+// BATCH_READ_DEPTH per system call, instead of one pread each. Returns true
+// when io_uring is in use; false when it was not asked for or the kernel
+// refuses it, and the synchronous reads stay.
+bool sysmon_set_io_uring(SystemMonitor *mon, bool enabled);
+
+// Every collector back to the base interval, due at the next update, e.g.
+// on user input; true if any had backed off
+bool sysmon_wake(SystemMonitor *mon);
+
+// Monotonic time the earliest collector is due; the caller may sleep until
+// then. The last sample time plus one interval when not adaptive.
+unsigned long long sysmon_next_due(const SystemMonitor *mon);
+
+// Effective interval of the collector behind a stage, 0 for other stages
+unsigned long long sysmon_stage_interval(const SystemMonitor *mon, SelfStatStage stage);
+
+// Seasonal baseline file, one "name slot count mean var" line per trained
+// slot with alert-style names (cpu.usage, disk./home.usage, net.eth0.rx_rate).
+// Load after the first sample so device series exist; unknown names are
+// skipped. Both return 0 on success.
+int sysmon_load_baseline(SystemMonitor *mon, const char *path);
+int sysmon_save_baseline(const SystemMonitor *mon, const char *path);
+
+// Update functions; table collectors return the entry count, which they
+// also store in the instance. sysmon_update_all runs the collectors that
+// are due and records which in `sampled`.
+void sysmon_update_all(SystemMonitor *mon);
+bool sysmon_update_cpu(SystemMonitor *mon);
+bool sysmon_update_memory(SystemMonitor *mon);
+bool sysmon_update_kernel(SystemMonitor *mon);
+int sysmon_update_disks(SystemMonitor *mon);
+int sysmon_update_network(SystemMonitor *mon);
+int sysmon_update_processes(SystemMonitor *mon);
+bool sysmon_update_interrupts(SystemMonitor *mon);
+bool sysmon_update_netstack(SystemMonitor *mon);
+bool sysmon_update_sockets(SystemMonitor *mon);
+bool sysmon_update_numa(SystemMonitor *mon);
+
+// Entry access, in collection order of the last sample. Processes are
+// writable only for their detail cache, see sysmon_process_details.
+const DiskStats* sysmon_get_disk(const SystemMonitor *mon, int index);
+const NetworkStats* sysmon_get_interface(const SystemMonitor *mon, int index);
+ProcessStats* sysmon_get_process(SystemMonitor *mon, int index);
+
+// Rolling window summaries, for panels and exporters; false until the
+// window holds a sample
+bool sysmon_window_stats(const SystemMonitor *mon, SystemWindow window, WindowStats *stats);
+bool sysmon_disk_window(const SystemMonitor *mon, int index, WindowStats *stats);
+bool sysmon_interface_window(const SystemMonitor *mon, int index, bool transmit, WindowStats *stats);
+
+// Anomaly verdicts for the same series; false until the series has a sample
+bool sysmon_anomaly(const SystemMonitor *mon, SystemWindow series, AnomalyState *state);
+bool sysmon_disk_anomaly(const SystemMonitor *mon, int index, AnomalyState *state);
+bool sysmon_interface_anomaly(const SystemMonitor *mon, int index, bool transmit, AnomalyState *state);
+
+// Expensive process fields, for rows on screen or exporters; cached per field
+unsigned int sysmon_process_details(const SystemMonitor *mon, ProcessStats *proc, unsigned int mask);
 
-// Initialization and cleanup
-int sysmon_init(void);
-void sysmon_cleanup(void);
+// Raw meminfo value in kB (pages for HugePages_*), 0 when the kernel lacks it
+unsigned long long sysmon_meminfo(const MemoryStats *memory, MeminfoKey key);
+const char* sysmon_meminfo_name(MeminfoKey key);
 
-// Update functions
-void sysmon_update_all(void);
-bool sysmon_update_cpu(CPUStats *cpu);
-bool sysmon_update_memory(MemoryStats *memory);
-int sysmon_update_disks(DiskStats *disks, int max_disks);
-int sysmon_update_network(NetworkStats *interfaces, int max_interfaces);
+// Display name of a kernel activity counter
+const char* sysmon_kernel_counter_name(KernelCounter counter);
 
 // Utility functions
 void sysmon_format_bytes(unsigned long long bytes, char *buffer, size_t buffer_size);
 void sysmon_format_rate(double rate_mbps, char *buffer, size_t buffer_size);
+void sysmon_format_duration(unsigned long long ns, char *buffer, size_t buffer_size);
+bool sysmon_parse_duration(const char *text, unsigned long long *ns);  // "500ms", "30s", "5m", "1h"
+bool sysmon_parse_size(const char *text, unsigned long long *bytes);  // "4096", "512k", "4M", "1GB"
 const char* sysmon_get_error_string(void);
 
 #endif // SYSMON_H
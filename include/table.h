@@ -0,0 +1,80 @@
+#ifndef TABLE_H
+#define TABLE_H
+
+#include <stdbool.h>
+#include <stddef.h>
+
+// Entries per arena chunk; chunks are never moved, so entry pointers stay
+// valid for as long as the entry is present
+#define STAT_TABLE_CHUNK 64
+
+// Per-slot bookkeeping, kept apart from the entries themselves
+typedef struct {
+    unsigned int hash;
+    unsigned int epoch;       // Sample in which the entry was last seen
+    unsigned int generation;  // Bumped every time the slot is reused
+    bool in_use;
+} StatSlot;
+
+// Growable table of fixed-size entries keyed by a name stored inside the
+// entry (interface name, mount point). Lookups go through an open-addressing
+// hash index; entries that disappear from a sample are swept and their
+// memory is reused for the next new key.
+typedef struct {
+    size_t entry_size;
+    size_t key_offset;        // Offset of the char[] key inside an entry
+    size_t key_size;
+
+    unsigned char **chunks;   // Entry arena
+    int num_chunks;
+
+    StatSlot *slots;          // Indexed by slot id
+    int num_slots;            // Slot ids handed out so far
+
+    int *index;               // Open-addressing index of slot ids, -1 = empty
+    int index_capacity;       // Power of two
+    int index_used;
+
+    int *free_slots;          // Slots of departed entries, reused first
+    int num_free;
+
+    int *rows;                // Slots seen in the current sample, in order
+    int *prev_rows;           // Slots seen in the previous sample
+    int num_rows;
+    int num_prev_rows;
+    int rows_capacity;
+
+    unsigned int epoch;
+} StatTable;
+
+// Lifecycle
+int stat_table_init(StatTable *table, size_t entry_size, size_t key_offset, size_t key_size);
+void stat_table_free(StatTable *table);
+
+// Sampling: begin, upsert every key present, then end to sweep the rest.
+// Upsert also hands back the entry's slot id when slot is not NULL (-1 on
+// failure); slot ids are dense, so they can index side arrays of per-entry
+// data.
+void stat_table_begin(StatTable *table);
+void* stat_table_upsert(StatTable *table, const char *key, bool *created, int *slot);
+void stat_table_end(StatTable *table);
+
+// Take back the last upsert of this sample, for a key that vanished before
+// its entry could be filled: a new entry is released at once, a known one
+// departs at stat_table_end
+void stat_table_cancel(StatTable *table, int slot, bool created);
+
+// Lookup and iteration over the entries of the last sample
+void* stat_table_find(const StatTable *table, const char *key);
+int stat_table_count(const StatTable *table);
+void* stat_table_row(const StatTable *table, int row);
+void* stat_table_entry(const StatTable *table, int slot);
+int stat_table_slot(const StatTable *table, int row);
+
+// Stable references: a slot id plus the generation it had when looked up
+// stays valid until the entry departs and the slot is reused
+int stat_table_find_slot(const StatTable *table, const char *key);
+bool stat_table_slot_valid(const StatTable *table, int slot, unsigned int generation);
+unsigned int stat_table_generation(const StatTable *table, int slot);
+
+#endif // TABLE_H
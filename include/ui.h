@@ -3,6 +3,7 @@
 
 #include <ncurses.h>
 #include <stdbool.h>
+#include "render.h"
 
 // Component IDs
 
@@ -10,6 +11,13 @@
 #define COMPONENT_MEMORY  1
 #define COMPONENT_DISK    2
 #define COMPONENT_NETWORK 3
+#define COMPONENT_OVERHEAD 4
+#define COMPONENT_PROCESS 5
+#define COMPONENT_SYSTEM  6
+#define COMPONENT_INTERRUPTS 7
+#define COMPONENT_NETSTACK 8
+#define COMPONENT_SOCKETS 9
+#define COMPONENT_NUMA    10
 
 // Color pairs
 #define COLOR_CPU     1
@@ -17,9 +25,21 @@
 #define COLOR_DISK    3
 #define COLOR_NETWORK 4
 #define COLOR_HEADER  5
+#define COLOR_WARN    6
+#define COLOR_CRIT    7
 
 // Maximum number of UI components
-#define MAX_COMPONENTS 10
+#define MAX_COMPONENTS 16
+
+// A panel is refreshed after this many deferred frames even over the cap
+#define UI_MAX_DEFERRED_FRAMES 5
+
+// Value last drawn in one content cell, for low-bandwidth coalescing
+typedef struct {
+    RenderCell cell;
+    unsigned int row_key;  // Hash of the row's first cell; another row never inherits it
+    bool valid;
+} UIShownCell;
 
 // UI Component structure
 typedef struct {
@@ -28,6 +48,18 @@ typedef struct {
     int width, height;
     int color_pair;
     WINDOW *window;
+    bool visible;          // Hidden components get no window or grid cell
+    int sort_column;       // Column used to order table rows, -1 = collection order
+    bool sort_descending;
+    int table_columns;     // Sortable columns in the last rendered table
+    int num_rows;          // Rows in the last rendered list
+    int page_rows;         // Rows that fit on screen
+    int scroll_offset;     // First row on screen
+    int cursor;            // Selected row, highlighted while focused
+    bool alert;            // An alert rule on this component is firing
+    int frame_bytes;       // Terminal output of its last flush, low-bandwidth mode
+    int deferred;          // Frames its refresh has been held back
+    UIShownCell *shown;    // (height - 3) * RENDER_MAX_COLS, while coalescing
 } UIComponent;
 
 // Layout manager structure
@@ -36,6 +68,7 @@ typedef struct {
     int num_components;
     int terminal_width, terminal_height;
     int layout_dirty;
+    int focused;           // Component receiving keyboard commands
 } UILayout;
 
 // Global layout manager instance
@@ -45,6 +78,21 @@ extern UILayout g_layout;
 int ui_init(void);
 void ui_cleanup(void);
 
+// Low-bandwidth mode for slow links. Each frame writes at most frame_bytes
+// to the terminal (0 = no cap): the focused panel goes first, then the
+// panels kept waiting longest, and a panel whose last refresh would
+// overrun the cap waits for a later frame with fresher content. The cap is
+// soft: the focused panel is always flushed, costs are those of each panel's
+// previous flush (estimated from touched cells without /proc/self/io), and
+// a panel held UI_MAX_DEFERRED_FRAMES frames is flushed regardless. Numbers
+// are redrawn only once they move by more than coalesce_percent of the
+// value on screen (points for percentages); 0 redraws every change.
+void ui_set_low_bandwidth(int frame_bytes, double coalesce_percent);
+
+// Terminal output over the last five seconds or so, in bytes per second; -1
+// while unknown or without /proc/self/io
+double ui_output_rate(void);
+
 // Layout management
 void ui_calculate_layout(void);
 void ui_handle_resize(void);
@@ -52,6 +100,15 @@ void ui_handle_resize(void);
 // Component management
 int ui_create_component(const char* title, int color_pair);
 void ui_update_component(int component_id, const char* content);
+void ui_set_component_visible(int component_id, bool visible);
+bool ui_is_component_visible(int component_id);
+void ui_set_component_alert(int component_id, bool alert);
+void ui_set_component_sort(int component_id, int column, bool descending);
+void ui_render_list(int component_id, const RenderList *list);
+void ui_render_table(int component_id, const RenderTable *table);
+
+// Keyboard handling, returns true when the key was consumed
+bool ui_handle_key(int ch);
 
 // Drawing functions
 void ui_refresh_all(void);
@@ -0,0 +1,66 @@
+#ifndef WINDOW_H
+#define WINDOW_H
+
+#include <stdbool.h>
+#include "histogram.h"
+
+// Upper bound on samples held per window; windows sampled faster than
+// span / WINDOW_MAX_SAMPLES cover the most recent WINDOW_MAX_SAMPLES only
+#define WINDOW_MAX_SAMPLES 1024
+
+// Values are kept in the quantile sketch in thousandths
+#define WINDOW_SKETCH_SCALE 1000.0
+
+// Summary of one window
+typedef struct {
+    double min;
+    double max;
+    double avg;
+    double p95;
+    int samples;
+} WindowStats;
+
+// Per-window bookkeeping; the sample rings live in the bank's stripes
+typedef struct {
+    int head;                       // Oldest sample
+    int size;
+    int min_head, min_size;         // Monotonic deques of ring indices
+    int max_head, max_size;
+    double sum;
+    unsigned int tag;               // Owner generation, see window_bank_push
+} WindowState;
+
+// A bank of rolling windows over the same time span, indexed like a
+// counter bank (per metric, or per table slot). Every window owns a fixed
+// stripe of `capacity` samples: a ring of values and times, two monotonic
+// deques for min and max, and log-linear bucket counts for quantiles, so
+// a push is O(1) amortized and memory never grows with traffic.
+typedef struct {
+    unsigned long long span_ns;
+    int capacity;                   // Samples per window
+    int count;                      // Windows in use
+    int allocated;
+    float *values;                  // count * capacity
+    unsigned int *times_ms;         // Monotonic milliseconds, wrap-safe
+    unsigned short *min_deque;
+    unsigned short *max_deque;
+    unsigned short *buckets;        // count * HISTOGRAM_BUCKETS
+    WindowState *state;
+} WindowBank;
+
+// capacity is derived from the span and the expected sampling interval
+int window_bank_init(WindowBank *bank, unsigned long long span_ns, unsigned long long interval_ns);
+void window_bank_free(WindowBank *bank);
+int window_bank_reserve(WindowBank *bank, int count);
+
+// Change the span (and capacity); every window starts over
+int window_bank_set_span(WindowBank *bank, unsigned long long span_ns, unsigned long long interval_ns);
+
+// Add a sample. A window whose tag differs from the one given (a table
+// slot that was reused by another device) is emptied first.
+void window_bank_push(WindowBank *bank, int index, unsigned int tag, double value, unsigned long long now_ns);
+
+// Summary of a window; false when it holds no samples
+bool window_bank_stats(const WindowBank *bank, int index, WindowStats *stats);
+
+#endif // WINDOW_H
@@ -0,0 +1,531 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "alert.h"
+#include "sysmon.h"
+#include "metrics.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <strings.h>
+#include <ctype.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <stddef.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+
+typedef enum {
+    VALUE_FLOAT = METRIC_FLOAT,
+    VALUE_DOUBLE = METRIC_DOUBLE,
+    VALUE_LONG = METRIC_LONG,
+    VALUE_ULL = METRIC_ULL
+} AlertValueType;
+
+typedef enum {
+    OP_GT = 0,
+    OP_GE,
+    OP_LT,
+    OP_LE,
+    OP_EQ,
+    OP_NE
+} AlertOp;
+
+typedef enum {
+    STATE_IDLE = 0,
+    STATE_PENDING,    // Condition holds, waiting out the "for" duration
+    STATE_FIRING
+} AlertState;
+
+// Unit family accepted by a metric
+typedef enum {
+    UNIT_PERCENT = 0,
+    UNIT_SIZE,        // Stored in kB
+    UNIT_RATE,        // Stored in Mbps
+    UNIT_NONE         // Plain numbers only
+} AlertUnit;
+
+// Everything evaluation touches, packed together so a tick walks one flat
+// array. Fields of device tables are read through a slot reference that is
+// re-resolved only when the entry goes away.
+typedef struct {
+    const void *value;          // Scalar metric, NULL for table fields
+    const StatTable *table;
+    int slot;                   // -1 while the key is absent
+    unsigned int generation;
+    unsigned int offset;        // Field offset inside a table entry
+    unsigned char type;         // AlertValueType
+    unsigned char op;           // AlertOp
+    unsigned char subsystem;    // AlertSubsystem
+    unsigned char state;        // AlertState
+    double threshold;
+    double clear;               // Must stop holding for the rule to clear
+    unsigned long long for_ns;
+    unsigned long long cooldown_ns;
+    unsigned long long since_ns;     // Start of the pending period
+    unsigned long long hook_ns;      // Last time the hook ran
+    bool hook_ran;
+} AlertPredicate;
+
+// Cold per-rule data, only touched when resolving keys or running hooks
+typedef struct {
+    char *text;
+    char *key;                  // Mount point or interface name
+    char *hook;
+} AlertRuleInfo;
+
+typedef struct {
+    AlertPredicate *predicates;
+    AlertRuleInfo *info;
+    int count;
+    int capacity;
+    int firing;
+    int subsystem_firing[ALERT_SUBSYSTEM_COUNT];
+} AlertEngine;
+
+static AlertEngine engine;
+
+// Rule metrics come from the registry: scalar metrics point into the
+// monitor, per-device metrics name a table and a field within its entries
+static AlertSubsystem metric_subsystem(const MetricDesc *metric) {
+    switch (metric->group) {
+        case METRIC_GROUP_MEMORY:  return ALERT_SUBSYSTEM_MEMORY;
+        case METRIC_GROUP_DISK:    return ALERT_SUBSYSTEM_DISK;
+        case METRIC_GROUP_NETWORK: return ALERT_SUBSYSTEM_NETWORK;
+        default:                   return ALERT_SUBSYSTEM_CPU;
+    }
+}
+
+static AlertUnit metric_unit(const MetricDesc *metric) {
+    switch (metric->unit) {
+        case METRIC_PERCENT: return UNIT_PERCENT;
+        case METRIC_KB:      return UNIT_SIZE;
+        case METRIC_MBPS:    return UNIT_RATE;
+        default:             return UNIT_NONE;
+    }
+}
+
+// Multipliers into the stored unit of each family
+typedef struct {
+    const char *suffix;
+    AlertUnit unit;
+    double scale;
+} AlertUnitSuffix;
+
+static const AlertUnitSuffix unit_suffixes[] = {
+    { "%",    UNIT_PERCENT, 1.0 },
+    { "KB",   UNIT_SIZE,    1.0 },
+    { "MB",   UNIT_SIZE,    1024.0 },
+    { "GB",   UNIT_SIZE,    1024.0 * 1024.0 },
+    { "TB",   UNIT_SIZE,    1024.0 * 1024.0 * 1024.0 },
+    { "Kbps", UNIT_RATE,    1.0 / 1024.0 },
+    { "Mbps", UNIT_RATE,    1.0 },
+    { "Gbps", UNIT_RATE,    1024.0 },
+};
+
+static void set_error(char *err_buffer, size_t err_size, const char *message, const char *detail) {
+    if (!err_buffer || err_size == 0) return;
+    if (detail) {
+        snprintf(err_buffer, err_size, "%s '%s'", message, detail);
+    } else {
+        snprintf(err_buffer, err_size, "%s", message);
+    }
+}
+
+static char* copy_string(const char *text, size_t length) {
+    char *copy = malloc(length + 1);
+    if (copy) {
+        memcpy(copy, text, length);
+        copy[length] = '\0';
+    }
+    return copy;
+}
+
+static const char* skip_spaces(const char *p) {
+    while (*p && isspace((unsigned char)*p)) p++;
+    return p;
+}
+
+// Read the next whitespace-delimited word into buffer
+static const char* read_word(const char *p, char *buffer, size_t size) {
+    size_t n = 0;
+    p = skip_spaces(p);
+    while (*p && !isspace((unsigned char)*p)) {
+        if (n + 1 < size) buffer[n++] = *p;
+        p++;
+    }
+    buffer[n] = '\0';
+    return p;
+}
+
+static bool parse_op(const char *p, AlertOp *op, const char **end) {
+    static const struct { const char *text; AlertOp op; } ops[] = {
+        { ">=", OP_GE }, { "<=", OP_LE }, { "==", OP_EQ }, { "!=", OP_NE },
+        { ">", OP_GT }, { "<", OP_LT },
+    };
+
+    for (size_t i = 0; i < sizeof(ops) / sizeof(ops[0]); i++) {
+        size_t len = strlen(ops[i].text);
+        if (strncmp(p, ops[i].text, len) == 0) {
+            *op = ops[i].op;
+            *end = p + len;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Number with an optional unit of the metric's family
+static bool parse_value(const char *word, AlertUnit unit, double *value) {
+    char *end;
+    errno = 0;
+    double number = strtod(word, &end);
+    if (end == word || errno != 0) return false;
+
+    if (*end == '\0') {
+        *value = number;
+        return true;
+    }
+
+    for (size_t i = 0; i < sizeof(unit_suffixes) / sizeof(unit_suffixes[0]); i++) {
+        if (unit_suffixes[i].unit == unit && strcasecmp(end, unit_suffixes[i].suffix) == 0) {
+            *value = number * unit_suffixes[i].scale;
+            return true;
+        }
+    }
+    return false;
+}
+
+// Split "<prefix>.<key>.<field>" at the first and last dot, so mount points
+// and VLAN interfaces may contain dots themselves
+static const MetricDesc* resolve_metric(const char *name, char *key, size_t key_size) {
+    const char *first = strchr(name, '.');
+    const char *last = strrchr(name, '.');
+    if (!first) return NULL;
+
+    size_t prefix_len = first - name;
+    const char *field = last + 1;
+    key[0] = '\0';
+
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        const MetricDesc *metric = &metric_table[i];
+        const char *prefix = metric_group_prefixes[metric->group];
+        if (strlen(prefix) != prefix_len || strncmp(name, prefix, prefix_len) != 0 ||
+            strcmp(field, metric->field) != 0) {
+            continue;
+        }
+
+        if (!metric_keyed(metric)) {
+            return (first == last) ? metric : NULL;
+        }
+
+        size_t key_len = last - first - 1;
+        if (first == last || key_len == 0 || key_len >= key_size) return NULL;
+        memcpy(key, first + 1, key_len);
+        key[key_len] = '\0';
+        return metric;
+    }
+
+    return NULL;
+}
+
+static bool reserve_rules(int count) {
+    if (count <= engine.capacity) return true;
+
+    int capacity = engine.capacity ? engine.capacity * 2 : 16;
+    while (capacity < count) capacity *= 2;
+
+    AlertPredicate *predicates = realloc(engine.predicates, capacity * sizeof(AlertPredicate));
+    if (!predicates) return false;
+    engine.predicates = predicates;
+
+    AlertRuleInfo *info = realloc(engine.info, capacity * sizeof(AlertRuleInfo));
+    if (!info) return false;
+    engine.info = info;
+
+    engine.capacity = capacity;
+    return true;
+}
+
+int alert_add_rule(const SystemMonitor *mon, const char *text, char *err_buffer, size_t err_size) {
+    if (!text) return -1;
+
+    AlertPredicate pred;
+    memset(&pred, 0, sizeof(pred));
+    pred.slot = -1;
+
+    // Metric name runs up to whitespace or the operator
+    const char *p = skip_spaces(text);
+    const char *name_start = p;
+    while (*p && !isspace((unsigned char)*p) && !strchr("<>=!", *p)) p++;
+
+    char name[192];
+    size_t name_len = p - name_start;
+    if (name_len == 0 || name_len >= sizeof(name)) {
+        set_error(err_buffer, err_size, "missing or overlong metric name", NULL);
+        return -1;
+    }
+    memcpy(name, name_start, name_len);
+    name[name_len] = '\0';
+
+    char key[128];
+    const MetricDesc *metric = resolve_metric(name, key, sizeof(key));
+    if (!metric) {
+        set_error(err_buffer, err_size, "unknown metric", name);
+        return -1;
+    }
+
+    AlertOp op;
+    p = skip_spaces(p);
+    if (!parse_op(p, &op, &p)) {
+        set_error(err_buffer, err_size, "expected one of > >= < <= == != after", name);
+        return -1;
+    }
+
+    char word[192];
+    p = read_word(p, word, sizeof(word));
+    if (!parse_value(word, metric_unit(metric), &pred.threshold)) {
+        set_error(err_buffer, err_size, "invalid threshold", word);
+        return -1;
+    }
+    pred.clear = pred.threshold;
+
+    // Optional clauses, in any order; "run" takes the rest of the line
+    const char *hook = NULL;
+    for (;;) {
+        p = read_word(p, word, sizeof(word));
+        if (!word[0]) break;
+
+        if (strcmp(word, "run") == 0) {
+            hook = skip_spaces(p);
+            if (!*hook) {
+                set_error(err_buffer, err_size, "missing command after 'run'", NULL);
+                return -1;
+            }
+            break;
+        }
+
+        char arg[64];
+        p = read_word(p, arg, sizeof(arg));
+
+        bool ok;
+        if (strcmp(word, "for") == 0) {
+            ok = sysmon_parse_duration(arg, &pred.for_ns);
+        } else if (strcmp(word, "cooldown") == 0) {
+            ok = sysmon_parse_duration(arg, &pred.cooldown_ns);
+        } else if (strcmp(word, "clear") == 0) {
+            ok = parse_value(arg, metric_unit(metric), &pred.clear);
+        } else {
+            set_error(err_buffer, err_size, "unknown clause", word);
+            return -1;
+        }
+
+        if (!ok) {
+            set_error(err_buffer, err_size, "invalid argument", arg);
+            return -1;
+        }
+    }
+
+    pred.type = (unsigned char)metric->type;
+    pred.op = op;
+    pred.subsystem = metric_subsystem(metric);
+    if (metric_keyed(metric)) {
+        pred.table = metric_table_of(mon, metric);
+        pred.offset = (unsigned int)metric->locator;
+    } else {
+        pred.value = metric_field(mon, metric);
+    }
+
+    if (!reserve_rules(engine.count + 1)) {
+        set_error(err_buffer, err_size, "out of memory", NULL);
+        return -1;
+    }
+
+    AlertRuleInfo info;
+    text = skip_spaces(text);
+    info.text = copy_string(text, strcspn(text, "\n"));
+    info.key = metric_keyed(metric) ? copy_string(key, strlen(key)) : NULL;
+    info.hook = hook ? copy_string(hook, strcspn(hook, "\n")) : NULL;
+    if (!info.text || (metric_keyed(metric) && !info.key) || (hook && !info.hook)) {
+        free(info.text);
+        free(info.key);
+        free(info.hook);
+        set_error(err_buffer, err_size, "out of memory", NULL);
+        return -1;
+    }
+
+    engine.predicates[engine.count] = pred;
+    engine.info[engine.count] = info;
+    engine.count++;
+    return 0;
+}
+
+int alert_load_file(const SystemMonitor *mon, const char *path, char *err_buffer, size_t err_size) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) {
+        set_error(err_buffer, err_size, strerror(errno), path);
+        return -1;
+    }
+
+    char line[1024];
+    int line_number = 0;
+    int result = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        line_number++;
+
+        char *comment = strchr(line, '#');
+        if (comment) *comment = '\0';
+        if (!*skip_spaces(line)) continue;
+
+        char message[256];
+        if (alert_add_rule(mon, line, message, sizeof(message)) != 0) {
+            if (err_buffer && err_size > 0) {
+                snprintf(err_buffer, err_size, "%s:%d: %s", path, line_number, message);
+            }
+            result = -1;
+            break;
+        }
+    }
+
+    fclose(fp);
+    return result;
+}
+
+void alert_clear_rules(void) {
+    for (int i = 0; i < engine.count; i++) {
+        free(engine.info[i].text);
+        free(engine.info[i].key);
+        free(engine.info[i].hook);
+    }
+
+    free(engine.predicates);
+    free(engine.info);
+    memset(&engine, 0, sizeof(engine));
+}
+
+int alert_rule_count(void) {
+    return engine.count;
+}
+
+// Run a rule's hook detached from the terminal, with the match in its
+// environment
+static void run_hook(const AlertRuleInfo *info, const char *metric, double value) {
+    pid_t pid = fork();
+    if (pid != 0) return; // Parent, or fork failed
+
+    int null_fd = open("/dev/null", O_RDWR);
+    if (null_fd >= 0) {
+        dup2(null_fd, STDIN_FILENO);
+        dup2(null_fd, STDOUT_FILENO);
+        dup2(null_fd, STDERR_FILENO);
+        if (null_fd > STDERR_FILENO) close(null_fd);
+    }
+
+    char value_text[64];
+    snprintf(value_text, sizeof(value_text), "%.2f", value);
+    setenv("PISYSMON_RULE", info->text, 1);
+    setenv("PISYSMON_METRIC", metric, 1);
+    setenv("PISYSMON_VALUE", value_text, 1);
+
+    execl("/bin/sh", "sh", "-c", info->hook, (char *)NULL);
+    _exit(127);
+}
+
+static void reap_hooks(void) {
+    while (waitpid(-1, NULL, WNOHANG) > 0) {
+    }
+}
+
+static bool compare(AlertOp op, double value, double threshold) {
+    switch (op) {
+        case OP_GT: return value > threshold;
+        case OP_GE: return value >= threshold;
+        case OP_LT: return value < threshold;
+        case OP_LE: return value <= threshold;
+        case OP_EQ: return value == threshold;
+        case OP_NE: return value != threshold;
+    }
+    return false;
+}
+
+// Current value of a predicate's metric, false when its device is gone
+static bool load_value(AlertPredicate *pred, const AlertRuleInfo *info, double *value) {
+    const void *field = pred->value;
+
+    if (!field) {
+        if (!stat_table_slot_valid(pred->table, pred->slot, pred->generation)) {
+            pred->slot = stat_table_find_slot(pred->table, info->key);
+            if (pred->slot < 0) return false;
+            pred->generation = stat_table_generation(pred->table, pred->slot);
+        }
+        field = (const unsigned char *)stat_table_entry(pred->table, pred->slot) + pred->offset;
+    }
+
+    switch ((AlertValueType)pred->type) {
+        case VALUE_FLOAT:  *value = *(const float *)field; break;
+        case VALUE_DOUBLE: *value = *(const double *)field; break;
+        case VALUE_LONG:   *value = (double)*(const long *)field; break;
+        case VALUE_ULL:    *value = (double)*(const unsigned long long *)field; break;
+    }
+    return true;
+}
+
+void alert_evaluate(unsigned long long now_ns) {
+    reap_hooks();
+
+    engine.firing = 0;
+    memset(engine.subsystem_firing, 0, sizeof(engine.subsystem_firing));
+
+    for (int i = 0; i < engine.count; i++) {
+        AlertPredicate *pred = &engine.predicates[i];
+        double value = 0.0;
+        bool present = load_value(pred, &engine.info[i], &value);
+
+        if (pred->state == STATE_FIRING) {
+            // Stay firing until the value moves past the clear threshold
+            if (present && compare((AlertOp)pred->op, value, pred->clear)) {
+                engine.firing++;
+                engine.subsystem_firing[pred->subsystem]++;
+            } else {
+                pred->state = STATE_IDLE;
+            }
+            continue;
+        }
+
+        if (!present || !compare((AlertOp)pred->op, value, pred->threshold)) {
+            pred->state = STATE_IDLE;
+            continue;
+        }
+
+        if (pred->state == STATE_IDLE) {
+            pred->state = STATE_PENDING;
+            pred->since_ns = now_ns;
+        }
+
+        if (now_ns - pred->since_ns < pred->for_ns) continue;
+
+        pred->state = STATE_FIRING;
+        engine.firing++;
+        engine.subsystem_firing[pred->subsystem]++;
+
+        // Cooldown limits how often the hook runs for a flapping metric
+        const AlertRuleInfo *info = &engine.info[i];
+        if (info->hook && (!pred->hook_ran || now_ns - pred->hook_ns >= pred->cooldown_ns)) {
+            char metric[192];
+            snprintf(metric, sizeof(metric), "%.*s", (int)strcspn(info->text, " \t<>=!"), info->text);
+            run_hook(info, metric, value);
+            pred->hook_ran = true;
+            pred->hook_ns = now_ns;
+        }
+    }
+}
+
+int alert_firing_count(void) {
+    return engine.firing;
+}
+
+bool alert_subsystem_firing(AlertSubsystem subsystem) {
+    if ((int)subsystem < 0 || subsystem >= ALERT_SUBSYSTEM_COUNT) return false;
+    return engine.subsystem_firing[subsystem] > 0;
+}
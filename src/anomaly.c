@@ -0,0 +1,178 @@
+#include "anomaly.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#define HALF_LIFE_NS (300ULL * 1000000000ULL)
+#define SEASON_MEMORY_DAYS 3.0
+#define SECONDS_PER_DAY 86400LL
+
+int anomaly_bank_init(AnomalyBank *bank, unsigned long long interval_ns, double threshold,
+                      double floor, bool seasonal) {
+    if (!bank || interval_ns == 0) return -1;
+
+    memset(bank, 0, sizeof(AnomalyBank));
+    bank->alpha = 1.0 - pow(0.5, (double)interval_ns / HALF_LIFE_NS);
+    bank->threshold = threshold > 0 ? threshold : ANOMALY_DEFAULT_Z;
+    bank->floor = floor;
+
+    // A slot sees this many samples a day; trust it after one day's worth
+    double slot_samples = (double)(SECONDS_PER_DAY / ANOMALY_SEASON_SLOTS) * 1e9 / interval_ns;
+    if (slot_samples < 1) slot_samples = 1;
+    bank->season_alpha = seasonal ? 1.0 / (SEASON_MEMORY_DAYS * slot_samples) : 0.0;
+    bank->season_warmup = (unsigned int)slot_samples;
+    bank->seasonal = seasonal;
+    return 0;
+}
+
+void anomaly_bank_free(AnomalyBank *bank) {
+    if (!bank) return;
+
+    free(bank->series);
+    free(bank->season);
+    memset(bank, 0, sizeof(AnomalyBank));
+}
+
+// Grow one array, zeroing the new tail
+static bool grow(void **array, size_t element_size, int old_count, int new_count) {
+    void *grown = realloc(*array, (size_t)new_count * element_size);
+    if (!grown) return false;
+
+    memset((unsigned char *)grown + (size_t)old_count * element_size, 0,
+           (size_t)(new_count - old_count) * element_size);
+    *array = grown;
+    return true;
+}
+
+int anomaly_bank_reserve(AnomalyBank *bank, int count) {
+    if (!bank || count < 0) return -1;
+
+    if (count > bank->allocated) {
+        int allocated = bank->allocated ? bank->allocated : 4;
+        while (allocated < count) allocated *= 2;
+
+        if (!grow((void **)&bank->series, sizeof(AnomalySeries), bank->allocated, allocated)) return -1;
+        if (bank->seasonal &&
+            !grow((void **)&bank->season, ANOMALY_SEASON_SLOTS * sizeof(SeasonSlot), bank->allocated, allocated)) {
+            return -1;
+        }
+        bank->allocated = allocated;
+    }
+
+    if (count > bank->count) {
+        bank->count = count;
+    }
+    return 0;
+}
+
+void anomaly_bank_begin(AnomalyBank *bank, long long wall_seconds) {
+    if (!bank) return;
+
+    long long of_day = wall_seconds % SECONDS_PER_DAY;
+    if (of_day < 0) of_day += SECONDS_PER_DAY;
+    bank->slot = (int)(of_day / (SECONDS_PER_DAY / ANOMALY_SEASON_SLOTS));
+}
+
+// Incremental EWMA of mean and variance (West / Finch)
+static inline void ewma_update(float *mean, float *var, double alpha, double value) {
+    double diff = value - *mean;
+    double increment = alpha * diff;
+    *mean = (float)(*mean + increment);
+    *var = (float)((1.0 - alpha) * (*var + diff * increment));
+}
+
+static inline double z_score(const AnomalyBank *bank, double value, double mean, double var) {
+    double stddev = sqrt(var);
+    double floor = 0.05 * fabs(mean);
+    if (floor < bank->floor) floor = bank->floor;
+    if (stddev < floor) stddev = floor;
+    return stddev > 0 ? (value - mean) / stddev : 0.0;
+}
+
+bool anomaly_bank_push(AnomalyBank *bank, int index, unsigned int tag, double value) {
+    if (!bank || index < 0 || index >= bank->count) return false;
+
+    AnomalySeries *s = &bank->series[index];
+    SeasonSlot *slot = bank->seasonal ? &bank->season[(size_t)index * ANOMALY_SEASON_SLOTS + bank->slot] : NULL;
+
+    if (s->tag != tag) {
+        memset(s, 0, sizeof(AnomalySeries));
+        s->tag = tag;
+        if (bank->seasonal) {
+            memset(&bank->season[(size_t)index * ANOMALY_SEASON_SLOTS], 0, ANOMALY_SEASON_SLOTS * sizeof(SeasonSlot));
+        }
+    }
+
+    // Score against the state before this sample
+    if (s->count == 0) {
+        s->mean = (float)value;
+        s->var = 0.0f;
+    }
+    s->scored_mean = s->mean;
+    s->scored_var = s->var;
+    s->z = (float)z_score(bank, value, s->mean, s->var);
+    bool unusual = s->count >= ANOMALY_WARMUP && fabs(s->z) >= bank->threshold;
+
+    s->seasonal_ready = slot && slot->count >= bank->season_warmup;
+    s->seasonal_z = s->seasonal_ready ? (float)z_score(bank, value, slot->mean, slot->var) : 0.0f;
+    if (s->seasonal_ready) {
+        unusual = unusual && fabs(s->seasonal_z) >= bank->threshold;
+    }
+    s->anomalous = unusual;
+
+    ewma_update(&s->mean, &s->var, bank->alpha, value);
+    s->count++;
+
+    if (slot) {
+        if (slot->count == 0) {
+            slot->mean = (float)value;
+        }
+        // Average the first day's samples evenly, then decay
+        double alpha = slot->count < bank->season_warmup ? 1.0 / (slot->count + 1) : bank->season_alpha;
+        ewma_update(&slot->mean, &slot->var, alpha, value);
+        slot->count++;
+    }
+
+    return s->anomalous;
+}
+
+bool anomaly_bank_state(const AnomalyBank *bank, int index, AnomalyState *state) {
+    if (!bank || !state || index < 0 || index >= bank->count) return false;
+
+    const AnomalySeries *s = &bank->series[index];
+    if (s->count == 0) return false;
+
+    state->mean = s->scored_mean;
+    state->stddev = sqrt(s->scored_var);
+    state->z = s->z;
+    state->seasonal_z = s->seasonal_z;
+    state->seasonal_ready = s->seasonal_ready;
+    state->anomalous = s->anomalous;
+    return true;
+}
+
+int anomaly_bank_save(const AnomalyBank *bank, int index, const char *name, FILE *fp) {
+    if (!bank || !bank->seasonal || !name || !fp || index < 0 || index >= bank->count) return -1;
+
+    const SeasonSlot *slots = &bank->season[(size_t)index * ANOMALY_SEASON_SLOTS];
+    for (int i = 0; i < ANOMALY_SEASON_SLOTS; i++) {
+        if (slots[i].count == 0) continue;
+        if (fprintf(fp, "%s %d %u %.9g %.9g\n", name, i, slots[i].count, slots[i].mean, slots[i].var) < 0) {
+            return -1;
+        }
+    }
+    return 0;
+}
+
+int anomaly_bank_load(AnomalyBank *bank, int index, int slot, unsigned int count, double mean, double var) {
+    if (!bank || !bank->seasonal || index < 0 || index >= bank->count ||
+        slot < 0 || slot >= ANOMALY_SEASON_SLOTS || var < 0) {
+        return -1;
+    }
+
+    SeasonSlot *s = &bank->season[(size_t)index * ANOMALY_SEASON_SLOTS + slot];
+    s->count = count;
+    s->mean = (float)mean;
+    s->var = (float)var;
+    return 0;
+}
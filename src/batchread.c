@@ -0,0 +1,200 @@
+#define _DEFAULT_SOURCE
+
+#include "batchread.h"
+#include <stdlib.h>
+#include <string.h>
+#include <errno.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <linux/io_uring.h>
+
+// Marks a request the ring has not completed, so a fallback knows what is left
+#define BATCH_PENDING (-ECANCELED)
+
+// No liburing: the three system calls are all the reader needs
+static int uring_setup(unsigned int entries, struct io_uring_params *params) {
+    return (int)syscall(__NR_io_uring_setup, entries, params);
+}
+
+static int uring_enter(int fd, unsigned int to_submit, unsigned int min_complete, unsigned int flags) {
+    return (int)syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, NULL, 0);
+}
+
+static int uring_register(int fd, unsigned int opcode, void *arg, unsigned int nr_args) {
+    return (int)syscall(__NR_io_uring_register, fd, opcode, arg, nr_args);
+}
+
+static void* map_ring(int fd, unsigned long size, off_t offset) {
+    void *map = mmap(NULL, size, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, fd, offset);
+    return map == MAP_FAILED ? NULL : map;
+}
+
+// Kernels before 5.6 have rings but no plain read opcode
+static bool read_supported(int fd) {
+    size_t size = sizeof(struct io_uring_probe) + IORING_OP_LAST * sizeof(struct io_uring_probe_op);
+    struct io_uring_probe *probe = calloc(1, size);
+    if (!probe) return false;
+
+    bool supported = uring_register(fd, IORING_REGISTER_PROBE, probe, IORING_OP_LAST) == 0 &&
+                     probe->ops_len > IORING_OP_READ &&
+                     (probe->ops[IORING_OP_READ].flags & IO_URING_OP_SUPPORTED);
+    free(probe);
+    return supported;
+}
+
+static bool setup_ring(BatchReader *reader) {
+    struct io_uring_params params;
+    memset(&params, 0, sizeof(params));
+
+    int fd = uring_setup(BATCH_READ_DEPTH, &params);
+    if (fd < 0) return false;
+    reader->ring_fd = fd;
+    reader->entries = params.sq_entries;
+    if (!read_supported(fd)) return false;
+
+    reader->sq_map_size = params.sq_off.array + params.sq_entries * sizeof(unsigned int);
+    reader->cq_map_size = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    if (params.features & IORING_FEAT_SINGLE_MMAP) {
+        if (reader->cq_map_size > reader->sq_map_size) reader->sq_map_size = reader->cq_map_size;
+        reader->sq_map = map_ring(fd, reader->sq_map_size, IORING_OFF_SQ_RING);
+        reader->cq_map = reader->sq_map;
+    } else {
+        reader->sq_map = map_ring(fd, reader->sq_map_size, IORING_OFF_SQ_RING);
+        reader->cq_map = map_ring(fd, reader->cq_map_size, IORING_OFF_CQ_RING);
+    }
+    reader->sqes_size = params.sq_entries * sizeof(struct io_uring_sqe);
+    reader->sqes = map_ring(fd, reader->sqes_size, IORING_OFF_SQES);
+    if (!reader->sq_map || !reader->cq_map || !reader->sqes) return false;
+
+    unsigned char *sq = reader->sq_map;
+    unsigned char *cq = reader->cq_map;
+    reader->sq_head = (unsigned int *)(sq + params.sq_off.head);
+    reader->sq_tail = (unsigned int *)(sq + params.sq_off.tail);
+    reader->sq_mask = (unsigned int *)(sq + params.sq_off.ring_mask);
+    reader->sq_array = (unsigned int *)(sq + params.sq_off.array);
+    reader->cq_head = (unsigned int *)(cq + params.cq_off.head);
+    reader->cq_tail = (unsigned int *)(cq + params.cq_off.tail);
+    reader->cq_mask = (unsigned int *)(cq + params.cq_off.ring_mask);
+    reader->cqes = cq + params.cq_off.cqes;
+
+    // Submission slot i always carries sqe i
+    for (unsigned int i = 0; i < params.sq_entries; i++) {
+        reader->sq_array[i] = i;
+    }
+    return true;
+}
+
+static void teardown_ring(BatchReader *reader) {
+    if (reader->sqes) munmap(reader->sqes, reader->sqes_size);
+    if (reader->cq_map && reader->cq_map != reader->sq_map) munmap(reader->cq_map, reader->cq_map_size);
+    if (reader->sq_map) munmap(reader->sq_map, reader->sq_map_size);
+    if (reader->ring_fd >= 0) close(reader->ring_fd);
+
+    unsigned long long syscalls = reader->syscalls;
+    memset(reader, 0, sizeof(BatchReader));
+    reader->ring_fd = -1;
+    reader->syscalls = syscalls;
+}
+
+int batch_reader_init(BatchReader *reader, bool use_uring) {
+    if (!reader) return -1;
+
+    memset(reader, 0, sizeof(BatchReader));
+    reader->ring_fd = -1;
+    if (use_uring && !setup_ring(reader)) {
+        teardown_ring(reader);
+    }
+    return 0;
+}
+
+void batch_reader_free(BatchReader *reader) {
+    if (reader) teardown_ring(reader);
+}
+
+bool batch_reader_uses_uring(const BatchReader *reader) {
+    return reader && reader->ring_fd >= 0;
+}
+
+static void finish(BatchRead *read, int result) {
+    read->result = result;
+    if (result >= 0) read->buffer[result] = '\0';
+}
+
+static void read_sync(BatchReader *reader, BatchRead *read) {
+    ssize_t n = pread(read->fd, read->buffer, read->size - 1, 0);
+    reader->syscalls++;
+    finish(read, n < 0 ? -errno : (int)n);
+}
+
+static int reap(BatchReader *reader, BatchRead *reads) {
+    const struct io_uring_cqe *cqes = reader->cqes;
+    unsigned int head = *reader->cq_head;
+    unsigned int tail = __atomic_load_n(reader->cq_tail, __ATOMIC_ACQUIRE);
+    int reaped = 0;
+
+    for (; head != tail; head++, reaped++) {
+        const struct io_uring_cqe *cqe = &cqes[head & *reader->cq_mask];
+        finish(&reads[cqe->user_data], cqe->res);
+    }
+    __atomic_store_n(reader->cq_head, head, __ATOMIC_RELEASE);
+    return reaped;
+}
+
+// Keep the ring full and wait for everything in flight on each enter, so
+// a batch of n files costs about n / entries system calls. Returns false
+// when the ring stopped working; nothing is in flight then.
+static bool run_ring(BatchReader *reader, BatchRead *reads, int count) {
+    struct io_uring_sqe *sqes = reader->sqes;
+    int queued = 0, submitted = 0, completed = 0;
+
+    while (completed < count) {
+        // In flight never exceeds the ring, so neither queue can overflow
+        unsigned int tail = *reader->sq_tail;
+        while (queued < count && queued - completed < (int)reader->entries) {
+            struct io_uring_sqe *sqe = &sqes[tail & *reader->sq_mask];
+            memset(sqe, 0, sizeof(*sqe));
+            sqe->opcode = IORING_OP_READ;
+            sqe->fd = reads[queued].fd;
+            sqe->addr = (unsigned long)reads[queued].buffer;
+            sqe->len = reads[queued].size - 1;
+            sqe->off = 0;
+            sqe->user_data = (unsigned long long)queued;
+            tail++;
+            queued++;
+        }
+        __atomic_store_n(reader->sq_tail, tail, __ATOMIC_RELEASE);
+
+        int ret = uring_enter(reader->ring_fd, (unsigned int)(queued - submitted),
+                              (unsigned int)(queued - completed), IORING_ENTER_GETEVENTS);
+        reader->syscalls++;
+        if (ret < 0 && errno != EINTR && errno != EAGAIN && errno != EBUSY) {
+            if (submitted == completed) return false;
+            ret = 0;
+        }
+        if (ret > 0) submitted += ret;
+        completed += reap(reader, reads);
+    }
+    return true;
+}
+
+int batch_read_run(BatchReader *reader, BatchRead *reads, int count) {
+    if (!reader || !reads || count <= 0) return 0;
+
+    for (int i = 0; i < count; i++) {
+        reads[i].result = BATCH_PENDING;
+    }
+
+    // A ring that fails hands the rest of this batch, and every later one,
+    // to the synchronous path
+    if (batch_reader_uses_uring(reader) && !run_ring(reader, reads, count)) {
+        teardown_ring(reader);
+    }
+
+    int ok = 0;
+    for (int i = 0; i < count; i++) {
+        if (reads[i].result == BATCH_PENDING) read_sync(reader, &reads[i]);
+        if (reads[i].result > 0) ok++;
+    }
+    return ok;
+}
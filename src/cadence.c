@@ -0,0 +1,48 @@
+#include "cadence.h"
+#include <math.h>
+
+void cadence_reset(Cadence *cadence) {
+    if (!cadence) return;
+
+    cadence->stride = 1;
+    cadence->calm = 0;
+    cadence->due_ns = 0;
+    cadence->last = 0.0;
+    cadence->primed = false;
+}
+
+bool cadence_due(const Cadence *cadence, unsigned long long now_ns, unsigned long long interval_ns) {
+    return now_ns + interval_ns / 2 >= cadence->due_ns;
+}
+
+void cadence_observe(Cadence *cadence, double value, double floor, double threshold,
+                     unsigned long long now_ns, unsigned long long interval_ns) {
+    if (cadence->primed) {
+        double scale = fabs(cadence->last) > floor ? fabs(cadence->last) : floor;
+        double change = scale > 0.0 ? 100.0 * fabs(value - cadence->last) / scale : 0.0;
+
+        if (change > threshold) {
+            cadence->stride = 1;
+            cadence->calm = 0;
+        } else if (++cadence->calm >= CADENCE_CALM_SAMPLES) {
+            unsigned long long stretched = 2ULL * cadence->stride * interval_ns;
+            if (cadence->stride * 2 <= CADENCE_MAX_STRIDE && stretched <= CADENCE_MAX_INTERVAL_NS) {
+                cadence->stride *= 2;
+            }
+            cadence->calm = 0;
+        }
+    }
+
+    cadence->last = value;
+    cadence->primed = true;
+    cadence->due_ns = now_ns + cadence->stride * interval_ns;
+}
+
+bool cadence_wake(Cadence *cadence) {
+    bool backed_off = cadence->stride > 1;
+
+    cadence->stride = 1;
+    cadence->calm = 0;
+    cadence->due_ns = 0;
+    return backed_off;
+}
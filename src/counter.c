@@ -0,0 +1,109 @@
+#include "counter.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define COUNTER_32BIT_LIMIT 0x100000000ULL
+#define COUNTER_32BIT_MASK  0xffffffffULL
+
+int counter_bank_init(CounterBank *bank, int count) {
+    if (!bank) return -1;
+
+    memset(bank, 0, sizeof(CounterBank));
+    return counter_bank_reserve(bank, count);
+}
+
+void counter_bank_free(CounterBank *bank) {
+    if (!bank) return;
+
+    free(bank->current);
+    free(bank->previous);
+    free(bank->deltas);
+    free(bank->rates);
+    free(bank->flags);
+    memset(bank, 0, sizeof(CounterBank));
+}
+
+// Grow one array, zeroing the new tail
+static bool grow(void **array, size_t element_size, int old_count, int new_count) {
+    void *grown = realloc(*array, (size_t)new_count * element_size);
+    if (!grown) return false;
+
+    memset((unsigned char *)grown + (size_t)old_count * element_size, 0,
+           (size_t)(new_count - old_count) * element_size);
+    *array = grown;
+    return true;
+}
+
+int counter_bank_reserve(CounterBank *bank, int count) {
+    if (!bank || count < 0) return -1;
+
+    if (count > bank->capacity) {
+        int capacity = bank->capacity ? bank->capacity : 8;
+        while (capacity < count) capacity *= 2;
+
+        if (!grow((void **)&bank->current, sizeof(unsigned long long), bank->capacity, capacity) ||
+            !grow((void **)&bank->previous, sizeof(unsigned long long), bank->capacity, capacity) ||
+            !grow((void **)&bank->deltas, sizeof(unsigned long long), bank->capacity, capacity) ||
+            !grow((void **)&bank->rates, sizeof(double), bank->capacity, capacity) ||
+            !grow((void **)&bank->flags, sizeof(unsigned char), bank->capacity, capacity)) {
+            return -1;
+        }
+        bank->capacity = capacity;
+    }
+
+    if (count > bank->count) {
+        bank->count = count;
+    }
+    return 0;
+}
+
+void counter_bank_begin(CounterBank *bank) {
+    if (!bank) return;
+
+    // Last sample becomes the previous one; current is overwritten next
+    unsigned long long *swap = bank->previous;
+    bank->previous = bank->current;
+    bank->current = swap;
+}
+
+void counter_bank_commit(CounterBank *bank, unsigned long long now_ns) {
+    if (!bank) return;
+
+    bool has_prev = bank->has_prev && now_ns > bank->sample_ns;
+    double elapsed = has_prev ? (now_ns - bank->sample_ns) / 1e9 : 0.0;
+    double per_sec = has_prev ? 1.0 / elapsed : 0.0;
+    unsigned long long keep = has_prev ? ~0ULL : 0;
+    int resets = 0;
+
+    const unsigned long long *cur = bank->current;
+    const unsigned long long *prev = bank->previous;
+    unsigned long long *deltas = bank->deltas;
+    double *rates = bank->rates;
+    unsigned char *flags = bank->flags;
+
+    // Branch-free body over contiguous arrays. A counter that went
+    // backwards is a wrap if both values fit in 32 bits and the drop is more
+    // than half the range (32-bit kernels export unsigned long counters);
+    // otherwise the source was reset and the sample contributes nothing.
+    for (int i = 0; i < bank->count; i++) {
+        unsigned long long c = cur[i];
+        unsigned long long p = prev[i];
+        unsigned long long delta = c - p;
+        int backwards = c < p;
+        int narrow = ((c | p) < COUNTER_32BIT_LIMIT) & ((p - c) > (COUNTER_32BIT_LIMIT >> 1));
+        int wrapped = backwards & narrow & has_prev;
+        int reset = backwards & !narrow & has_prev;
+
+        delta = wrapped ? (delta & COUNTER_32BIT_MASK) : (backwards ? 0 : delta);
+        delta &= keep;
+        deltas[i] = delta;
+        rates[i] = (double)delta * per_sec;
+        flags[i] = (unsigned char)(reset * COUNTER_FLAG_RESET | wrapped * COUNTER_FLAG_WRAPPED);
+        resets += reset;
+    }
+
+    bank->resets = resets;
+    bank->elapsed_sec = elapsed;
+    bank->sample_ns = now_ns;
+    bank->has_prev = true;
+}
@@ -0,0 +1,75 @@
+#include "histogram.h"
+#include <string.h>
+
+void histogram_reset(Histogram *hist) {
+    if (!hist) return;
+    memset(hist, 0, sizeof(Histogram));
+}
+
+int histogram_bucket(unsigned long long value) {
+    if (value < HISTOGRAM_SUB_COUNT) {
+        return (int)value;
+    }
+
+    int msb = 63 - __builtin_clzll(value);
+    if (msb >= HISTOGRAM_MAX_BITS) {
+        return HISTOGRAM_BUCKETS - 1;
+    }
+
+    // Octave from the top bit, sub-bucket from the next HISTOGRAM_SUB_BITS bits
+    int shift = msb - HISTOGRAM_SUB_BITS;
+    int sub = (int)(value >> shift) - HISTOGRAM_SUB_COUNT;
+    return (shift + 1) * HISTOGRAM_SUB_COUNT + sub;
+}
+
+unsigned long long histogram_bucket_value(int bucket) {
+    if (bucket < 0) return 0;
+    if (bucket < HISTOGRAM_SUB_COUNT) return (unsigned long long)bucket;
+
+    int shift = bucket / HISTOGRAM_SUB_COUNT - 1;
+    unsigned long long sub = (unsigned long long)(bucket % HISTOGRAM_SUB_COUNT + HISTOGRAM_SUB_COUNT);
+    unsigned long long low = sub << shift;
+
+    // Midpoint of the bucket range
+    return low + ((1ULL << shift) >> 1);
+}
+
+void histogram_record(Histogram *hist, unsigned long long value) {
+    if (!hist) return;
+
+    hist->counts[histogram_bucket(value)]++;
+    hist->sum += value;
+
+    if (hist->total == 0 || value < hist->min) hist->min = value;
+    if (value > hist->max) hist->max = value;
+    hist->total++;
+}
+
+unsigned long long histogram_percentile(const Histogram *hist, double quantile) {
+    if (!hist || hist->total == 0) return 0;
+
+    if (quantile <= 0.0) return hist->min;
+    if (quantile >= 1.0) return hist->max;
+
+    unsigned long long rank = (unsigned long long)(quantile * hist->total + 0.5);
+    if (rank == 0) rank = 1;
+
+    unsigned long long seen = 0;
+    for (int i = 0; i < HISTOGRAM_BUCKETS; i++) {
+        seen += hist->counts[i];
+        if (seen >= rank) {
+            // Never report past the exact extremes
+            unsigned long long value = histogram_bucket_value(i);
+            if (value > hist->max) value = hist->max;
+            if (value < hist->min) value = hist->min;
+            return value;
+        }
+    }
+
+    return hist->max;
+}
+
+double histogram_mean(const Histogram *hist) {
+    if (!hist || hist->total == 0) return 0.0;
+    return (double)hist->sum / hist->total;
+}
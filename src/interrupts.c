@@ -0,0 +1,214 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "interrupts.h"
+#include "procfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// The kernel prints every count as " %10u", so columns are 11 characters
+// wide until a count outgrows ten digits
+#define COLUMN_WIDTH 11
+
+static void matrix_free(InterruptMatrix *matrix) {
+    free(matrix->lines);
+    free(matrix->line_rates);
+    free(matrix->text);
+    counter_bank_free(&matrix->counters);
+    memset(matrix, 0, sizeof(InterruptMatrix));
+}
+
+int interrupts_init(InterruptStats *stats) {
+    if (!stats) return -1;
+
+    memset(stats, 0, sizeof(InterruptStats));
+    if (counter_bank_init(&stats->irqs.counters, 0) != 0 ||
+        counter_bank_init(&stats->softirqs.counters, 0) != 0) {
+        interrupts_free(stats);
+        return -1;
+    }
+    return 0;
+}
+
+void interrupts_free(InterruptStats *stats) {
+    if (!stats) return;
+
+    matrix_free(&stats->irqs);
+    matrix_free(&stats->softirqs);
+}
+
+static inline bool is_digit(char c) {
+    return (unsigned char)(c - '0') < 10;
+}
+
+// Parse up to num_cpus counts starting at p. While columns keep the fixed
+// kernel width each count is read from its own ten-character window with a
+// fixed trip count and no data-dependent branches; a wider count drops to the
+// generic scanner for the rest of the row.
+static const char* scan_counts(const char *p, const char *eol, int num_cpus,
+                               unsigned long long *out, int *parsed) {
+    int n = 0;
+
+    while (n < num_cpus && eol - p >= COLUMN_WIDTH && p[0] == ' ' && is_digit(p[COLUMN_WIDTH - 1]) &&
+           (p + COLUMN_WIDTH == eol || p[COLUMN_WIDTH] == ' ')) {
+        unsigned long long value = 0;
+        for (int k = 1; k < COLUMN_WIDTH; k++) {
+            unsigned int digit = (unsigned char)p[k] - '0';
+            value = digit < 10 ? value * 10 + digit : value;
+        }
+        out[n++] = value;
+        p += COLUMN_WIDTH;
+    }
+
+    while (n < num_cpus) {
+        while (p < eol && *p == ' ') p++;
+        if (p >= eol || !is_digit(*p)) break;
+
+        unsigned long long value = 0;
+        while (p < eol && is_digit(*p)) {
+            value = value * 10 + (unsigned int)(*p++ - '0');
+        }
+        out[n++] = value;
+    }
+
+    *parsed = n;
+    return p;
+}
+
+// Copy [start, end) trimmed of surrounding spaces
+static void copy_trimmed(char *dst, size_t size, const char *start, const char *end) {
+    while (start < end && (*start == ' ' || *start == '\t')) start++;
+    while (end > start && (end[-1] == ' ' || end[-1] == '\t')) end--;
+
+    size_t len = end - start;
+    if (len >= size) len = size - 1;
+    memcpy(dst, start, len);
+    dst[len] = '\0';
+}
+
+static bool reserve_lines(InterruptMatrix *matrix, int count) {
+    if (count <= matrix->lines_capacity) return true;
+
+    int capacity = matrix->lines_capacity ? matrix->lines_capacity * 2 : 64;
+    while (capacity < count) capacity *= 2;
+
+    InterruptLine *lines = realloc(matrix->lines, capacity * sizeof(InterruptLine));
+    if (!lines) return false;
+    matrix->lines = lines;
+
+    double *rates = realloc(matrix->line_rates, capacity * sizeof(double));
+    if (!rates) return false;
+    matrix->line_rates = rates;
+
+    matrix->lines_capacity = capacity;
+    return true;
+}
+
+static bool matrix_update(InterruptMatrix *matrix, const char *path, unsigned long long now_ns) {
+    ssize_t length = procfile_read(path, &matrix->text, &matrix->text_capacity);
+    if (length <= 0) {
+        matrix->valid = false;
+        return false;
+    }
+
+    const char *p = matrix->text;
+    const char *end = p + length;
+
+    // Header: one "CPUn" per online (or possible, for softirqs) CPU
+    const char *eol = memchr(p, '\n', end - p);
+    if (!eol) eol = end;
+    int num_cpus = 0;
+    for (const char *q = p; q + 3 <= eol; q++) {
+        if (q[0] == 'C' && q[1] == 'P' && q[2] == 'U') num_cpus++;
+    }
+    if (num_cpus == 0) {
+        matrix->valid = false;
+        return false;
+    }
+
+    // CPU hotplug changes every column; start the rates over
+    CounterBank *bank = &matrix->counters;
+    if (num_cpus != matrix->num_cpus) {
+        counter_bank_free(bank);
+        if (counter_bank_init(bank, 0) != 0) return false;
+        matrix->num_cpus = num_cpus;
+        matrix->num_lines = 0;
+    }
+
+    counter_bank_begin(bank);
+
+    int line = 0;
+    for (p = eol + 1; p < end; p = eol + 1) {
+        eol = memchr(p, '\n', end - p);
+        if (!eol) eol = end;
+
+        const char *colon = memchr(p, ':', eol - p);
+        if (!colon) continue;
+
+        if (!reserve_lines(matrix, line + 1) ||
+            counter_bank_reserve(bank, (line + 1) * num_cpus) != 0) {
+            break;
+        }
+
+        // A different IRQ in this row (device added or removed) starts fresh
+        char name[sizeof(((InterruptLine *)0)->name)];
+        copy_trimmed(name, sizeof(name), p, colon);
+        InterruptLine *entry = &matrix->lines[line];
+        bool fresh = line >= matrix->num_lines || strcmp(entry->name, name) != 0;
+        if (fresh) {
+            strcpy(entry->name, name);
+        }
+
+        int parsed;
+        unsigned long long *counts = &bank->current[line * num_cpus];
+        const char *rest = scan_counts(colon + 1, eol, num_cpus, counts, &parsed);
+        for (int cpu = parsed; cpu < num_cpus; cpu++) {
+            counts[cpu] = 0; // Summary rows such as ERR: carry a single count
+        }
+        if (fresh) {
+            memcpy(&bank->previous[line * num_cpus], counts, num_cpus * sizeof(unsigned long long));
+        }
+
+        // Numbered IRQs end with the handler names; the rest carry a label
+        if (is_digit(name[0])) {
+            const char *last = eol;
+            while (last > rest && last[-1] == ' ') last--;
+            const char *start = last;
+            while (start > rest && start[-1] != ' ') start--;
+            copy_trimmed(entry->device, sizeof(entry->device), start, last);
+        } else {
+            copy_trimmed(entry->device, sizeof(entry->device), rest, eol);
+        }
+
+        line++;
+    }
+
+    matrix->num_lines = line;
+    bank->count = line * num_cpus;
+    counter_bank_commit(bank, now_ns);
+
+    for (int i = 0; i < line; i++) {
+        double total = 0.0;
+        const double *rates = &bank->rates[i * num_cpus];
+        for (int cpu = 0; cpu < num_cpus; cpu++) {
+            total += rates[cpu];
+        }
+        matrix->line_rates[i] = total;
+    }
+
+    matrix->valid = true;
+    return true;
+}
+
+bool interrupts_update(InterruptStats *stats, const char *proc_root, unsigned long long now_ns) {
+    if (!stats || !proc_root) return false;
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/interrupts", proc_root);
+    bool ok = matrix_update(&stats->irqs, path, now_ns);
+
+    snprintf(path, sizeof(path), "%s/softirqs", proc_root);
+    ok = matrix_update(&stats->softirqs, path, now_ns) || ok;
+
+    return ok;
+}
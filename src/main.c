@@ -5,19 +5,77 @@
 #include <unistd.h>
 #include <signal.h>
 #include <string.h>
+#include <errno.h>
 #include <time.h>
 #include <ncurses.h>
 
 #include "ui.h"
 #include "sysmon.h"
+#include "panels.h"
+#include "selfstat.h"
+#include "alert.h"
+#include "sampler.h"
+#include "recorder.h"
+#include "query.h"
+#include "metrics.h"
+
+// Low-bandwidth defaults: about a tenth of a 115200 baud console per frame
+#define LOW_BANDWIDTH_FRAME_BYTES 1024
+#define LOW_BANDWIDTH_COALESCE_PERCENT 5.0
 
 // Application state
 typedef struct {
     bool running;
     bool need_refresh;
+    bool self_stats;              // Dump monitor overhead at exit
+    SelfProcessStats self_usage;  // Last overhead sample for the panel
+    unsigned long long interval_ns;  // Options applied once the monitor is initialized
+    unsigned long long window_ns; // --window
+    double anomaly_z;             // --anomaly-z
+    const char *baseline_file;    // --baseline, seasonal anomaly baseline
+    double adaptive_delta;        // --adaptive, 0 = fixed rate
+    bool io_uring;                // --io-uring process reads
+    bool low_bandwidth;           // --low-bandwidth and its limits
+    int frame_bytes;
+    double coalesce_percent;
+    const char *ring_file;        // --ring flight recorder
+    unsigned long long ring_size;
+    unsigned long long ring_sync_ns;
+    const char *dump_ring;        // --dump-ring: print a ring and exit
+    const char *export_format;    // --export: print one sample and exit
+    const char *proc_root;
+    const char *sys_root;
+    const char *rules_file;       // --rules, loaded after the monitor starts
+    const char *rules[32];        // -r/--rule expressions
+    int num_rules;
 } AppState;
 
-static AppState app_state = {true, true};
+static AppState app_state = { .running = true, .need_refresh = true, .interval_ns = 1000000000ULL,
+                               .window_ns = SYSMON_DEFAULT_WINDOW_NS, .anomaly_z = ANOMALY_DEFAULT_Z,
+                               .frame_bytes = LOW_BANDWIDTH_FRAME_BYTES,
+                               .coalesce_percent = LOW_BANDWIDTH_COALESCE_PERCENT,
+                               .ring_size = RECORDER_DEFAULT_SIZE, .ring_sync_ns = RECORDER_DEFAULT_SYNC_NS };
+
+// The monitor instance this front-end samples and draws
+static SystemMonitor monitor;
+
+// Flight recorder, open when --ring is given
+static Recorder recorder;
+
+// Rolling window spans cycled with 'w'
+static const unsigned long long window_presets[] = {
+    10000000000ULL, 60000000000ULL, 300000000000ULL,
+};
+
+#define NUM_WINDOW_PRESETS (sizeof(window_presets) / sizeof(window_presets[0]))
+
+// Next preset after the current span, wrapping to the shortest
+static unsigned long long next_window(unsigned long long current) {
+    for (size_t i = 0; i < NUM_WINDOW_PRESETS; i++) {
+        if (window_presets[i] > current) return window_presets[i];
+    }
+    return window_presets[0];
+}
 
 // Signal handlers
 void handle_sigint(int sig) {
@@ -31,183 +89,80 @@ void handle_sigwinch(int sig) {
     g_layout.layout_dirty = 1;
 }
 
-// Format CPU information for display
-void format_cpu_info(char* buffer, size_t buffer_size) {
-    CPUStats *cpu = &g_sysmon.cpu;
-
-    if (!cpu->valid) {
-        snprintf(buffer, buffer_size, "CPU information unavailable");
-        return;
+// Update all UI components with current system data
+void update_display(void) {
+    // Reused every frame; cells borrow strings from the monitor
+    static RenderTable table;
+    RenderList list;
+
+    // Firing rules highlight the component showing the offending metric
+    static const int alert_components[ALERT_SUBSYSTEM_COUNT] = {
+        [ALERT_SUBSYSTEM_CPU] = COMPONENT_CPU,
+        [ALERT_SUBSYSTEM_MEMORY] = COMPONENT_MEMORY,
+        [ALERT_SUBSYSTEM_DISK] = COMPONENT_DISK,
+        [ALERT_SUBSYSTEM_NETWORK] = COMPONENT_NETWORK,
+    };
+    for (int i = 0; i < ALERT_SUBSYSTEM_COUNT; i++) {
+        ui_set_component_alert(alert_components[i], alert_subsystem_firing((AlertSubsystem)i));
     }
 
-    snprintf(buffer, buffer_size,
-        "Usage: %.1f%%\n"
-        "User Time: %ld\n"
-        "System Time: %ld\n"
-        "Idle Time: %ld\n"
-        "Total Time: %ld",
-        cpu->usage_percent,
-        cpu->user_time,
-        cpu->system_time,
-        cpu->idle_time,
-        cpu->total_time);
-}
+    panels_build_cpu(&table, &monitor);
+    ui_render_table(COMPONENT_CPU, &table);
 
-// Format memory information for display
-void format_memory_info(char* buffer, size_t buffer_size) {
-    MemoryStats *mem = &g_sysmon.memory;
+    panels_build_memory(&table, &monitor);
+    ui_render_table(COMPONENT_MEMORY, &table);
 
-    if (!mem->valid) {
-        snprintf(buffer, buffer_size, "Memory information unavailable");
-        return;
-    }
+    panels_build_disk(&list, &monitor);
+    ui_render_list(COMPONENT_DISK, &list);
 
-    char total_str[32], used_str[32], free_str[32], avail_str[32];
-    char buffers_str[32], cached_str[32];
-
-    sysmon_format_bytes(mem->total_kb * 1024ULL, total_str, sizeof(total_str));
-    sysmon_format_bytes(mem->used_kb * 1024ULL, used_str, sizeof(used_str));
-    sysmon_format_bytes(mem->free_kb * 1024ULL, free_str, sizeof(free_str));
-    sysmon_format_bytes(mem->available_kb * 1024ULL, avail_str, sizeof(avail_str));
-    sysmon_format_bytes(mem->buffers_kb * 1024ULL, buffers_str, sizeof(buffers_str));
-    sysmon_format_bytes(mem->cached_kb * 1024ULL, cached_str, sizeof(cached_str));
-
-    snprintf(buffer, buffer_size,
-        "Usage: %.1f%%\n"
-        "Total: %s\n"
-        "Used: %s\n"
-        "Free: %s\n"
-        "Available: %s\n"
-        "Buffers: %s\n"
-        "Cached: %s",
-        mem->usage_percent,
-        total_str,
-        used_str,
-        free_str,
-        avail_str,
-        buffers_str,
-        cached_str);
-}
+    panels_build_network(&list, &monitor);
+    ui_render_list(COMPONENT_NETWORK, &list);
 
-// Format disk information for display
-void format_disk_info(char* buffer, size_t buffer_size) {
-    if (g_sysmon.disk_count == 0) {
-        snprintf(buffer, buffer_size, "No disk information available");
-        return;
+    if (ui_is_component_visible(COMPONENT_SYSTEM)) {
+        panels_build_kernel(&table, &monitor);
+        ui_render_table(COMPONENT_SYSTEM, &table);
     }
 
-    char temp_buffer[2048] = {0};
-    size_t offset = 0;
-
-    for (int i = 0; i < g_sysmon.disk_count && i < 4; i++) {
-        DiskStats *disk = &g_sysmon.disks[i];
-
-        if (!disk->valid) continue;
-
-        char total_str[32], used_str[32], avail_str[32];
-        sysmon_format_bytes(disk->total_kb * 1024ULL, total_str, sizeof(total_str));
-        sysmon_format_bytes(disk->used_kb * 1024ULL, used_str, sizeof(used_str));
-        sysmon_format_bytes(disk->available_kb * 1024ULL, avail_str, sizeof(avail_str));
-
-        int written = snprintf(temp_buffer + offset, sizeof(temp_buffer) - offset,
-            "%s: %.1f%%\n"
-            "  Mount: %s\n"
-            "  Total: %s\n"
-            "  Used: %s\n"
-            "  Free: %s\n",
-            disk->device,
-            disk->usage_percent,
-            disk->mount_point,
-            total_str,
-            used_str,
-            avail_str);
-
-        if (written > 0 && offset + written < sizeof(temp_buffer)) {
-            offset += written;
-        }
-
-        if (i < g_sysmon.disk_count - 1 && i < 3) {
-            int sep_written = snprintf(temp_buffer + offset, sizeof(temp_buffer) - offset, "\n");
-            if (sep_written > 0 && offset + sep_written < sizeof(temp_buffer)) {
-                offset += sep_written;
-            }
-        }
+    if (ui_is_component_visible(COMPONENT_PROCESS)) {
+        panels_build_process(&list, &monitor);
+        ui_render_list(COMPONENT_PROCESS, &list);
     }
 
-    strncpy(buffer, temp_buffer, buffer_size - 1);
-    buffer[buffer_size - 1] = '\0';
-}
-
-// Format network information for display
-void format_network_info(char* buffer, size_t buffer_size) {
-    if (g_sysmon.interface_count == 0) {
-        snprintf(buffer, buffer_size, "No network interfaces found");
-        return;
+    if (ui_is_component_visible(COMPONENT_NETSTACK)) {
+        panels_build_netstack(&table, &monitor);
+        ui_render_table(COMPONENT_NETSTACK, &table);
     }
 
-    char temp_buffer[2048] = {0};
-    size_t offset = 0;
-
-    for (int i = 0; i < g_sysmon.interface_count && i < 4; i++) {
-        NetworkStats *net = &g_sysmon.interfaces[i];
-
-        if (!net->valid) continue;
-
-        char rx_bytes_str[32], tx_bytes_str[32];
-        char rx_rate_str[32], tx_rate_str[32];
-
-        sysmon_format_bytes(net->rx_bytes, rx_bytes_str, sizeof(rx_bytes_str));
-        sysmon_format_bytes(net->tx_bytes, tx_bytes_str, sizeof(tx_bytes_str));
-        sysmon_format_rate(net->rx_rate_mbps, rx_rate_str, sizeof(rx_rate_str));
-        sysmon_format_rate(net->tx_rate_mbps, tx_rate_str, sizeof(tx_rate_str));
-
-        int written = snprintf(temp_buffer + offset, sizeof(temp_buffer) - offset,
-            "%s:\n"
-            "  RX: %s (%s)\n"
-            "  TX: %s (%s)\n"
-            "  Packets RX: %llu\n"
-            "  Packets TX: %llu",
-            net->interface_name,
-            rx_bytes_str, rx_rate_str,
-            tx_bytes_str, tx_rate_str,
-            net->rx_packets,
-            net->tx_packets);
+    if (ui_is_component_visible(COMPONENT_SOCKETS)) {
+        panels_build_sockets(&table, &monitor);
+        ui_render_table(COMPONENT_SOCKETS, &table);
+    }
 
-        if (written > 0 && offset + written < sizeof(temp_buffer)) {
-            offset += written;
-        }
+    if (ui_is_component_visible(COMPONENT_INTERRUPTS)) {
+        panels_build_interrupts(&list, &monitor);
+        ui_render_list(COMPONENT_INTERRUPTS, &list);
+    }
 
-        if (i < g_sysmon.interface_count - 1 && i < 3) {
-            int sep_written = snprintf(temp_buffer + offset, sizeof(temp_buffer) - offset, "\n\n");
-            if (sep_written > 0 && offset + sep_written < sizeof(temp_buffer)) {
-                offset += sep_written;
-            }
-        }
+    if (ui_is_component_visible(COMPONENT_NUMA)) {
+        panels_build_numa(&list, &monitor);
+        ui_render_list(COMPONENT_NUMA, &list);
     }
 
-    strncpy(buffer, temp_buffer, buffer_size - 1);
-    buffer[buffer_size - 1] = '\0';
+    if (ui_is_component_visible(COMPONENT_OVERHEAD)) {
+        panels_build_overhead(&table, &monitor, &app_state.self_usage, ui_output_rate());
+        ui_render_table(COMPONENT_OVERHEAD, &table);
+    }
 }
 
-// Update all UI components with current system data
-void update_display(void) {
-    char buffer[2048];
-
-    // Update CPU component
-    format_cpu_info(buffer, sizeof(buffer));
-    ui_update_component(COMPONENT_CPU, buffer);
-
-    // Update Memory component
-    format_memory_info(buffer, sizeof(buffer));
-    ui_update_component(COMPONENT_MEMORY, buffer);
+// Render and refresh, timing both stages
+void redraw_display(void) {
+    unsigned long long start = selfstat_now();
+    update_display();
+    unsigned long long end = selfstat_now();
+    selfstat_record(&monitor.selfstat, SELFSTAT_DISPLAY, end - start);
 
-    // Update Disk component
-    format_disk_info(buffer, sizeof(buffer));
-    ui_update_component(COMPONENT_DISK, buffer);
-
-    // Update Network component
-    format_network_info(buffer, sizeof(buffer));
-    ui_update_component(COMPONENT_NETWORK, buffer);
+    ui_refresh_all();
+    selfstat_record(&monitor.selfstat, SELFSTAT_REFRESH, selfstat_now() - end);
 }
 
 // Initialize all components
@@ -231,84 +186,533 @@ int initialize_components(void) {
         return -1;
     }
 
+    // Optional panels start hidden
+    if (ui_create_component("Monitor Overhead", COLOR_HEADER) != COMPONENT_OVERHEAD) {
+        return -1;
+    }
+    ui_set_component_visible(COMPONENT_OVERHEAD, false);
+
+    // Busiest processes first
+    if (ui_create_component("Processes", COLOR_HEADER) != COMPONENT_PROCESS) {
+        return -1;
+    }
+    ui_set_component_sort(COMPONENT_PROCESS, PROCESS_COLUMN_CPU, true);
+    ui_set_component_visible(COMPONENT_PROCESS, false);
+
+    if (ui_create_component("System Activity", COLOR_CPU) != COMPONENT_SYSTEM) {
+        return -1;
+    }
+    ui_set_component_visible(COMPONENT_SYSTEM, false);
+
+    // Hottest interrupt lines first
+    if (ui_create_component("Interrupts", COLOR_NETWORK) != COMPONENT_INTERRUPTS) {
+        return -1;
+    }
+    ui_set_component_sort(COMPONENT_INTERRUPTS, INTERRUPT_COLUMN_RATE, true);
+    ui_set_component_visible(COMPONENT_INTERRUPTS, false);
+
+    if (ui_create_component("Network Stack", COLOR_NETWORK) != COMPONENT_NETSTACK) {
+        return -1;
+    }
+    ui_set_component_visible(COMPONENT_NETSTACK, false);
+
+    if (ui_create_component("TCP Sockets", COLOR_NETWORK) != COMPONENT_SOCKETS) {
+        return -1;
+    }
+    ui_set_component_visible(COMPONENT_SOCKETS, false);
+
+    if (ui_create_component("NUMA Nodes", COLOR_MEMORY) != COMPONENT_NUMA) {
+        return -1;
+    }
+    ui_set_component_visible(COMPONENT_NUMA, false);
+
     return 0;
 }
 
-// Main application loop
+// Apply one key press; returns true when the current sample needs a redraw.
+// Panel toggles mark the layout dirty, which redraws anyway.
+static bool handle_key(int ch) {
+    if (ch == 'q' || ch == 'Q' || ch == 27) { // ESC key
+        app_state.running = false;
+    } else if (ch == 'o') {
+        bool show = !ui_is_component_visible(COMPONENT_OVERHEAD);
+        if (show) {
+            // Start the usage window now rather than at the last toggle
+            SelfProcessStats discard;
+            selfstat_sample_process(&monitor.selfstat, &discard);
+        }
+        ui_set_component_visible(COMPONENT_OVERHEAD, show);
+    } else if (ch == 'K') {
+        ui_set_component_visible(COMPONENT_SYSTEM, !ui_is_component_visible(COMPONENT_SYSTEM));
+    } else if (ch == 'p') {
+        bool show = !ui_is_component_visible(COMPONENT_PROCESS);
+        monitor.collect_processes = show;
+        if (show) {
+            // Fill the list now; CPU usage shows from the next sample
+            monitor.process_sample_ns = 0;
+            sysmon_update_processes(&monitor);
+        }
+        ui_set_component_visible(COMPONENT_PROCESS, show);
+    } else if (ch == 'i') {
+        bool show = !ui_is_component_visible(COMPONENT_INTERRUPTS);
+        monitor.collect_interrupts = show;
+        if (show) {
+            // Take the first sample now; rates show from the next one
+            sysmon_update_interrupts(&monitor);
+        }
+        ui_set_component_visible(COMPONENT_INTERRUPTS, show);
+    } else if (ch == 'n') {
+        bool show = !ui_is_component_visible(COMPONENT_NETSTACK);
+        monitor.collect_netstack = show;
+        if (show) {
+            sysmon_update_netstack(&monitor);
+        }
+        ui_set_component_visible(COMPONENT_NETSTACK, show);
+    } else if (ch == 't') {
+        bool show = !ui_is_component_visible(COMPONENT_SOCKETS);
+        monitor.collect_sockets = show;
+        if (show) {
+            sysmon_update_sockets(&monitor);
+        }
+        ui_set_component_visible(COMPONENT_SOCKETS, show);
+    } else if (ch == 'u') {
+        bool show = !ui_is_component_visible(COMPONENT_NUMA);
+        monitor.collect_numa = show;
+        if (show) {
+            // Memory shows at once; CPU usage and rates from the next sample
+            sysmon_update_numa(&monitor);
+        }
+        ui_set_component_visible(COMPONENT_NUMA, show);
+    } else if (ch == 'w') {
+        sysmon_set_window(&monitor, next_window(monitor.window_ns));
+        return true;
+    } else if (ui_handle_key(ch)) {
+        // Redraw from the current sample without collecting a new one
+        return true;
+    }
+    return false;
+}
+
+// Screen refreshes are capped at this rate; faster sampling still feeds the
+// windows, detectors and alert rules at every interval. Over slow links
+// samples are folded into one frame a second; keys still redraw at once.
+#define DISPLAY_MIN_INTERVAL_NS 50000000ULL
+#define LOW_BANDWIDTH_MIN_INTERVAL_NS 1000000000ULL
+
+// Main application loop: sleep in poll until a sample is due or a key
+// arrives, so keys are handled at once and samples stay on their deadlines
 void main_loop(void) {
-    time_t last_update = 0;
-    time_t current_time;
-    bool first_run = true;
+    Sampler sampler;
+    if (sampler_init(&sampler, app_state.interval_ns) != 0) {
+        return;
+    }
+
+    unsigned long long last_draw = 0;
+    unsigned long long min_draw_ns = app_state.low_bandwidth ? LOW_BANDWIDTH_MIN_INTERVAL_NS
+                                                             : DISPLAY_MIN_INTERVAL_NS;
+    bool redraw = true;
 
     while (app_state.running) {
-        current_time = time(NULL);
+        bool sample_due = sampler_wait(&sampler, STDIN_FILENO);
+
+        // Handle every key typed since the last pass
+        int ch;
+        bool typed = false;
+        while (app_state.running && (ch = getch()) != ERR) {
+            redraw |= handle_key(ch);
+            typed = true;
+        }
+        if (!app_state.running) break;
 
-        // Handle resize events
+        // Someone is looking: collectors that backed off sample again now
+        if (typed && sysmon_wake(&monitor)) {
+            sampler_trigger(&sampler);
+        }
+
+        // Handle resize events and panel toggles; windows are recreated, so
+        // redraw from the current sample
         if (app_state.need_refresh || g_layout.layout_dirty) {
             ui_handle_resize();
             app_state.need_refresh = false;
-            first_run = true; // Force redraw after resize
+            redraw = true;
         }
 
-        // Update data and display at specified intervals OR on first run
-        if (first_run || (current_time - last_update) >= (g_sysmon.update_interval_ms / 1000)) {
-            // Update system statistics
-            sysmon_update_all();
+        if (sample_due) {
+            selfstat_record(&monitor.selfstat, SELFSTAT_JITTER, (unsigned long long)sampler.jitter_ns);
 
-            // Update display content (this will refresh individual components)
-            update_display();
+            // Update system statistics, then check rules against the new sample
+            sysmon_update_all(&monitor);
+            alert_evaluate(monitor.sample_ns);
+            recorder_write(&recorder, &monitor);
 
-            // Refresh all windows
-            ui_refresh_all();
+            // Sleep through the intervals no collector is due in
+            if (monitor.adaptive) {
+                sampler_defer(&sampler, sysmon_next_due(&monitor));
+            }
 
-            last_update = current_time;
-            first_run = false;
-        }
+            // Own usage is only sampled while someone is looking at it
+            if (ui_is_component_visible(COMPONENT_OVERHEAD)) {
+                selfstat_sample_process(&monitor.selfstat, &app_state.self_usage);
+            }
 
-        // Check for user input without blocking
-        int ch = getch();
-        if (ch == 'q' || ch == 'Q' || ch == 27) { // ESC key
-            app_state.running = false;
-            break;
+            if (sampler.interval_ns >= min_draw_ns || monitor.sample_ns - last_draw >= min_draw_ns) {
+                redraw = true;
+            }
         }
 
-        // Short sleep to prevent excessive CPU usage
-        struct timespec sleep_time = {0, 100000000}; // 100ms
-        nanosleep(&sleep_time, NULL);
+        // Update display content and refresh all windows
+        if (redraw) {
+            redraw_display();
+            last_draw = selfstat_now();
+            redraw = false;
+        }
     }
+
+    sampler_free(&sampler);
 }
 
 // Print usage information
 void print_usage(const char* program_name) {
     printf("Usage: %s [options]\n", program_name);
+    printf("       %s query [options] <ring file>...  (see %s query --help)\n", program_name, program_name);
     printf("Options:\n");
     printf("  -h, --help     Show this help message\n");
-    printf("  -i <interval>  Update interval in seconds (default: 1)\n");
+    printf("  -i <interval>  Update interval: seconds, 0.5 or 100ms; 10ms to 60s (default: 1)\n");
+    printf("  --self-stats   Print monitor overhead statistics at exit\n");
+    printf("  --proc-root <dir>  Read procfs from <dir> (default: /proc)\n");
+    printf("  --sys-root <dir>   Read sysfs from <dir> (default: /sys)\n");
+    printf("  --rules <file>     Load alert rules from <file>, one per line\n");
+    printf("  -r, --rule <expr>  Add an alert rule, e.g. 'cpu.usage > 90 for 30s'\n");
+    printf("  --window <span>    Rolling window for min/avg/p95/max (default: 1m)\n");
+    printf("  --anomaly-z <z>    Flag values <z> deviations from normal (default: %.1f)\n", ANOMALY_DEFAULT_Z);
+    printf("  --baseline <file>  Learn a daily baseline for anomalies, kept in <file>\n");
+    printf("  --adaptive         Sample quiet collectors less often, down to every %dth interval\n", CADENCE_MAX_STRIDE);
+    printf("  --adaptive-delta <pct>  Change that restores the full rate (default: %.0f%%)\n",
+           SYSMON_DEFAULT_ADAPTIVE_DELTA);
+    printf("  --io-uring         Read per-process files in io_uring batches when the kernel allows\n");
+    printf("  --low-bandwidth    Limit terminal output for serial consoles and slow SSH\n");
+    printf("  --frame-bytes <n>  Output cap per frame in low-bandwidth mode (default: %d, 0 = none)\n",
+           LOW_BANDWIDTH_FRAME_BYTES);
+    printf("                     A soft cap: the focused panel is always drawn, costs come from each\n");
+    printf("                     panel's previous frame, and a panel held %d frames is drawn anyway\n",
+           UI_MAX_DEFERRED_FRAMES);
+    printf("  --coalesce <pct>   Redraw numbers after a change of <pct> (default: %.0f, 0 = always)\n",
+           LOW_BANDWIDTH_COALESCE_PERCENT);
+    printf("  --ring <file>      Record every sample into a crash-safe ring file\n");
+    printf("  --ring-size <size> Size of a new ring, e.g. 512k or 16M (default: 4M)\n");
+    printf("  --ring-sync <time> Flush the ring to disk this often (default: 10s, 0 = at exit)\n");
+    printf("  --dump-ring <file> Print the samples in a ring file, oldest first, and exit\n");
+    printf("  --export <format>  Print every metric once as json or prometheus and exit\n");
     printf("\nControls:\n");
     printf("  q, Q, ESC      Quit the application\n");
+    printf("  Tab, Shift-Tab Move focus between panels\n");
+    printf("  s / S          Cycle sort column / reverse order of the focused table\n");
+    printf("  Up/Down, j/k   Move the selection in the focused table\n");
+    printf("  PgUp/PgDn      Scroll the focused table by a page\n");
+    printf("  Home/End, g/G  Jump to the first / last row\n");
+    printf("  p              Toggle the process panel\n");
+    printf("  K              Toggle the kernel activity panel\n");
+    printf("  i              Toggle the interrupt heatmap panel\n");
+    printf("  n              Toggle the network stack panel\n");
+    printf("  t              Toggle the TCP socket panel\n");
+    printf("  u              Toggle the NUMA node panel\n");
+    printf("  o              Toggle the monitor overhead panel\n");
+    printf("  w              Cycle the rolling window: 10s, 1m, 5m\n");
     printf("\nSystem Monitor made by PI\n");
 }
 
+static void print_query_usage(const char* program_name) {
+    printf("Usage: %s query [options] <ring file>...\n", program_name);
+    printf("Aggregate recorded samples without replaying them.\n");
+    printf("Options:\n");
+    printf("  -c, --columns <list>  Metrics to aggregate (default: cpu.usage,mem.usage)\n");
+    printf("  -a, --agg <list>      min, max, avg and percentiles such as p99 (default: min,avg,max,p99)\n");
+    printf("  --from <time>         First sample: 2026-01-31, '2026-01-31 02:00', 02:00 (today),\n");
+    printf("                        -2h (before now) or @<unix seconds>\n");
+    printf("  --to <time>           End of the range, exclusive\n");
+    printf("  -b, --bucket <span>   One row per span, aligned to the local clock, e.g. 1h\n");
+    printf("  -w, --where <cond>    Only samples where e.g. cpu.usage>90 or kernel.blocked>=1; repeatable\n");
+    printf("  --csv                 Print CSV instead of a table\n");
+    printf("Recorded metrics:");
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        if (metric_table[i].flags & METRIC_RECORDED) printf(" %s", metric_table[i].name);
+    }
+    printf("\n");
+}
+
+// Parse the query command's arguments into spec and paths, like
+// parse_arguments: 1 for help, -1 on error
+static int parse_query_arguments(const char* program_name, int argc, char* argv[], QuerySpec* spec,
+                                 const char** paths, int* path_count) {
+    const char* columns = "cpu.usage,mem.usage";
+    const char* aggregates = "min,avg,max,p99";
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    unsigned long long now_ns = (unsigned long long)now.tv_sec * 1000000000ULL + now.tv_nsec;
+
+    for (int i = 1; i < argc; i++) {
+        const char* option = argv[i];
+        bool takes_value = strcmp(option, "-c") == 0 || strcmp(option, "--columns") == 0 ||
+                           strcmp(option, "-a") == 0 || strcmp(option, "--agg") == 0 ||
+                           strcmp(option, "--from") == 0 || strcmp(option, "--to") == 0 ||
+                           strcmp(option, "-b") == 0 || strcmp(option, "--bucket") == 0 ||
+                           strcmp(option, "-w") == 0 || strcmp(option, "--where") == 0;
+        if (takes_value && i + 1 >= argc) {
+            fprintf(stderr, "Error: %s option requires an argument.\n", option);
+            return -1;
+        }
+
+        if (strcmp(option, "-h") == 0 || strcmp(option, "--help") == 0) {
+            print_query_usage(program_name);
+            return 1;
+        } else if (strcmp(option, "--csv") == 0) {
+            spec->csv = true;
+        } else if (strcmp(option, "-c") == 0 || strcmp(option, "--columns") == 0) {
+            columns = argv[++i];
+        } else if (strcmp(option, "-a") == 0 || strcmp(option, "--agg") == 0) {
+            aggregates = argv[++i];
+        } else if (strcmp(option, "--from") == 0 || strcmp(option, "--to") == 0) {
+            if (!query_parse_time(argv[++i], now_ns, option[2] == 'f' ? &spec->from_ns : &spec->to_ns)) {
+                fprintf(stderr, "Error: Invalid time '%s'. Use e.g. '2026-01-31 02:00', 02:00 or -2h.\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(option, "-b") == 0 || strcmp(option, "--bucket") == 0) {
+            if (!sysmon_parse_duration(argv[++i], &spec->bucket_ns) || spec->bucket_ns == 0) {
+                fprintf(stderr, "Error: Invalid bucket '%s'. Use e.g. 5m, 1h or 24h.\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(option, "-w") == 0 || strcmp(option, "--where") == 0) {
+            if (!query_parse_condition(spec, argv[++i])) {
+                fprintf(stderr, "Error: Invalid condition '%s'. Use e.g. cpu.usage>90, at most %d.\n", argv[i],
+                        QUERY_MAX_CONDITIONS);
+                return -1;
+            }
+        } else if (option[0] == '-') {
+            fprintf(stderr, "Error: Unknown query option '%s'. Use --help for usage information.\n", option);
+            return -1;
+        } else {
+            paths[(*path_count)++] = option;
+        }
+    }
+
+    if (!query_parse_columns(spec, columns)) {
+        fprintf(stderr, "Error: Invalid column list '%s'. See --help for the recorded metrics.\n", columns);
+        return -1;
+    }
+    if (!query_parse_aggregates(spec, aggregates)) {
+        fprintf(stderr, "Error: Invalid aggregate list '%s'. Use min, max, avg or pNN.\n", aggregates);
+        return -1;
+    }
+    if (*path_count == 0) {
+        fprintf(stderr, "Error: No ring files given. Use --help for usage information.\n");
+        return -1;
+    }
+    if (spec->from_ns && spec->to_ns && spec->from_ns >= spec->to_ns) {
+        fprintf(stderr, "Error: --from must be before --to.\n");
+        return -1;
+    }
+    return 0;
+}
+
+// pisysmon query: aggregate recordings and exit
+static int query_command(const char* program_name, int argc, char* argv[]) {
+    QuerySpec spec;
+    memset(&spec, 0, sizeof(spec));
+    const char** paths = calloc((size_t)argc, sizeof(*paths));
+    int path_count = 0;
+    if (!paths) return 1;
+
+    int arg_result = parse_query_arguments(program_name, argc, argv, &spec, paths, &path_count);
+    if (arg_result != 0) {
+        free(paths);
+        return (arg_result > 0) ? 0 : 1;
+    }
+
+    QueryStats stats;
+    int result = query_run(&spec, paths, path_count, stdout, &stats);
+    if (result != 0) {
+        if (stats.failed_path) {
+            fprintf(stderr, "Error: Cannot read ring file '%s': %s\n", stats.failed_path,
+                    errno == EINVAL ? "not a ring file" : strerror(errno));
+        } else if (errno == E2BIG) {
+            fprintf(stderr, "Error: More than %d buckets; use a longer --bucket.\n", QUERY_MAX_BUCKETS);
+        } else {
+            fprintf(stderr, "Error: Query failed: %s\n", strerror(errno));
+        }
+    } else if (!spec.csv) {
+        printf("# %d file%s: %llu of %llu blocks read, %llu samples scanned, %llu matched in %.1f ms\n",
+               stats.files, stats.files == 1 ? "" : "s", stats.blocks_read, stats.blocks, stats.samples,
+               stats.matched, stats.elapsed_ns / 1e6);
+    }
+
+    free(paths);
+    return result == 0 ? 0 : 1;
+}
+
 // Parse command line arguments
 int parse_arguments(int argc, char* argv[]) {
     for (int i = 1; i < argc; i++) {
         if (strcmp(argv[i], "-h") == 0 || strcmp(argv[i], "--help") == 0) {
             print_usage(argv[0]);
             return 1;
-        } else if (strcmp(argv[i], "-i") == 0) {
+        } else if (strcmp(argv[i], "--self-stats") == 0) {
+            app_state.self_stats = true;
+        } else if (strcmp(argv[i], "--proc-root") == 0) {
+            if (i + 1 < argc) {
+                app_state.proc_root = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --proc-root option requires an argument.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--sys-root") == 0) {
+            if (i + 1 < argc) {
+                app_state.sys_root = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --sys-root option requires an argument.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--rules") == 0) {
+            if (i + 1 < argc) {
+                app_state.rules_file = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --rules option requires an argument.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-r") == 0 || strcmp(argv[i], "--rule") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: %s option requires an argument.\n", argv[i]);
+                return -1;
+            }
+            if (app_state.num_rules >= (int)(sizeof(app_state.rules) / sizeof(app_state.rules[0]))) {
+                fprintf(stderr, "Error: Too many --rule options; use --rules <file>.\n");
+                return -1;
+            }
+            app_state.rules[app_state.num_rules++] = argv[++i];
+        } else if (strcmp(argv[i], "--window") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --window option requires an argument.\n");
+                return -1;
+            }
+            if (!sysmon_parse_duration(argv[++i], &app_state.window_ns) || app_state.window_ns < 1000000000ULL) {
+                fprintf(stderr, "Error: Invalid window '%s'. Use e.g. 10s, 1m or 5m.\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--anomaly-z") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --anomaly-z option requires an argument.\n");
+                return -1;
+            }
+            app_state.anomaly_z = atof(argv[++i]);
+            if (app_state.anomaly_z < 1.0 || app_state.anomaly_z > 20.0) {
+                fprintf(stderr, "Error: Invalid anomaly threshold '%s'. Must be between 1 and 20.\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--baseline") == 0) {
+            if (i + 1 < argc) {
+                app_state.baseline_file = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --baseline option requires an argument.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--io-uring") == 0) {
+            app_state.io_uring = true;
+        } else if (strcmp(argv[i], "--adaptive") == 0) {
+            if (app_state.adaptive_delta == 0.0) {
+                app_state.adaptive_delta = SYSMON_DEFAULT_ADAPTIVE_DELTA;
+            }
+        } else if (strcmp(argv[i], "--adaptive-delta") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --adaptive-delta option requires an argument.\n");
+                return -1;
+            }
+            // Implies --adaptive
+            app_state.adaptive_delta = atof(argv[++i]);
+            if (app_state.adaptive_delta <= 0.0 || app_state.adaptive_delta > 100.0) {
+                fprintf(stderr, "Error: Invalid adaptive delta '%s'. Must be above 0 and at most 100.\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--low-bandwidth") == 0) {
+            app_state.low_bandwidth = true;
+        } else if (strcmp(argv[i], "--frame-bytes") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --frame-bytes option requires an argument.\n");
+                return -1;
+            }
+            // Implies --low-bandwidth
+            app_state.frame_bytes = atoi(argv[++i]);
+            app_state.low_bandwidth = true;
+            if (app_state.frame_bytes < 0) {
+                fprintf(stderr, "Error: Invalid frame size '%s'.\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--coalesce") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --coalesce option requires an argument.\n");
+                return -1;
+            }
+            // Implies --low-bandwidth
+            app_state.coalesce_percent = atof(argv[++i]);
+            app_state.low_bandwidth = true;
+            if (app_state.coalesce_percent < 0.0 || app_state.coalesce_percent > 100.0) {
+                fprintf(stderr, "Error: Invalid coalescing threshold '%s'. Must be between 0 and 100.\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--ring") == 0) {
             if (i + 1 < argc) {
-                int interval = atoi(argv[i + 1]);
-                if (interval > 0 && interval <= 60) {
-                    g_sysmon.update_interval_ms = interval * 1000;
-                    i++; // Skip the next argument
-                } else {
-                    fprintf(stderr, "Error: Invalid interval. Must be between 1 and 60 seconds.\n");
-                    return -1;
-                }
+                app_state.ring_file = argv[++i];
             } else {
+                fprintf(stderr, "Error: --ring option requires an argument.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--ring-size") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --ring-size option requires an argument.\n");
+                return -1;
+            }
+            if (!sysmon_parse_size(argv[++i], &app_state.ring_size) ||
+                app_state.ring_size < RECORDER_HEADER_SIZE + RECORDER_MIN_SLOTS * RECORDER_SLOT_SIZE) {
+                fprintf(stderr, "Error: Invalid ring size '%s'. Use e.g. 512k or 16M, at least %dk.\n", argv[i],
+                        (RECORDER_HEADER_SIZE + RECORDER_MIN_SLOTS * RECORDER_SLOT_SIZE) / 1024);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--ring-sync") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --ring-sync option requires an argument.\n");
+                return -1;
+            }
+            if (!sysmon_parse_duration(argv[++i], &app_state.ring_sync_ns)) {
+                fprintf(stderr, "Error: Invalid ring sync interval '%s'. Use e.g. 1s, 30s or 0.\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--dump-ring") == 0) {
+            if (i + 1 < argc) {
+                app_state.dump_ring = argv[++i];
+            } else {
+                fprintf(stderr, "Error: --dump-ring option requires an argument.\n");
+                return -1;
+            }
+        } else if (strcmp(argv[i], "--export") == 0) {
+            if (i + 1 >= argc) {
+                fprintf(stderr, "Error: --export option requires an argument.\n");
+                return -1;
+            }
+            app_state.export_format = argv[++i];
+            if (strcmp(app_state.export_format, "json") != 0 && strcmp(app_state.export_format, "prometheus") != 0) {
+                fprintf(stderr, "Error: Invalid export format '%s'. Use json or prometheus.\n", argv[i]);
+                return -1;
+            }
+        } else if (strcmp(argv[i], "-i") == 0) {
+            if (i + 1 >= argc) {
                 fprintf(stderr, "Error: -i option requires an argument.\n");
                 return -1;
             }
+            // Seconds, fractional seconds or a suffixed duration
+            if (!sysmon_parse_duration(argv[++i], &app_state.interval_ns) ||
+                app_state.interval_ns < SAMPLER_MIN_INTERVAL_NS || app_state.interval_ns > SAMPLER_MAX_INTERVAL_NS) {
+                fprintf(stderr, "Error: Invalid interval '%s'. Must be between 10ms and 60s.\n", argv[i]);
+                return -1;
+            }
         } else {
             fprintf(stderr, "Error: Unknown option '%s'\n", argv[i]);
             print_usage(argv[0]);
@@ -318,35 +722,119 @@ int parse_arguments(int argc, char* argv[]) {
     return 0;
 }
 
+// Release everything main sets up, on success and failure alike. The
+// recorder and the rule set are static, so closing or clearing them is a
+// no-op when they were never opened or loaded.
+static void cleanup_application(bool ui_started) {
+    if (ui_started) {
+        ui_cleanup();
+    }
+    recorder_close(&recorder);
+    alert_clear_rules();
+    sysmon_cleanup(&monitor);
+}
+
 int main(int argc, char* argv[]) {
+    // Offline queries over recordings are a command of their own
+    if (argc > 1 && strcmp(argv[1], "query") == 0) {
+        return query_command(argv[0], argc - 1, argv + 1);
+    }
+
     // Parse command line arguments
     int arg_result = parse_arguments(argc, argv);
     if (arg_result != 0) {
         return (arg_result > 0) ? 0 : 1; // 0 for help, 1 for error
     }
 
+    // Reading a ring back needs neither the monitor nor a terminal
+    if (app_state.dump_ring) {
+        if (recorder_dump(app_state.dump_ring, stdout) != 0) {
+            fprintf(stderr, "Error: Cannot read ring file '%s': %s\n", app_state.dump_ring, strerror(errno));
+            return 1;
+        }
+        return 0;
+    }
+
     // Set up signal handlers
     signal(SIGINT, handle_sigint);
     signal(SIGTERM, handle_sigint);
     signal(SIGWINCH, handle_sigwinch);
 
     // Initialize system monitor
-    if (sysmon_init() != 0) {
+    if (sysmon_init(&monitor) != 0) {
         fprintf(stderr, "Error: Failed to initialize system monitor\n");
         return 1;
     }
+    monitor.update_interval_ns = app_state.interval_ns;
+    sysmon_set_roots(&monitor, app_state.proc_root, app_state.sys_root);
+    sysmon_set_adaptive(&monitor, app_state.adaptive_delta);
+    if (app_state.io_uring && !sysmon_set_io_uring(&monitor, true)) {
+        fprintf(stderr, "Warning: io_uring is not available, reading process files synchronously\n");
+    }
+    if (sysmon_set_window(&monitor, app_state.window_ns) != 0 ||
+        sysmon_set_anomaly(&monitor, app_state.anomaly_z, app_state.baseline_file != NULL) != 0) {
+        fprintf(stderr, "Error: Failed to allocate rolling windows and detectors\n");
+        sysmon_cleanup(&monitor);
+        return 1;
+    }
+
+    // A one-shot export samples twice, one interval apart, so rates are filled in
+    if (app_state.export_format) {
+        struct timespec pause = { (time_t)(app_state.interval_ns / 1000000000ULL),
+                                  (long)(app_state.interval_ns % 1000000000ULL) };
+        sysmon_update_all(&monitor);
+        nanosleep(&pause, NULL);
+        sysmon_update_all(&monitor);
+        int written = strcmp(app_state.export_format, "json") == 0 ? metrics_write_json(&monitor, stdout)
+                                                                     : metrics_write_prometheus(&monitor, stdout);
+        sysmon_cleanup(&monitor);
+        return written == 0 ? 0 : 1;
+    }
+
+    // Compile alert rules before the terminal is taken over, so errors show
+    char rule_error[512];
+    if (app_state.rules_file && alert_load_file(&monitor, app_state.rules_file, rule_error, sizeof(rule_error)) != 0) {
+        fprintf(stderr, "Error: %s\n", rule_error);
+        cleanup_application(false);
+        return 1;
+    }
+    for (int i = 0; i < app_state.num_rules; i++) {
+        if (alert_add_rule(&monitor, app_state.rules[i], rule_error, sizeof(rule_error)) != 0) {
+            fprintf(stderr, "Error: rule '%s': %s\n", app_state.rules[i], rule_error);
+            cleanup_application(false);
+            return 1;
+        }
+    }
+
+    // Open the flight recorder while errors can still be printed
+    if (app_state.ring_file && recorder_open(&recorder, app_state.ring_file, app_state.ring_size,
+                                             app_state.interval_ns, app_state.ring_sync_ns) != 0) {
+        if (errno == EEXIST) {
+            fprintf(stderr, "Error: '%s' exists and is not a ring file\n", app_state.ring_file);
+        } else {
+            fprintf(stderr, "Error: Cannot open ring file '%s': %s\n", app_state.ring_file, strerror(errno));
+        }
+        cleanup_application(false);
+        return 1;
+    }
+    if (app_state.ring_file && recorder.missing > 0) {
+        fprintf(stderr, "Warning: Ring file '%s' was created by another version; %d metric%s not recorded\n",
+                app_state.ring_file, recorder.missing, recorder.missing == 1 ? " is" : "s are");
+    }
 
     // Initialize UI
     if (ui_init() != 0) {
         fprintf(stderr, "Error: Failed to initialize user interface\n");
-        sysmon_cleanup();
+        cleanup_application(false);
         return 1;
     }
+    if (app_state.low_bandwidth) {
+        ui_set_low_bandwidth(app_state.frame_bytes, app_state.coalesce_percent);
+    }
 
     // Check terminal size
     if (g_layout.terminal_width < 80 || g_layout.terminal_height < 24) {
-        ui_cleanup();
-        sysmon_cleanup();
+        cleanup_application(true);
         fprintf(stderr, "Error: Terminal too small. Minimum size is 80x24, got %dx%d\n",
                 g_layout.terminal_width, g_layout.terminal_height);
         return 1;
@@ -354,9 +842,8 @@ int main(int argc, char* argv[]) {
 
     // Initialize components
     if (initialize_components() != 0) {
+        cleanup_application(true);
         fprintf(stderr, "Error: Failed to initialize UI components\n");
-        ui_cleanup();
-        sysmon_cleanup();
         return 1;
     }
 
@@ -365,24 +852,37 @@ int main(int argc, char* argv[]) {
 
     // Verify that windows were created successfully
     for (int i = 0; i < g_layout.num_components; i++) {
-        if (g_layout.components[i].window == NULL) {
+        if (g_layout.components[i].visible && g_layout.components[i].window == NULL) {
+            cleanup_application(true);
             fprintf(stderr, "Error: Failed to create window for component %d\n", i);
-            ui_cleanup();
-            sysmon_cleanup();
             return 1;
         }
     }
 
-    // Initial data collection
-    sysmon_update_all();
+    // Initial data collection; the baseline seeds the series it created.
+    // A missing file is a first run.
+    sysmon_update_all(&monitor);
+    if (app_state.baseline_file) {
+        sysmon_load_baseline(&monitor, app_state.baseline_file);
+    }
+    recorder_write(&recorder, &monitor);
 
     // Run main application loop
     main_loop();
 
+    // Keep what was learned for the next run
+    bool baseline_saved = !app_state.baseline_file || sysmon_save_baseline(&monitor, app_state.baseline_file) == 0;
+
     // Cleanup
-    ui_cleanup();
-    sysmon_cleanup();
+    cleanup_application(true);
+    if (!baseline_saved) {
+        fprintf(stderr, "Warning: Failed to save baseline to %s\n", app_state.baseline_file);
+    }
 
     printf("Pi System Monitor terminated.\n");
+
+    if (app_state.self_stats) {
+        selfstat_dump(&monitor.selfstat, stdout);
+    }
     return 0;
 }
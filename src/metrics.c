@@ -0,0 +1,317 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "metrics.h"
+#include <string.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+
+const MetricDesc metric_table[METRIC_COUNT] = {
+#define METRIC_DESC(id, group, field, label, kind, type, unit, source, locator, window, anomaly, flags, help) \
+    [METRIC_##id] = { METRIC_PREFIX_##group "." field, field, label, help, METRIC_GROUP_##group, METRIC_##kind, \
+                      METRIC_##type, METRIC_##unit, METRIC_SOURCE_##source, locator, window, \
+                      METRIC_ANOMALY_##anomaly, flags },
+    SYSMON_METRICS(METRIC_DESC)
+#undef METRIC_DESC
+};
+
+const char *metric_group_prefixes[METRIC_GROUP_COUNT] = {
+    [METRIC_GROUP_CPU]     = METRIC_PREFIX_CPU,
+    [METRIC_GROUP_MEMORY]  = METRIC_PREFIX_MEMORY,
+    [METRIC_GROUP_KERNEL]  = METRIC_PREFIX_KERNEL,
+    [METRIC_GROUP_DISK]    = METRIC_PREFIX_DISK,
+    [METRIC_GROUP_NETWORK] = METRIC_PREFIX_NETWORK,
+};
+
+const MetricDesc* metric_find(const char *name) {
+    if (!name) return NULL;
+
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        if (strcmp(metric_table[i].name, name) == 0) return &metric_table[i];
+    }
+    return NULL;
+}
+
+bool metric_keyed(const MetricDesc *metric) {
+    return metric->source == METRIC_SOURCE_ENTRY;
+}
+
+const StatTable* metric_table_of(const SystemMonitor *mon, const MetricDesc *metric) {
+    switch (metric->group) {
+        case METRIC_GROUP_DISK:    return &mon->disks;
+        case METRIC_GROUP_NETWORK: return &mon->interfaces;
+        default:                   return NULL;
+    }
+}
+
+const char* metric_label_name(const MetricDesc *metric) {
+    switch (metric->group) {
+        case METRIC_GROUP_DISK:    return "mount";
+        case METRIC_GROUP_NETWORK: return "interface";
+        default:                   return NULL;
+    }
+}
+
+const char* metric_entry_key(const MetricDesc *metric, const void *entry) {
+    switch (metric->group) {
+        case METRIC_GROUP_DISK:    return ((const DiskStats *)entry)->mount_point;
+        case METRIC_GROUP_NETWORK: return ((const NetworkStats *)entry)->interface_name;
+        default:                   return NULL;
+    }
+}
+
+const void* metric_field(const SystemMonitor *mon, const MetricDesc *metric) {
+    switch (metric->source) {
+        case METRIC_SOURCE_MONITOR:     return (const unsigned char *)mon + metric->locator;
+        case METRIC_SOURCE_KERNEL_RATE: return &mon->kernel.counters.rates[metric->locator];
+        case METRIC_SOURCE_ENTRY:       return NULL;
+    }
+    return NULL;
+}
+
+bool metric_available(const SystemMonitor *mon, const MetricDesc *metric) {
+    switch (metric->group) {
+        case METRIC_GROUP_CPU:    return mon->cpu.valid;
+        case METRIC_GROUP_MEMORY: return mon->memory.valid;
+        case METRIC_GROUP_KERNEL:
+            if (!mon->kernel.valid || ((metric->flags & METRIC_VMSTAT) && !mon->kernel.has_vmstat)) return false;
+            return metric->source != METRIC_SOURCE_KERNEL_RATE || counter_bank_has_rates(&mon->kernel.counters);
+        default:
+            return true;
+    }
+}
+
+static double read_field(const void *field, MetricType type) {
+    switch (type) {
+        case METRIC_FLOAT:  return *(const float *)field;
+        case METRIC_DOUBLE: return *(const double *)field;
+        case METRIC_LONG:   return (double)*(const long *)field;
+        case METRIC_ULL:    return (double)*(const unsigned long long *)field;
+    }
+    return 0.0;
+}
+
+double metric_value(const SystemMonitor *mon, const MetricDesc *metric, const void *entry) {
+    const void *field = metric_keyed(metric) ? (const unsigned char *)entry + metric->locator
+                                             : metric_field(mon, metric);
+    return field ? read_field(field, metric->type) : 0.0;
+}
+
+double metric_total(const SystemMonitor *mon, const MetricDesc *metric, const void *entry) {
+    if (metric->source == METRIC_SOURCE_KERNEL_RATE) {
+        return (double)mon->kernel.counters.current[metric->locator];
+    }
+    return metric_value(mon, metric, entry);
+}
+
+bool metric_has_anomaly(const MetricDesc *metric) {
+    return metric->anomaly != METRIC_ANOMALY_NONE;
+}
+
+bool metric_anomalous(const SystemMonitor *mon, const MetricDesc *metric, int row) {
+    AnomalyState state;
+    bool scored = false;
+    switch (metric->anomaly) {
+        case METRIC_ANOMALY_NONE:   return false;
+        case METRIC_ANOMALY_SYSTEM: scored = sysmon_anomaly(mon, (SystemWindow)metric->window, &state); break;
+        case METRIC_ANOMALY_DISK:   scored = sysmon_disk_anomaly(mon, row, &state); break;
+        case METRIC_ANOMALY_NET_RX: scored = sysmon_interface_anomaly(mon, row, false, &state); break;
+        case METRIC_ANOMALY_NET_TX: scored = sysmon_interface_anomaly(mon, row, true, &state); break;
+    }
+    return scored && state.anomalous;
+}
+
+bool metric_entry_anomalous(const SystemMonitor *mon, MetricGroup group, int row) {
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        const MetricDesc *metric = &metric_table[i];
+        if (metric->group != group || !metric_keyed(metric)) continue;
+        if (metric_anomalous(mon, metric, row)) return true;
+    }
+    return false;
+}
+
+static bool entry_valid(const MetricDesc *metric, const void *entry) {
+    if (!entry) return false;
+    return metric->group == METRIC_GROUP_DISK ? ((const DiskStats *)entry)->valid
+                                              : ((const NetworkStats *)entry)->valid;
+}
+
+// Integral values print exactly, others with six significant digits
+static void print_number(FILE *out, double value) {
+    if (value == floor(value) && fabs(value) < 1e15) {
+        fprintf(out, "%.0f", value);
+    } else {
+        fprintf(out, "%.6g", value);
+    }
+}
+
+// Quoted string with JSON escapes (Prometheus label values use a subset)
+static void print_quoted(FILE *out, const char *text, bool json) {
+    fputc('"', out);
+    for (const unsigned char *c = (const unsigned char *)text; *c; c++) {
+        if (*c == '"' || *c == '\\') {
+            fprintf(out, "\\%c", *c);
+        } else if (*c == '\n') {
+            fputs("\\n", out);
+        } else if (json && *c < 0x20) {
+            fprintf(out, "\\u%04x", *c);
+        } else {
+            fputc(*c, out);
+        }
+    }
+    fputc('"', out);
+}
+
+int metrics_write_json(const SystemMonitor *mon, FILE *out) {
+    if (!mon || !out) return -1;
+
+    struct timespec now;
+    clock_gettime(CLOCK_REALTIME, &now);
+    fprintf(out, "{\"time\": %lld.%03ld, \"metrics\": {", (long long)now.tv_sec, now.tv_nsec / 1000000L);
+
+    bool first = true;
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        const MetricDesc *metric = &metric_table[i];
+        if (!metric_available(mon, metric)) continue;
+
+        fprintf(out, "%s\n  \"%s\": ", first ? "" : ",", metric->name);
+        first = false;
+        if (!metric_keyed(metric)) {
+            print_number(out, metric_value(mon, metric, NULL));
+            continue;
+        }
+
+        // Per-device metrics map the device to its value
+        const StatTable *table = metric_table_of(mon, metric);
+        bool first_entry = true;
+        fputc('{', out);
+        for (int row = 0; row < stat_table_count(table); row++) {
+            const void *entry = stat_table_row(table, row);
+            if (!entry_valid(metric, entry)) continue;
+            fputs(first_entry ? "" : ", ", out);
+            print_quoted(out, metric_entry_key(metric, entry), true);
+            fputs(": ", out);
+            print_number(out, metric_value(mon, metric, entry));
+            first_entry = false;
+        }
+        fputc('}', out);
+    }
+
+    // Flagged series, named as in alert rules
+    fputs("\n}, \"anomalous\": [", out);
+    first = true;
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        const MetricDesc *metric = &metric_table[i];
+        if (!metric_has_anomaly(metric) || !metric_available(mon, metric)) continue;
+
+        if (!metric_keyed(metric)) {
+            if (!metric_anomalous(mon, metric, -1)) continue;
+            fprintf(out, "%s\"%s\"", first ? "" : ", ", metric->name);
+            first = false;
+            continue;
+        }
+        const StatTable *table = metric_table_of(mon, metric);
+        for (int row = 0; row < stat_table_count(table); row++) {
+            const void *entry = stat_table_row(table, row);
+            if (!entry_valid(metric, entry) || !metric_anomalous(mon, metric, row)) continue;
+
+            char series[192];
+            snprintf(series, sizeof(series), "%s.%s.%s", metric_group_prefixes[metric->group],
+                     metric_entry_key(metric, entry), metric->field);
+            fputs(first ? "" : ", ", out);
+            print_quoted(out, series, true);
+            first = false;
+        }
+    }
+    fputs("]}\n", out);
+    return ferror(out) ? -1 : 0;
+}
+
+// Prometheus base unit of a metric and the factor into it
+static const char* prometheus_unit(const MetricDesc *metric, double *scale) {
+    *scale = 1.0;
+    switch (metric->unit) {
+        case METRIC_PERCENT:    return "percent";
+        case METRIC_KB:         *scale = 1024.0; return "bytes";
+        case METRIC_BYTES:      return "bytes";
+        case METRIC_MBPS:       *scale = 131072.0; return "bytes_per_second";
+        case METRIC_TICKS:      *scale = 1.0 / (double)sysconf(_SC_CLK_TCK); return "seconds";
+        case METRIC_PER_SECOND:
+        case METRIC_NUMBER:     return NULL;
+    }
+    return NULL;
+}
+
+// pisysmon_<group>_<field>[_<unit>][_total]; a counter exports its total
+static void prometheus_name(const MetricDesc *metric, char *buffer, size_t buffer_size, double *scale) {
+    const char *unit = prometheus_unit(metric, scale);
+    size_t field_len = strlen(metric->field);
+    size_t unit_len = unit ? strlen(unit) : 0;
+    bool has_unit = unit && field_len >= unit_len && strcmp(metric->field + field_len - unit_len, unit) == 0;
+
+    snprintf(buffer, buffer_size, "pisysmon_%s_%s%s%s%s", metric_group_prefixes[metric->group], metric->field,
+             unit && !has_unit ? "_" : "", unit && !has_unit ? unit : "",
+             metric->kind == METRIC_COUNTER ? "_total" : "");
+}
+
+int metrics_write_prometheus(const SystemMonitor *mon, FILE *out) {
+    if (!mon || !out) return -1;
+
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        const MetricDesc *metric = &metric_table[i];
+        if (!metric_available(mon, metric)) continue;
+
+        char name[96];
+        double scale;
+        prometheus_name(metric, name, sizeof(name), &scale);
+        fprintf(out, "# HELP %s %s\n# TYPE %s %s\n", name, metric->help, name,
+                metric->kind == METRIC_COUNTER ? "counter" : "gauge");
+
+        if (!metric_keyed(metric)) {
+            fputs(name, out);
+            fputc(' ', out);
+            print_number(out, (metric->kind == METRIC_COUNTER ? metric_total(mon, metric, NULL)
+                                                              : metric_value(mon, metric, NULL)) * scale);
+            fputc('\n', out);
+            continue;
+        }
+
+        const StatTable *table = metric_table_of(mon, metric);
+        for (int row = 0; row < stat_table_count(table); row++) {
+            const void *entry = stat_table_row(table, row);
+            if (!entry_valid(metric, entry)) continue;
+            fprintf(out, "%s{%s=", name, metric_label_name(metric));
+            print_quoted(out, metric_entry_key(metric, entry), false);
+            fputs("} ", out);
+            print_number(out, metric_total(mon, metric, entry) * scale);
+            fputc('\n', out);
+        }
+    }
+
+    // One 0/1 series per detector, labelled by metric (and device)
+    bool header = false;
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        const MetricDesc *metric = &metric_table[i];
+        if (!metric_has_anomaly(metric) || !metric_available(mon, metric)) continue;
+
+        if (!header) {
+            fputs("# HELP pisysmon_anomalous Whether the metric's anomaly detector flagged the last sample\n"
+                  "# TYPE pisysmon_anomalous gauge\n", out);
+            header = true;
+        }
+        if (!metric_keyed(metric)) {
+            fprintf(out, "pisysmon_anomalous{metric=\"%s\"} %d\n", metric->name,
+                    metric_anomalous(mon, metric, -1) ? 1 : 0);
+            continue;
+        }
+        const StatTable *table = metric_table_of(mon, metric);
+        for (int row = 0; row < stat_table_count(table); row++) {
+            const void *entry = stat_table_row(table, row);
+            if (!entry_valid(metric, entry)) continue;
+            fprintf(out, "pisysmon_anomalous{metric=\"%s\",%s=", metric->name, metric_label_name(metric));
+            print_quoted(out, metric_entry_key(metric, entry), false);
+            fprintf(out, "} %d\n", metric_anomalous(mon, metric, row) ? 1 : 0);
+        }
+    }
+    return ferror(out) ? -1 : 0;
+}
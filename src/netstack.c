@@ -0,0 +1,313 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "netstack.h"
+#include "procfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char *counter_names[NETSTACK_COUNTER_COUNT] = {
+    [NETSTACK_SOFTNET_PROCESSED]     = "Packets processed",
+    [NETSTACK_SOFTNET_DROPPED]       = "Backlog drops",
+    [NETSTACK_SOFTNET_SQUEEZED]      = "Time squeezes",
+    [NETSTACK_IP_IN_RECEIVES]        = "IP in",
+    [NETSTACK_IP_OUT_REQUESTS]       = "IP out",
+    [NETSTACK_IP_IN_DISCARDS]        = "IP in discards",
+    [NETSTACK_TCP_IN_SEGS]           = "TCP segments in",
+    [NETSTACK_TCP_OUT_SEGS]          = "TCP segments out",
+    [NETSTACK_TCP_RETRANS_SEGS]      = "TCP retransmits",
+    [NETSTACK_TCP_IN_ERRS]           = "TCP bad segments",
+    [NETSTACK_TCP_OUT_RSTS]          = "TCP resets sent",
+    [NETSTACK_TCP_ACTIVE_OPENS]      = "TCP active opens",
+    [NETSTACK_TCP_PASSIVE_OPENS]     = "TCP passive opens",
+    [NETSTACK_TCP_ATTEMPT_FAILS]     = "TCP failed connects",
+    [NETSTACK_TCP_LISTEN_OVERFLOWS]  = "Listen overflows",
+    [NETSTACK_TCP_LISTEN_DROPS]      = "Listen drops",
+    [NETSTACK_TCP_BACKLOG_DROPS]     = "Socket backlog drops",
+    [NETSTACK_TCP_TIMEOUTS]          = "TCP timeouts",
+    [NETSTACK_UDP_IN_DATAGRAMS]      = "UDP in",
+    [NETSTACK_UDP_OUT_DATAGRAMS]     = "UDP out",
+    [NETSTACK_UDP_NO_PORTS]          = "UDP no port",
+    [NETSTACK_UDP_IN_ERRORS]         = "UDP in errors",
+    [NETSTACK_UDP_RCVBUF_ERRORS]     = "UDP rcvbuf errors",
+    [NETSTACK_UDP_SNDBUF_ERRORS]     = "UDP sndbuf errors",
+};
+
+// Columns picked out of the "Section: names" / "Section: values" line
+// pairs of /proc/net/snmp and /proc/net/netstat
+typedef struct {
+    const char *section;
+    const char *field;
+    NetstackCounter counter;
+} SnmpField;
+
+static const SnmpField snmp_fields[] = {
+    { "Ip",     "InReceives",      NETSTACK_IP_IN_RECEIVES },
+    { "Ip",     "OutRequests",     NETSTACK_IP_OUT_REQUESTS },
+    { "Ip",     "InDiscards",      NETSTACK_IP_IN_DISCARDS },
+    { "Tcp",    "InSegs",          NETSTACK_TCP_IN_SEGS },
+    { "Tcp",    "OutSegs",         NETSTACK_TCP_OUT_SEGS },
+    { "Tcp",    "RetransSegs",     NETSTACK_TCP_RETRANS_SEGS },
+    { "Tcp",    "InErrs",          NETSTACK_TCP_IN_ERRS },
+    { "Tcp",    "OutRsts",         NETSTACK_TCP_OUT_RSTS },
+    { "Tcp",    "ActiveOpens",     NETSTACK_TCP_ACTIVE_OPENS },
+    { "Tcp",    "PassiveOpens",    NETSTACK_TCP_PASSIVE_OPENS },
+    { "Tcp",    "AttemptFails",    NETSTACK_TCP_ATTEMPT_FAILS },
+    { "Udp",    "InDatagrams",     NETSTACK_UDP_IN_DATAGRAMS },
+    { "Udp",    "OutDatagrams",    NETSTACK_UDP_OUT_DATAGRAMS },
+    { "Udp",    "NoPorts",         NETSTACK_UDP_NO_PORTS },
+    { "Udp",    "InErrors",        NETSTACK_UDP_IN_ERRORS },
+    { "Udp",    "RcvbufErrors",    NETSTACK_UDP_RCVBUF_ERRORS },
+    { "Udp",    "SndbufErrors",    NETSTACK_UDP_SNDBUF_ERRORS },
+    { "TcpExt", "ListenOverflows", NETSTACK_TCP_LISTEN_OVERFLOWS },
+    { "TcpExt", "ListenDrops",     NETSTACK_TCP_LISTEN_DROPS },
+    { "TcpExt", "TCPBacklogDrop",  NETSTACK_TCP_BACKLOG_DROPS },
+    { "TcpExt", "TCPTimeouts",     NETSTACK_TCP_TIMEOUTS },
+};
+
+#define NUM_SNMP_FIELDS ((int)(sizeof(snmp_fields) / sizeof(snmp_fields[0])))
+
+int netstack_init(NetstackStats *stats) {
+    if (!stats) return -1;
+
+    memset(stats, 0, sizeof(NetstackStats));
+    if (counter_bank_init(&stats->counters, NETSTACK_COUNTER_COUNT) != 0 ||
+        counter_bank_init(&stats->softnet, 0) != 0) {
+        netstack_free(stats);
+        return -1;
+    }
+    return 0;
+}
+
+void netstack_free(NetstackStats *stats) {
+    if (!stats) return;
+
+    counter_bank_free(&stats->counters);
+    counter_bank_free(&stats->softnet);
+    free(stats->softnet_cpu_ids);
+    free(stats->text);
+    memset(stats, 0, sizeof(NetstackStats));
+}
+
+static ssize_t read_file(NetstackStats *stats, const char *proc_root, const char *relative) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%s", proc_root, relative);
+    return procfile_read(path, &stats->text, &stats->text_capacity);
+}
+
+// Zero-based softnet_stat column with the CPU id, on kernels that have it
+#define SOFTNET_CPU_COLUMN 12
+
+// One hexadecimal line per online CPU: processed, dropped, time_squeeze,
+// ... Kernels since 5.10 give the CPU id in column 13; older ones leave it
+// out, and rows are then numbered in order, which skips offline CPUs.
+static bool read_softnet(NetstackStats *stats, const char *proc_root, unsigned long long *totals) {
+    if (read_file(stats, proc_root, "net/softnet_stat") <= 0) return false;
+
+    int rows = 0;
+    for (const char *p = stats->text; *p; p++) {
+        if (*p == '\n') rows++;
+    }
+
+    // CPU hotplug shifts every row; start the per-CPU rates over
+    CounterBank *bank = &stats->softnet;
+    if (rows != stats->softnet_cpus) {
+        counter_bank_free(bank);
+        int *ids = realloc(stats->softnet_cpu_ids, (size_t)(rows > 0 ? rows : 1) * sizeof(int));
+        if (!ids) return false;
+        stats->softnet_cpu_ids = ids;
+        for (int row = 0; row < rows; row++) ids[row] = row;
+        if (counter_bank_init(bank, rows * SOFTNET_FIELD_COUNT) != 0) return false;
+        stats->softnet_cpus = rows;
+    }
+
+    counter_bank_begin(bank);
+
+    char *p = stats->text;
+    for (int row = 0; row < rows; row++) {
+        char *eol = strchr(p, '\n');
+        if (eol) *eol = '\0';
+
+        unsigned long long columns[SOFTNET_CPU_COLUMN + 1];
+        int count = 0;
+        while (count <= SOFTNET_CPU_COLUMN) {
+            char *end;
+            columns[count] = strtoull(p, &end, 16);
+            if (end == p) break;
+            p = end;
+            count++;
+        }
+
+        // A row now holding another CPU starts from its current values
+        int cpu = count > SOFTNET_CPU_COLUMN ? (int)columns[SOFTNET_CPU_COLUMN] : row;
+        bool moved = cpu != stats->softnet_cpu_ids[row];
+        stats->softnet_cpu_ids[row] = cpu;
+
+        for (int field = 0; field < SOFTNET_FIELD_COUNT; field++) {
+            unsigned long long value = field < count ? columns[field] : 0;
+            if (moved) {
+                counter_bank_set_fresh(bank, row * SOFTNET_FIELD_COUNT + field, value);
+            } else {
+                counter_bank_set(bank, row * SOFTNET_FIELD_COUNT + field, value);
+            }
+            totals[NETSTACK_SOFTNET_PROCESSED + field] += value;
+        }
+
+        if (!eol) break;
+        p = eol + 1;
+    }
+
+    return true;
+}
+
+// Split a "Section: a b c" line; returns the text after the colon
+static char* section_of(char *line, const char **section, size_t *length) {
+    char *colon = strchr(line, ':');
+    if (!colon) return NULL;
+
+    *section = line;
+    *length = colon - line;
+    return colon + 1;
+}
+
+static char* next_token(char **cursor) {
+    char *p = *cursor;
+    while (*p == ' ') p++;
+    if (*p == '\0') return NULL;
+
+    char *token = p;
+    while (*p && *p != ' ') p++;
+    if (*p) *p++ = '\0';
+    *cursor = p;
+    return token;
+}
+
+// Fields of one section are contiguous in snmp_fields; [first, last)
+static void section_range(const char *section, size_t length, int *first, int *last) {
+    int f = 0;
+    while (f < NUM_SNMP_FIELDS &&
+           (strncmp(snmp_fields[f].section, section, length) != 0 || snmp_fields[f].section[length] != '\0')) {
+        f++;
+    }
+
+    *first = f;
+    while (f < NUM_SNMP_FIELDS && strncmp(snmp_fields[f].section, section, length) == 0 &&
+           snmp_fields[f].section[length] == '\0') {
+        f++;
+    }
+    *last = f;
+}
+
+// Walk header/value line pairs, matching header names against snmp_fields
+static bool read_snmp(NetstackStats *stats, const char *proc_root, const char *relative,
+                      unsigned long long *totals) {
+    if (read_file(stats, proc_root, relative) <= 0) return false;
+
+    char *text = stats->text;
+    for (;;) {
+        char *header = text;
+        char *values = strchr(header, '\n');
+        if (!values) break;
+        *values++ = '\0';
+
+        char *end = strchr(values, '\n');
+        if (end) *end = '\0';
+
+        const char *section, *value_section;
+        size_t section_len, value_len;
+        char *names = section_of(header, &section, &section_len);
+        char *counts = section_of(values, &value_section, &value_len);
+
+        if (names && counts && section_len == value_len && strncmp(section, value_section, section_len) == 0) {
+            int first, last;
+            section_range(section, section_len, &first, &last);
+
+            const char *name;
+            while (first < last && (name = next_token(&names)) != NULL) {
+                const char *count = next_token(&counts);
+                if (!count) break;
+
+                for (int f = first; f < last; f++) {
+                    if (strcmp(snmp_fields[f].field, name) == 0) {
+                        totals[snmp_fields[f].counter] = strtoull(count, NULL, 10);
+                        break;
+                    }
+                }
+            }
+        }
+
+        if (!end) break;
+        text = end + 1;
+    }
+
+    return true;
+}
+
+static bool read_sockstat(NetstackStats *stats, const char *proc_root) {
+    if (read_file(stats, proc_root, "net/sockstat") <= 0) return false;
+
+    SocketSummary *s = &stats->sockets;
+    memset(s, 0, sizeof(SocketSummary));
+
+    for (char *line = stats->text; line && *line; ) {
+        char *eol = strchr(line, '\n');
+        if (eol) *eol = '\0';
+
+        if (sscanf(line, "sockets: used %ld", &s->sockets_used) == 1) {
+            // Matched
+        } else if (sscanf(line, "TCP: inuse %ld orphan %ld tw %ld alloc %ld mem %ld", &s->tcp_inuse,
+                          &s->tcp_orphan, &s->tcp_timewait, &s->tcp_alloc, &s->tcp_mem_pages) >= 1) {
+            // Matched
+        } else {
+            sscanf(line, "UDP: inuse %ld mem %ld", &s->udp_inuse, &s->udp_mem_pages);
+        }
+
+        line = eol ? eol + 1 : NULL;
+    }
+
+    return true;
+}
+
+bool netstack_update(NetstackStats *stats, const char *proc_root, unsigned long long now_ns) {
+    if (!stats || !proc_root) return false;
+
+    unsigned long long totals[NETSTACK_COUNTER_COUNT] = {0};
+
+    stats->has_softnet = read_softnet(stats, proc_root, totals);
+    if (stats->has_softnet) {
+        counter_bank_commit(&stats->softnet, now_ns);
+    }
+    stats->has_snmp = read_snmp(stats, proc_root, "net/snmp", totals);
+    stats->has_netstat = read_snmp(stats, proc_root, "net/netstat", totals);
+    stats->has_sockstat = read_sockstat(stats, proc_root);
+
+    CounterBank *bank = &stats->counters;
+    counter_bank_begin(bank);
+    for (int i = 0; i < NETSTACK_COUNTER_COUNT; i++) {
+        counter_bank_set(bank, i, totals[i]);
+    }
+    counter_bank_commit(bank, now_ns);
+
+    stats->valid = stats->has_softnet || stats->has_snmp || stats->has_netstat || stats->has_sockstat;
+    return stats->valid;
+}
+
+const char* netstack_counter_name(NetstackCounter counter) {
+    if ((int)counter < 0 || counter >= NETSTACK_COUNTER_COUNT) return "unknown";
+    return counter_names[counter];
+}
+
+int netstack_busiest_row(const NetstackStats *stats, SoftnetField field) {
+    if (!stats || !stats->has_softnet || !counter_bank_has_rates(&stats->softnet)) return -1;
+
+    int busiest = -1;
+    double best = 0.0;
+    for (int row = 0; row < stats->softnet_cpus; row++) {
+        double rate = counter_bank_rate(&stats->softnet, row * SOFTNET_FIELD_COUNT + field);
+        if (rate > best) {
+            best = rate;
+            busiest = row;
+        }
+    }
+    return busiest;
+}
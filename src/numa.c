@@ -0,0 +1,277 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "numa.h"
+#include "procfile.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Bounds a corrupt cpulist; well above the largest NUMA hosts
+#define NUMA_MAX_CPUS 8192
+
+static const char *counter_names[NUMASTAT_COUNTER_COUNT] = {
+    "numa_hit", "numa_miss", "numa_foreign", "interleave_hit", "local_node", "other_node"
+};
+
+// Key names in the same (strcmp) order as the enum, for binary search
+static const char *meminfo_names[MEMINFO_KEY_COUNT] = {
+#define MEMINFO_NAME(id, key) key,
+    MEMINFO_KEYS(MEMINFO_NAME)
+#undef MEMINFO_NAME
+};
+
+static int compare_meminfo_name(const void *key, const void *entry) {
+    return strcmp(key, *(const char *const *)entry);
+}
+
+static int compare_node_id(const void *a, const void *b) {
+    return ((const NumaNode *)a)->id - ((const NumaNode *)b)->id;
+}
+
+static void close_fd(int *fd) {
+    if (*fd >= 0) close(*fd);
+    *fd = -1;
+}
+
+static void close_topology(NumaStats *stats) {
+    for (int i = 0; i < stats->num_nodes; i++) {
+        close_fd(&stats->nodes[i].meminfo_fd);
+        close_fd(&stats->nodes[i].numastat_fd);
+    }
+
+    free(stats->nodes);
+    free(stats->node_cpus);
+    stats->nodes = NULL;
+    stats->node_cpus = NULL;
+    stats->num_nodes = 0;
+    stats->num_cpus = 0;
+    stats->discovered = false;
+}
+
+int numa_init(NumaStats *stats) {
+    if (!stats) return -1;
+
+    memset(stats, 0, sizeof(NumaStats));
+    return counter_bank_init(&stats->numastat, 0);
+}
+
+void numa_free(NumaStats *stats) {
+    if (!stats) return;
+
+    close_topology(stats);
+    free(stats->text);
+    counter_bank_free(&stats->numastat);
+    memset(stats, 0, sizeof(NumaStats));
+}
+
+const char* numa_counter_name(NumastatCounter counter) {
+    if ((int)counter < 0 || counter >= NUMASTAT_COUNTER_COUNT) return "unknown";
+    return counter_names[counter];
+}
+
+static int open_node_file(const char *sys_root, int id, const char *name) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/devices/system/node/node%d/%s", sys_root, id, name);
+    return open(path, O_RDONLY | O_CLOEXEC);
+}
+
+static bool add_cpu(NumaStats *stats, int *capacity, int cpu) {
+    if (stats->num_cpus == *capacity) {
+        int grown = *capacity ? *capacity * 2 : 64;
+        int *cpus = realloc(stats->node_cpus, grown * sizeof(int));
+        if (!cpus) return false;
+        stats->node_cpus = cpus;
+        *capacity = grown;
+    }
+    stats->node_cpus[stats->num_cpus++] = cpu;
+    return true;
+}
+
+// cpulist ranges such as "0-15,32-47"; read once per discovery
+static bool read_cpulist(NumaStats *stats, NumaNode *node, const char *sys_root, int *capacity) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/devices/system/node/node%d/cpulist", sys_root, node->id);
+
+    node->first_cpu = stats->num_cpus;
+    node->cpu_count = 0;
+    if (procfile_read(path, &stats->text, &stats->text_capacity) < 0) return true;  // Memory-only node
+
+    const char *p = stats->text;
+    while (*p >= '0' && *p <= '9') {
+        char *end;
+        long first = strtol(p, &end, 10);
+        long last = first;
+        if (*end == '-') last = strtol(end + 1, &end, 10);
+        if (first < 0 || last < first || last >= NUMA_MAX_CPUS) break;
+
+        for (long cpu = first; cpu <= last; cpu++) {
+            if (!add_cpu(stats, capacity, (int)cpu)) return false;
+        }
+        p = *end == ',' ? end + 1 : end;
+    }
+    node->cpu_count = stats->num_cpus - node->first_cpu;
+    return true;
+}
+
+// Node directories, their descriptors and CPUs. Rates start over, since
+// node and CPU indices may have moved.
+static bool discover(NumaStats *stats, const char *sys_root) {
+    close_topology(stats);
+
+    char path[512];
+    snprintf(path, sizeof(path), "%s/devices/system/node", sys_root);
+    DIR *dir = opendir(path);
+    if (!dir) return false;
+
+    int capacity = 0;
+    bool ok = true;
+    struct dirent *entry;
+    while (ok && (entry = readdir(dir)) != NULL) {
+        int id;
+        char extra;
+        if (sscanf(entry->d_name, "node%d%c", &id, &extra) != 1 || id < 0) continue;
+
+        if (stats->num_nodes == capacity) {
+            capacity = capacity ? capacity * 2 : 8;
+            NumaNode *nodes = realloc(stats->nodes, capacity * sizeof(NumaNode));
+            if (!nodes) {
+                ok = false;
+                break;
+            }
+            stats->nodes = nodes;
+        }
+
+        NumaNode *node = &stats->nodes[stats->num_nodes++];
+        memset(node, 0, sizeof(NumaNode));
+        node->id = id;
+        node->meminfo_fd = -1;
+        node->numastat_fd = -1;
+    }
+    closedir(dir);
+
+    if (!ok || stats->num_nodes == 0) {
+        close_topology(stats);
+        return false;
+    }
+    qsort(stats->nodes, stats->num_nodes, sizeof(NumaNode), compare_node_id);
+
+    int cpu_capacity = 0;
+    for (int i = 0; i < stats->num_nodes && ok; i++) {
+        NumaNode *node = &stats->nodes[i];
+        node->meminfo_fd = open_node_file(sys_root, node->id, "meminfo");
+        node->numastat_fd = open_node_file(sys_root, node->id, "numastat");
+        ok = read_cpulist(stats, node, sys_root, &cpu_capacity);
+    }
+
+    counter_bank_free(&stats->numastat);
+    if (!ok || counter_bank_init(&stats->numastat, stats->num_nodes * NUMASTAT_COUNTER_COUNT) != 0) {
+        close_topology(stats);
+        return false;
+    }
+
+    stats->discovered = true;
+    return true;
+}
+
+// "Node 0 MemTotal:       16323412 kB". False when the file no longer reads.
+static bool read_node_meminfo(NumaStats *stats, NumaNode *node) {
+    if (procfile_pread(node->meminfo_fd, &stats->text, &stats->text_capacity) < 0) return false;
+
+    memset(node->values, 0, sizeof(node->values));
+    char *line = stats->text;
+    while (*line) {
+        char *eol = strchr(line, '\n');
+        char *next = eol ? eol + 1 : line + strlen(line);
+        char *colon = strchr(line, ':');
+
+        if (colon && (!eol || colon < eol)) {
+            *colon = '\0';
+            // Key after the "Node N " prefix
+            char *key = strrchr(line, ' ');
+            key = key ? key + 1 : line;
+
+            const char **name = bsearch(key, meminfo_names, MEMINFO_KEY_COUNT,
+                                        sizeof(meminfo_names[0]), compare_meminfo_name);
+            if (name) {
+                node->values[name - meminfo_names] = strtoull(colon + 1, NULL, 10);
+            }
+        }
+        line = next;
+    }
+
+    const unsigned long long *v = node->values;
+    node->total_kb = (long)v[MEMINFO_MEM_TOTAL];
+    node->free_kb = (long)v[MEMINFO_MEM_FREE];
+    node->used_kb = node->total_kb - node->free_kb;
+    node->file_kb = (long)v[MEMINFO_FILE_PAGES];
+    node->anon_kb = (long)v[MEMINFO_ANON_PAGES];
+    node->usage_percent = node->total_kb > 0 ? (float)node->used_kb / node->total_kb * 100.0f : 0.0f;
+    return true;
+}
+
+// "numa_hit 39658219" per line; counters missing from the file hold still
+static bool read_node_numastat(NumaStats *stats, int index) {
+    const NumaNode *node = &stats->nodes[index];
+    CounterBank *bank = &stats->numastat;
+    int base = index * NUMASTAT_COUNTER_COUNT;
+    memcpy(&bank->current[base], &bank->previous[base], NUMASTAT_COUNTER_COUNT * sizeof(unsigned long long));
+
+    if (procfile_pread(node->numastat_fd, &stats->text, &stats->text_capacity) < 0) return false;
+
+    const char *line = stats->text;
+    while (*line) {
+        for (int c = 0; c < NUMASTAT_COUNTER_COUNT; c++) {
+            size_t length = strlen(counter_names[c]);
+            if (strncmp(line, counter_names[c], length) == 0 && line[length] == ' ') {
+                counter_bank_set(bank, base + c, strtoull(line + length, NULL, 10));
+                break;
+            }
+        }
+        const char *eol = strchr(line, '\n');
+        if (!eol) break;
+        line = eol + 1;
+    }
+    return true;
+}
+
+bool numa_update(NumaStats *stats, const char *sys_root, const float *cpu_percent, int cpu_slots,
+                 unsigned long long now_ns) {
+    if (!stats || !sys_root) return false;
+
+    if (!stats->discovered && !discover(stats, sys_root)) {
+        stats->valid = false;
+        return false;
+    }
+
+    // A node that no longer reads has gone offline: rediscover next sample
+    bool stale = false;
+    counter_bank_begin(&stats->numastat);
+    for (int i = 0; i < stats->num_nodes; i++) {
+        NumaNode *node = &stats->nodes[i];
+        bool read = read_node_meminfo(stats, node);
+        bool counted = read_node_numastat(stats, i);
+        stale = stale || (node->meminfo_fd >= 0 && !read) || (node->numastat_fd >= 0 && !counted);
+
+        // CPU-only nodes have no memory to show
+        node->valid = read && node->total_kb > 0;
+    }
+    counter_bank_commit(&stats->numastat, now_ns);
+
+    // CPUs the collector has not seen (offline) count as idle
+    for (int i = 0; i < stats->num_nodes; i++) {
+        NumaNode *node = &stats->nodes[i];
+        float sum = 0.0f;
+        for (int c = 0; c < node->cpu_count; c++) {
+            int cpu = stats->node_cpus[node->first_cpu + c];
+            if (cpu_percent && cpu < cpu_slots) sum += cpu_percent[cpu];
+        }
+        node->cpu_percent = node->cpu_count > 0 ? sum / node->cpu_count : 0.0f;
+    }
+
+    if (stale) stats->discovered = false;
+    stats->valid = true;
+    return true;
+}
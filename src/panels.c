@@ -0,0 +1,686 @@
+#include "panels.h"
+#include "sysmon.h"
+#include "metrics.h"
+#include <stdio.h>
+#include <stddef.h>
+#include <unistd.h>
+
+// Label/value layout shared by the single-entity panels, with rolling
+// window columns for headline rows. The first header names the window span
+// and is set per table, see init_window_table.
+static const RenderColumn window_columns[] = {
+    { "",     0, ALIGN_LEFT,  0,    0    },
+    { "Now", 12, ALIGN_RIGHT, 75.0, 90.0 },
+    { "Min",  7, ALIGN_RIGHT, 75.0, 90.0 },
+    { "Avg",  7, ALIGN_RIGHT, 75.0, 90.0 },
+    { "P95",  7, ALIGN_RIGHT, 75.0, 90.0 },
+    { "Max",  7, ALIGN_RIGHT, 75.0, 90.0 },
+};
+
+static const RenderColumn kernel_columns[] = {
+    { "Activity",  0, ALIGN_LEFT,  0, 0 },
+    { "Per sec",  12, ALIGN_RIGHT, 0, 0 },
+};
+
+// Retransmit share is the one percentage here
+static const RenderColumn netstack_columns[] = {
+    { "Counter",  0, ALIGN_LEFT,  0,   0   },
+    { "Per sec", 12, ALIGN_RIGHT, 2.0, 5.0 },
+    { "Total",   14, ALIGN_RIGHT, 0,   0   },
+};
+
+static const RenderColumn socket_columns[] = {
+    { "State / Port",  0, ALIGN_LEFT,  0,    0    },
+    { "Sockets",       9, ALIGN_RIGHT, 0,    0    },
+    { "Listen",        6, ALIGN_RIGHT, 0,    0    },
+    { "Accept Q",      9, ALIGN_RIGHT, 0,    0    },
+    { "Backlog",       8, ALIGN_RIGHT, 0,    0    },
+    { "Queue%",        7, ALIGN_RIGHT, 50.0, 90.0 },
+};
+
+static const RenderColumn disk_columns[] = {
+    { "Mount",   0, ALIGN_LEFT,  0,    0    },
+    { "Use%",    6, ALIGN_RIGHT, 80.0, 90.0 },
+    { "Avg%",    6, ALIGN_RIGHT, 80.0, 90.0 },
+    { "P95%",    6, ALIGN_RIGHT, 80.0, 90.0 },
+    { "Used",    9, ALIGN_RIGHT, 0,    0    },
+    { "Size",    9, ALIGN_RIGHT, 0,    0    },
+    { "Free",    9, ALIGN_RIGHT, 0,    0    },
+    { "Device", 16, ALIGN_LEFT,  0,    0    },
+};
+
+static const RenderColumn network_columns[] = {
+    { "Iface",    0, ALIGN_LEFT,  0, 0 },
+    { "RX/s",    10, ALIGN_RIGHT, 0, 0 },
+    { "TX/s",    10, ALIGN_RIGHT, 0, 0 },
+    { "RX avg",  10, ALIGN_RIGHT, 0, 0 },
+    { "RX p95",  10, ALIGN_RIGHT, 0, 0 },
+    { "TX avg",  10, ALIGN_RIGHT, 0, 0 },
+    { "TX p95",  10, ALIGN_RIGHT, 0, 0 },
+    { "RX",       9, ALIGN_RIGHT, 0, 0 },
+    { "TX",       9, ALIGN_RIGHT, 0, 0 },
+    { "RX pkts", 10, ALIGN_RIGHT, 0, 0 },
+    { "TX pkts", 10, ALIGN_RIGHT, 0, 0 },
+};
+
+static const RenderColumn process_columns[PROCESS_COLUMN_COUNT] = {
+    [PROCESS_COLUMN_PID]     = { "PID",      7, ALIGN_RIGHT, 0,    0    },
+    [PROCESS_COLUMN_COMMAND] = { "Command",  0, ALIGN_LEFT,  0,    0    },
+    [PROCESS_COLUMN_STATE]   = { "S",        1, ALIGN_LEFT,  0,    0    },
+    [PROCESS_COLUMN_CPU]     = { "CPU%",     7, ALIGN_RIGHT, 50.0, 90.0 },
+    [PROCESS_COLUMN_RSS]     = { "RSS",      9, ALIGN_RIGHT, 0,    0    },
+    [PROCESS_COLUMN_THREADS] = { "Thr",      5, ALIGN_RIGHT, 0,    0    },
+    [PROCESS_COLUMN_PSS]     = { "PSS",      9, ALIGN_RIGHT, 0,    0    },
+    [PROCESS_COLUMN_SWAP]    = { "Swap",     9, ALIGN_RIGHT, 0,    0    },
+    [PROCESS_COLUMN_READ]    = { "Read",     9, ALIGN_RIGHT, 0,    0    },
+    [PROCESS_COLUMN_WRITE]   = { "Write",    9, ALIGN_RIGHT, 0,    0    },
+    [PROCESS_COLUMN_FDS]     = { "FDs",      5, ALIGN_RIGHT, 0,    0    },
+};
+
+static const RenderColumn interrupt_columns[INTERRUPT_COLUMN_COUNT] = {
+    [INTERRUPT_COLUMN_NAME]   = { "IRQ",      7, ALIGN_LEFT,  0,    0    },
+    [INTERRUPT_COLUMN_DEVICE] = { "Device",  16, ALIGN_LEFT,  0,    0    },
+    [INTERRUPT_COLUMN_RATE]   = { "Total/s",  9, ALIGN_RIGHT, 0,    0    },
+    [INTERRUPT_COLUMN_TOP]    = { "Top",      4, ALIGN_RIGHT, 0,    0    },
+    [INTERRUPT_COLUMN_SHARE]  = { "Share",    6, ALIGN_RIGHT, 75.0, 90.0 },
+    [INTERRUPT_COLUMN_HEAT]   = { "Per-CPU",  0, ALIGN_LEFT,  0,    0    },
+};
+
+static const RenderColumn overhead_columns[] = {
+    { "Stage",  0, ALIGN_LEFT,  0, 0 },
+    { "p50",   10, ALIGN_RIGHT, 0, 0 },
+    { "p99",   10, ALIGN_RIGHT, 0, 0 },
+    { "max",   10, ALIGN_RIGHT, 0, 0 },
+    { "every", 10, ALIGN_RIGHT, 0, 0 },
+};
+
+#define NUM_COLUMNS(columns) ((int)(sizeof(columns) / sizeof((columns)[0])))
+
+// Append a label/value row to a summary table
+static RenderRow* add_summary_row(RenderTable *table, const char *label) {
+    RenderRow *row = render_table_add_row(table);
+    if (row) {
+        render_cell_text(row, 0, label);
+    }
+    return row;
+}
+
+// Start a summary table whose headline rows carry rolling window columns
+static void init_window_table(RenderTable *table, const SystemMonitor *mon) {
+    unsigned long long seconds = mon->window_ns / 1000000000ULL;
+
+    render_table_init(table, window_columns, NUM_COLUMNS(window_columns));
+    table->show_header = true;
+    if (seconds >= 60 && seconds % 60 == 0) {
+        snprintf(table->row_header, sizeof(table->row_header), "%llum window", seconds / 60);
+    } else {
+        snprintf(table->row_header, sizeof(table->row_header), "%llus window", seconds);
+    }
+}
+
+// Current percentage, highlighted when anomalous, plus its window summary
+static void add_window_row(RenderTable *table, const SystemMonitor *mon, const char *label, double value,
+                           SystemWindow window) {
+    RenderRow *row = add_summary_row(table, label);
+    if (!row) return;
+
+    AnomalyState anomaly;
+    render_cell_percent(row, 1, value);
+    render_cell_anomaly(row, 1, sysmon_anomaly(mon, window, &anomaly) && anomaly.anomalous);
+
+    WindowStats stats;
+    if (sysmon_window_stats(mon, window, &stats)) {
+        render_cell_percent(row, 2, stats.min);
+        render_cell_percent(row, 3, stats.avg);
+        render_cell_percent(row, 4, stats.p95);
+        render_cell_percent(row, 5, stats.max);
+    }
+}
+
+// Value cell of a registry metric, formatted by its unit
+static void render_cell_metric(RenderRow *row, int col, const MetricDesc *metric, double value) {
+    switch (metric->unit) {
+        case METRIC_PERCENT:    render_cell_percent(row, col, value); break;
+        case METRIC_KB:         render_cell_bytes(row, col, (unsigned long long)value * 1024ULL); break;
+        case METRIC_BYTES:      render_cell_bytes(row, col, (unsigned long long)value); break;
+        case METRIC_MBPS:       render_cell_rate(row, col, value); break;
+        case METRIC_PER_SECOND: render_cell_int(row, col, (long long)(value + 0.5)); break;
+        case METRIC_TICKS:
+        case METRIC_NUMBER:     render_cell_int(row, col, (long long)value); break;
+    }
+}
+
+// One row per registry metric of a group, in registry order. Metrics with
+// a rolling window get its columns; swap rows show only while swap is
+// configured; a metric without a value yet keeps its row, blank.
+static void add_metric_rows(RenderTable *table, const SystemMonitor *mon, MetricGroup group) {
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        const MetricDesc *metric = &metric_table[i];
+        if (metric->group != group || ((metric->flags & METRIC_SWAP) && mon->memory.swap_total_kb == 0)) continue;
+
+        if (metric->window != METRIC_NO_WINDOW) {
+            add_window_row(table, mon, metric->label, metric_value(mon, metric, NULL), (SystemWindow)metric->window);
+            continue;
+        }
+
+        RenderRow *row = add_summary_row(table, metric->label);
+        if (row && metric_available(mon, metric)) {
+            render_cell_metric(row, 1, metric, metric_value(mon, metric, NULL));
+        }
+    }
+}
+
+void panels_build_cpu(RenderTable *table, const SystemMonitor *mon) {
+    const CPUStats *cpu = &mon->cpu;
+
+    init_window_table(table, mon);
+
+    if (!cpu->valid) {
+        render_table_set_message(table, "CPU information unavailable");
+        return;
+    }
+
+    add_metric_rows(table, mon, METRIC_GROUP_CPU);
+
+    // Adaptive sampling stretches this as the CPU goes quiet
+    if (mon->adaptive) {
+        render_cell_duration(add_summary_row(table, "Interval"), 1,
+                             sysmon_stage_interval(mon, SELFSTAT_CPU));
+    }
+}
+
+void panels_build_memory(RenderTable *table, const SystemMonitor *mon) {
+    const MemoryStats *mem = &mon->memory;
+
+    init_window_table(table, mon);
+
+    if (!mem->valid) {
+        render_table_set_message(table, "Memory information unavailable");
+        return;
+    }
+
+    add_metric_rows(table, mon, METRIC_GROUP_MEMORY);
+
+    if (sysmon_meminfo(mem, MEMINFO_HUGE_PAGES_TOTAL) > 0) {
+        unsigned long long page = sysmon_meminfo(mem, MEMINFO_HUGEPAGESIZE) * 1024ULL;
+        render_cell_bytes(add_summary_row(table, "HugePages"), 1, sysmon_meminfo(mem, MEMINFO_HUGE_PAGES_TOTAL) * page);
+        render_cell_bytes(add_summary_row(table, "HugePages Free"), 1, sysmon_meminfo(mem, MEMINFO_HUGE_PAGES_FREE) * page);
+    }
+}
+
+void panels_build_kernel(RenderTable *table, const SystemMonitor *mon) {
+    const KernelStats *kernel = &mon->kernel;
+
+    render_table_init(table, kernel_columns, NUM_COLUMNS(kernel_columns));
+    table->show_header = true;
+
+    if (!kernel->valid) {
+        render_table_set_message(table, "Kernel activity unavailable");
+        return;
+    }
+
+    // Rates need two samples; vmstat counters need /proc/vmstat
+    add_metric_rows(table, mon, METRIC_GROUP_KERNEL);
+}
+
+static void fill_disk_row(void *ctx, int index, RenderRow *row) {
+    const SystemMonitor *mon = ctx;
+    const DiskStats *disk = sysmon_get_disk(mon, index);
+    if (!disk || !disk->valid) return;
+
+    render_cell_text(row, 0, disk->mount_point);
+    render_cell_percent(row, 1, disk->usage_percent);
+
+    AnomalyState anomaly;
+    render_cell_anomaly(row, 1, sysmon_disk_anomaly(mon, index, &anomaly) && anomaly.anomalous);
+
+    WindowStats window;
+    if (sysmon_disk_window(mon, index, &window)) {
+        render_cell_percent(row, 2, window.avg);
+        render_cell_percent(row, 3, window.p95);
+    }
+
+    render_cell_bytes(row, 4, disk->used_kb * 1024ULL);
+    render_cell_bytes(row, 5, disk->total_kb * 1024ULL);
+    render_cell_bytes(row, 6, disk->available_kb * 1024ULL);
+    render_cell_text(row, 7, disk->device);
+}
+
+void panels_build_disk(RenderList *list, const SystemMonitor *mon) {
+    render_list_init(list, disk_columns, NUM_COLUMNS(disk_columns),
+                     mon->disk_count, fill_disk_row, (void *)mon);
+    list->show_header = true;
+    list->sortable = true;
+
+    if (mon->disk_count == 0) {
+        list->message = "No disk information available";
+    }
+}
+
+static void fill_network_row(void *ctx, int index, RenderRow *row) {
+    const SystemMonitor *mon = ctx;
+    const NetworkStats *net = sysmon_get_interface(mon, index);
+    if (!net || !net->valid) return;
+
+    render_cell_text(row, 0, net->interface_name);
+    render_cell_rate(row, 1, net->rx_rate_mbps);
+    render_cell_rate(row, 2, net->tx_rate_mbps);
+
+    AnomalyState anomaly;
+    render_cell_anomaly(row, 1, sysmon_interface_anomaly(mon, index, false, &anomaly) && anomaly.anomalous);
+    render_cell_anomaly(row, 2, sysmon_interface_anomaly(mon, index, true, &anomaly) && anomaly.anomalous);
+
+    WindowStats window;
+    if (sysmon_interface_window(mon, index, false, &window)) {
+        render_cell_rate(row, 3, window.avg);
+        render_cell_rate(row, 4, window.p95);
+    }
+    if (sysmon_interface_window(mon, index, true, &window)) {
+        render_cell_rate(row, 5, window.avg);
+        render_cell_rate(row, 6, window.p95);
+    }
+
+    render_cell_bytes(row, 7, net->rx_bytes);
+    render_cell_bytes(row, 8, net->tx_bytes);
+    render_cell_int(row, 9, (long long)net->rx_packets);
+    render_cell_int(row, 10, (long long)net->tx_packets);
+}
+
+void panels_build_network(RenderList *list, const SystemMonitor *mon) {
+    render_list_init(list, network_columns, NUM_COLUMNS(network_columns),
+                     mon->interface_count, fill_network_row, (void *)mon);
+    list->show_header = true;
+    list->sortable = true;
+
+    if (mon->interface_count == 0) {
+        list->message = "No network interfaces found";
+    }
+}
+
+// Sort keys: cheap fields plus whatever details are already cached, so
+// ordering never triggers a fetch
+static void fill_process_key(void *ctx, int index, RenderRow *row) {
+    const ProcessStats *proc = sysmon_get_process(ctx, index);
+    if (!proc || !proc->valid) return;
+
+    render_cell_int(row, PROCESS_COLUMN_PID, proc->pid);
+    render_cell_text(row, PROCESS_COLUMN_COMMAND, proc->command);
+    render_cell_text(row, PROCESS_COLUMN_STATE, proc->state);
+    render_cell_percent(row, PROCESS_COLUMN_CPU, proc->cpu_percent);
+    render_cell_bytes(row, PROCESS_COLUMN_RSS, proc->rss_kb * 1024ULL);
+    render_cell_int(row, PROCESS_COLUMN_THREADS, proc->threads);
+
+    if (proc->detail_valid & PROCESS_DETAIL_MASK(PROCESS_DETAIL_MEMORY)) {
+        render_cell_bytes(row, PROCESS_COLUMN_PSS, proc->pss_kb * 1024ULL);
+        render_cell_bytes(row, PROCESS_COLUMN_SWAP, proc->swap_kb * 1024ULL);
+    }
+    if (proc->detail_valid & PROCESS_DETAIL_MASK(PROCESS_DETAIL_IO)) {
+        render_cell_bytes(row, PROCESS_COLUMN_READ, proc->read_bytes);
+        render_cell_bytes(row, PROCESS_COLUMN_WRITE, proc->write_bytes);
+    }
+    if (proc->detail_valid & PROCESS_DETAIL_MASK(PROCESS_DETAIL_FDS)) {
+        render_cell_int(row, PROCESS_COLUMN_FDS, proc->fd_count);
+    }
+}
+
+// Rows on screen: refresh stale details first
+static void fill_process_row(void *ctx, int index, RenderRow *row) {
+    ProcessStats *proc = sysmon_get_process(ctx, index);
+    if (!proc || !proc->valid) return;
+
+    sysmon_process_details(ctx, proc, PROCESS_DETAIL_ALL);
+    fill_process_key(ctx, index, row);
+}
+
+void panels_build_process(RenderList *list, SystemMonitor *mon) {
+    render_list_init(list, process_columns, PROCESS_COLUMN_COUNT,
+                     mon->process_count, fill_process_row, mon);
+    list->show_header = true;
+    list->sortable = true;
+
+    // Tens of thousands of rows, but only a screenful is ever looked at;
+    // the pid keeps equal rows from swapping places between frames
+    list->partial_order = true;
+    list->tiebreak_column = PROCESS_COLUMN_PID;
+    list->fill_key = fill_process_key;
+
+    if (mon->process_count == 0) {
+        list->message = "Collecting process information...";
+    }
+}
+
+// Rate and running total of one stack counter
+static void add_netstack_counter(RenderTable *table, const NetstackStats *stats, NetstackCounter counter) {
+    RenderRow *row = add_summary_row(table, netstack_counter_name(counter));
+    if (!row) return;
+
+    if (counter_bank_has_rates(&stats->counters)) {
+        render_cell_int(row, 1, (long long)(counter_bank_rate(&stats->counters, counter) + 0.5));
+    }
+    render_cell_int(row, 2, (long long)stats->counters.current[counter]);
+}
+
+void panels_build_netstack(RenderTable *table, const SystemMonitor *mon) {
+    static char busiest_label[32];
+    const NetstackStats *stats = &mon->netstack;
+
+    render_table_init(table, netstack_columns, NUM_COLUMNS(netstack_columns));
+    table->show_header = true;
+
+    if (!stats->valid) {
+        render_table_set_message(table, "Collecting network stack counters...");
+        return;
+    }
+
+    // Drops and squeezes mean packet processing ran out of CPU before the
+    // link filled up
+    if (stats->has_softnet) {
+        for (int i = NETSTACK_SOFTNET_PROCESSED; i <= NETSTACK_SOFTNET_SQUEEZED; i++) {
+            add_netstack_counter(table, stats, i);
+        }
+
+        int busiest = netstack_busiest_row(stats, SOFTNET_PROCESSED);
+        if (busiest >= 0 && stats->softnet_cpus > 1) {
+            snprintf(busiest_label, sizeof(busiest_label), "Busiest CPU (cpu%d)", stats->softnet_cpu_ids[busiest]);
+            RenderRow *row = add_summary_row(table, busiest_label);
+            if (row) {
+                render_cell_int(row, 1, (long long)(counter_bank_rate(&stats->softnet,
+                                        busiest * SOFTNET_FIELD_COUNT + SOFTNET_PROCESSED) + 0.5));
+            }
+        }
+    }
+
+    if (stats->has_snmp) {
+        for (int i = NETSTACK_IP_IN_RECEIVES; i <= NETSTACK_TCP_ATTEMPT_FAILS; i++) {
+            add_netstack_counter(table, stats, i);
+        }
+
+        double out = counter_bank_rate(&stats->counters, NETSTACK_TCP_OUT_SEGS);
+        if (out > 0) {
+            render_cell_percent(add_summary_row(table, "TCP retransmit share"), 1,
+                                counter_bank_rate(&stats->counters, NETSTACK_TCP_RETRANS_SEGS) * 100.0 / out);
+        }
+    }
+
+    if (stats->has_netstat) {
+        for (int i = NETSTACK_TCP_LISTEN_OVERFLOWS; i <= NETSTACK_TCP_TIMEOUTS; i++) {
+            add_netstack_counter(table, stats, i);
+        }
+    }
+
+    if (stats->has_snmp) {
+        for (int i = NETSTACK_UDP_IN_DATAGRAMS; i <= NETSTACK_UDP_SNDBUF_ERRORS; i++) {
+            add_netstack_counter(table, stats, i);
+        }
+    }
+
+    // Socket gauges: current counts, not rates
+    if (stats->has_sockstat) {
+        const SocketSummary *s = &stats->sockets;
+        unsigned long long page = (unsigned long long)sysconf(_SC_PAGESIZE);
+
+        render_cell_int(add_summary_row(table, "Sockets in use"), 2, s->sockets_used);
+        render_cell_int(add_summary_row(table, "TCP in use"), 2, s->tcp_inuse);
+        render_cell_int(add_summary_row(table, "TCP time-wait"), 2, s->tcp_timewait);
+        render_cell_int(add_summary_row(table, "TCP orphans"), 2, s->tcp_orphan);
+        render_cell_bytes(add_summary_row(table, "TCP memory"), 2, s->tcp_mem_pages * page);
+        render_cell_int(add_summary_row(table, "UDP in use"), 2, s->udp_inuse);
+        render_cell_bytes(add_summary_row(table, "UDP memory"), 2, s->udp_mem_pages * page);
+    }
+}
+
+void panels_build_sockets(RenderTable *table, const SystemMonitor *mon) {
+    static char port_labels[RENDER_MAX_ROWS][16];
+    const SockDiagStats *stats = &mon->sockets;
+
+    render_table_init(table, socket_columns, NUM_COLUMNS(socket_columns));
+    table->show_header = true;
+
+    if (!stats->valid) {
+        render_table_set_message(table, "TCP socket information unavailable (sock_diag)");
+        return;
+    }
+
+    render_cell_int(add_summary_row(table, "All TCP sockets"), 1, stats->total);
+    for (int state = TCP_STATE_ESTABLISHED; state < TCP_STATE_COUNT; state++) {
+        if (stats->states[state] == 0) continue;
+        render_cell_int(add_summary_row(table, sockdiag_state_name(state)), 1, stats->states[state]);
+    }
+
+    // Listening ports, busiest first, as many as fit
+    for (int i = 0; i < stats->num_ports && table->num_rows < RENDER_MAX_ROWS; i++) {
+        const ListenPort *port = &stats->ports[i];
+        snprintf(port_labels[i], sizeof(port_labels[i]), "port %u", port->port);
+
+        RenderRow *row = add_summary_row(table, port_labels[i]);
+        if (!row) break;
+
+        render_cell_int(row, 1, port->connections);
+        render_cell_int(row, 2, port->listeners);
+        render_cell_int(row, 3, port->accept_queue);
+        render_cell_int(row, 4, port->backlog);
+        if (port->backlog > 0) {
+            render_cell_percent(row, 5, port->accept_queue * 100.0 / port->backlog);
+        }
+    }
+}
+
+// Heatmap cells: one character per CPU (or per group of CPUs on wide hosts),
+// scaled to the busiest CPU of the line
+#define INTERRUPT_HEAT_WIDTH 64
+
+static const char heat_ramp[] = ":-=+*#%@";
+
+// Rows are hardware IRQs followed by softirqs
+static const InterruptMatrix* interrupt_row(const SystemMonitor *mon, int index, int *line) {
+    const InterruptStats *stats = &mon->interrupts;
+
+    if (index < stats->irqs.num_lines) {
+        *line = index;
+        return &stats->irqs;
+    }
+    *line = index - stats->irqs.num_lines;
+    return *line < stats->softirqs.num_lines ? &stats->softirqs : NULL;
+}
+
+// Sort keys skip the heat string, which lives in a per-row scratch buffer
+static void fill_interrupt_key(void *ctx, int index, RenderRow *row) {
+    const SystemMonitor *mon = ctx;
+    int line;
+    const InterruptMatrix *matrix = interrupt_row(mon, index, &line);
+    if (!matrix) return;
+
+    const InterruptLine *entry = &matrix->lines[line];
+    double total = matrix->line_rates[line];
+
+    render_cell_text(row, INTERRUPT_COLUMN_NAME, entry->name);
+    render_cell_text(row, INTERRUPT_COLUMN_DEVICE,
+                     matrix == &mon->interrupts.softirqs ? "softirq" : entry->device);
+    render_cell_int(row, INTERRUPT_COLUMN_RATE, (long long)(total + 0.5));
+
+    if (matrix->num_cpus < 2 || total <= 0) return;
+
+    int top = 0;
+    for (int cpu = 1; cpu < matrix->num_cpus; cpu++) {
+        if (interrupts_rate(matrix, line, cpu) > interrupts_rate(matrix, line, top)) top = cpu;
+    }
+    render_cell_int(row, INTERRUPT_COLUMN_TOP, top);
+    render_cell_percent(row, INTERRUPT_COLUMN_SHARE, interrupts_rate(matrix, line, top) * 100.0 / total);
+}
+
+// The list draws each row right after filling it, so one buffer serves all
+static void fill_interrupt_row(void *ctx, int index, RenderRow *row) {
+    static char heat[INTERRUPT_HEAT_WIDTH + 1];
+
+    int line;
+    const InterruptMatrix *matrix = interrupt_row(ctx, index, &line);
+    if (!matrix) return;
+
+    fill_interrupt_key(ctx, index, row);
+
+    int num_cpus = matrix->num_cpus;
+    int group = (num_cpus + INTERRUPT_HEAT_WIDTH - 1) / INTERRUPT_HEAT_WIDTH;
+    int cells = (num_cpus + group - 1) / group;
+
+    double max = 0.0;
+    for (int cpu = 0; cpu < num_cpus; cpu++) {
+        double rate = interrupts_rate(matrix, line, cpu);
+        if (rate > max) max = rate;
+    }
+
+    for (int c = 0; c < cells; c++) {
+        double rate = 0.0;
+        for (int cpu = c * group; cpu < (c + 1) * group && cpu < num_cpus; cpu++) {
+            double r = interrupts_rate(matrix, line, cpu);
+            if (r > rate) rate = r;
+        }
+
+        if (rate <= 0 || max <= 0) {
+            heat[c] = '.';
+        } else {
+            int level = (int)(rate / max * (sizeof(heat_ramp) - 1));
+            if (level >= (int)sizeof(heat_ramp) - 1) level = sizeof(heat_ramp) - 2;
+            heat[c] = heat_ramp[level];
+        }
+    }
+    heat[cells] = '\0';
+
+    render_cell_text(row, INTERRUPT_COLUMN_HEAT, heat);
+}
+
+void panels_build_interrupts(RenderList *list, const SystemMonitor *mon) {
+    const InterruptStats *stats = &mon->interrupts;
+
+    render_list_init(list, interrupt_columns, INTERRUPT_COLUMN_COUNT,
+                     stats->irqs.num_lines + stats->softirqs.num_lines, fill_interrupt_row, (void *)mon);
+    list->show_header = true;
+    list->sortable = true;
+    list->partial_order = true;
+    list->fill_key = fill_interrupt_key;
+
+    if (!stats->irqs.valid && !stats->softirqs.valid) {
+        list->message = "Collecting interrupt counts...";
+    }
+}
+
+static const RenderColumn numa_columns[] = {
+    { "Node / CPU", 0, ALIGN_LEFT,  0,    0    },
+    { "CPU%",       6, ALIGN_RIGHT, 75.0, 90.0 },
+    { "Mem%",       6, ALIGN_RIGHT, 85.0, 95.0 },
+    { "Used",       9, ALIGN_RIGHT, 0,    0    },
+    { "Free",       9, ALIGN_RIGHT, 0,    0    },
+    { "File",       9, ALIGN_RIGHT, 0,    0    },
+    { "Hit/s",      9, ALIGN_RIGHT, 0,    0    },
+    { "Miss/s",     8, ALIGN_RIGHT, 0,    0    },
+    { "Foreign/s", 10, ALIGN_RIGHT, 0,    0    },
+    { "Local%",     7, ALIGN_RIGHT, 0,    0    },
+};
+
+// Rows are each node followed by its CPUs; returns the node, and the CPU
+// id or -1 for the node's own row
+static const NumaNode* numa_row(const NumaStats *stats, int index, int *cpu) {
+    for (int i = 0; i < stats->num_nodes; i++) {
+        const NumaNode *node = &stats->nodes[i];
+        if (index <= node->cpu_count) {
+            *cpu = index == 0 ? -1 : stats->node_cpus[node->first_cpu + index - 1];
+            return node;
+        }
+        index -= node->cpu_count + 1;
+    }
+    return NULL;
+}
+
+// The list draws each row right after filling it, so one label serves all
+static void fill_numa_row(void *ctx, int index, RenderRow *row) {
+    static char label[32];
+    const SystemMonitor *mon = ctx;
+    const NumaStats *stats = &mon->numa;
+
+    int cpu;
+    const NumaNode *node = numa_row(stats, index, &cpu);
+    if (!node) return;
+
+    if (cpu >= 0) {
+        snprintf(label, sizeof(label), "  cpu%d", cpu);
+        render_cell_text(row, NUMA_COLUMN_NAME, label);
+        if (cpu < mon->cpu.cpu_slots) {
+            render_cell_percent(row, NUMA_COLUMN_CPU, mon->cpu.cpu_percent[cpu]);
+        }
+        return;
+    }
+
+    snprintf(label, sizeof(label), "Node %d (%d CPU%s)", node->id, node->cpu_count,
+             node->cpu_count == 1 ? "" : "s");
+    render_cell_text(row, NUMA_COLUMN_NAME, label);
+    if (node->cpu_count > 0) {
+        render_cell_percent(row, NUMA_COLUMN_CPU, node->cpu_percent);
+    }
+    if (!node->valid) return;
+
+    render_cell_percent(row, NUMA_COLUMN_MEMORY, node->usage_percent);
+    render_cell_bytes(row, NUMA_COLUMN_USED, node->used_kb * 1024ULL);
+    render_cell_bytes(row, NUMA_COLUMN_FREE, node->free_kb * 1024ULL);
+    render_cell_bytes(row, NUMA_COLUMN_FILE, node->file_kb * 1024ULL);
+
+    if (!counter_bank_has_rates(&stats->numastat)) return;
+
+    int n = (int)(node - stats->nodes);
+    render_cell_int(row, NUMA_COLUMN_HIT, (long long)(numa_rate(stats, n, NUMASTAT_HIT) + 0.5));
+    render_cell_int(row, NUMA_COLUMN_MISS, (long long)(numa_rate(stats, n, NUMASTAT_MISS) + 0.5));
+    render_cell_int(row, NUMA_COLUMN_FOREIGN, (long long)(numa_rate(stats, n, NUMASTAT_FOREIGN) + 0.5));
+
+    double local = numa_rate(stats, n, NUMASTAT_LOCAL_NODE);
+    double other = numa_rate(stats, n, NUMASTAT_OTHER_NODE);
+    if (local + other > 0) {
+        render_cell_percent(row, NUMA_COLUMN_LOCAL, local * 100.0 / (local + other));
+    }
+}
+
+void panels_build_numa(RenderList *list, const SystemMonitor *mon) {
+    const NumaStats *stats = &mon->numa;
+
+    render_list_init(list, numa_columns, NUMA_COLUMN_COUNT, stats->num_nodes + stats->num_cpus,
+                     fill_numa_row, (void *)mon);
+    list->show_header = true;
+
+    if (!stats->valid) {
+        list->message = "NUMA topology unavailable (no /sys/devices/system/node)";
+    }
+}
+
+void panels_build_overhead(RenderTable *table, const SystemMonitor *mon, const SelfProcessStats *process,
+                           double output_rate) {
+    render_table_init(table, overhead_columns, NUM_COLUMNS(overhead_columns));
+    table->show_header = true;
+
+    for (int i = 0; i < SELFSTAT_STAGE_COUNT; i++) {
+        const Histogram *hist = selfstat_histogram(&mon->selfstat, i);
+        RenderRow *row = render_table_add_row(table);
+        if (!row) break;
+
+        render_cell_text(row, 0, selfstat_stage_name(i));
+
+        // Effective collector interval, stretched by adaptive sampling
+        unsigned long long interval = sysmon_stage_interval(mon, i);
+        if (interval > 0) {
+            render_cell_duration(row, 4, interval);
+        }
+        if (hist->total == 0) continue;
+
+        render_cell_duration(row, 1, histogram_percentile(hist, 0.50));
+        render_cell_duration(row, 2, histogram_percentile(hist, 0.99));
+        render_cell_duration(row, 3, hist->max);
+    }
+
+    if (output_rate >= 0.0) {
+        render_cell_bytes(add_summary_row(table, "Output/s"), 1, (unsigned long long)(output_rate + 0.5));
+    }
+
+    if (!process || !process->valid) {
+        return;
+    }
+
+    render_cell_int(add_summary_row(table, "Read/write syscalls/tick"), 1, (long long)(process->syscalls_per_tick + 0.5));
+    render_cell_bytes(add_summary_row(table, "RSS"), 1, process->rss_kb * 1024ULL);
+    render_cell_percent(add_summary_row(table, "CPU"), 1, process->cpu_percent);
+}
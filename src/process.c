@@ -0,0 +1,370 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "process.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <dirent.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+// Skip n space-separated fields
+static const char* skip_fields(const char *p, int n) {
+    while (n-- > 0 && *p) {
+        while (*p && *p != ' ') p++;
+        while (*p == ' ') p++;
+    }
+    return p;
+}
+
+// Fields after the command, counted from state (field 3 in proc(5))
+static bool parse_stat(ProcessStats *proc, const char *buffer, long page_kb) {
+    // The command may contain spaces and parentheses; it ends at the last ')'
+    const char *open_paren = strchr(buffer, '(');
+    const char *close_paren = strrchr(buffer, ')');
+    if (!open_paren || !close_paren || close_paren < open_paren || close_paren[1] != ' ') {
+        return false;
+    }
+
+    size_t len = close_paren - open_paren - 1;
+    if (len >= sizeof(proc->command)) len = sizeof(proc->command) - 1;
+    memcpy(proc->command, open_paren + 1, len);
+    proc->command[len] = '\0';
+
+    const char *p = close_paren + 2;
+    proc->state[0] = *p;
+    proc->state[1] = '\0';
+
+    char *end;
+    p = skip_fields(p, 1);                            // ppid
+    proc->ppid = (int)strtol(p, &end, 10);
+    p = skip_fields(p, 10);                           // utime
+    unsigned long long utime = strtoull(p, &end, 10);
+    p = skip_fields(p, 1);                            // stime
+    unsigned long long stime = strtoull(p, &end, 10);
+    p = skip_fields(p, 5);                            // num_threads
+    proc->threads = strtol(p, &end, 10);
+    p = skip_fields(p, 3);                            // vsize
+    proc->vsize = strtoull(p, &end, 10);
+    p = skip_fields(p, 1);                            // rss, in pages
+    long rss_pages = strtol(p, &end, 10);
+    if (end == p) return false;
+
+    proc->cpu_ticks = utime + stime;
+    proc->rss_kb = rss_pages * page_kb;
+    return true;
+}
+
+int process_scan_init(ProcessScan *scan, bool use_uring) {
+    if (!scan) return -1;
+
+    memset(scan, 0, sizeof(ProcessScan));
+    struct rlimit limit;
+    scan->max_open = getrlimit(RLIMIT_NOFILE, &limit) == 0 && limit.rlim_cur != RLIM_INFINITY
+                     ? (int)(limit.rlim_cur / 2) : 512;
+    return batch_reader_init(&scan->reader, use_uring);
+}
+
+void process_scan_free(ProcessScan *scan) {
+    if (!scan) return;
+
+    for (int slot = 0; slot < scan->capacity; slot++) {
+        if (scan->fds[slot] >= 0) close(scan->fds[slot]);
+    }
+    batch_reader_free(&scan->reader);
+    free(scan->fds);
+    free(scan->reads);
+    free(scan->read_slots);
+    free(scan->buffers);
+    memset(scan, 0, sizeof(ProcessScan));
+    scan->reader.ring_fd = -1;  // Freeing again must not close stdin
+}
+
+static bool reserve_slots(ProcessScan *scan, int count) {
+    if (count <= scan->capacity) return true;
+
+    int capacity = scan->capacity ? scan->capacity * 2 : 256;
+    while (capacity < count) capacity *= 2;
+
+    int *fds = realloc(scan->fds, capacity * sizeof(int));
+    if (!fds) return false;
+    scan->fds = fds;
+
+    for (int slot = scan->capacity; slot < capacity; slot++) {
+        scan->fds[slot] = -1;
+    }
+    scan->capacity = capacity;
+    return true;
+}
+
+static bool reserve_reads(ProcessScan *scan, int count) {
+    if (count <= scan->reads_capacity) return true;
+
+    int capacity = scan->reads_capacity ? scan->reads_capacity * 2 : 256;
+    while (capacity < count) capacity *= 2;
+
+    BatchRead *reads = realloc(scan->reads, capacity * sizeof(BatchRead));
+    if (!reads) return false;
+    scan->reads = reads;
+    int *read_slots = realloc(scan->read_slots, capacity * sizeof(int));
+    if (!read_slots) return false;
+    scan->read_slots = read_slots;
+    char *buffers = realloc(scan->buffers, (size_t)capacity * PROCESS_STAT_SIZE);
+    if (!buffers) return false;
+    scan->buffers = buffers;
+
+    scan->reads_capacity = capacity;
+    return true;
+}
+
+static void close_slot(ProcessScan *scan, int slot) {
+    if (scan->fds[slot] < 0) return;
+    close(scan->fds[slot]);
+    scan->fds[slot] = -1;
+    scan->open_count--;
+}
+
+// One open, read and close, for uncached scans and processes past the budget
+static ssize_t read_stat_once(int dir_fd, const char *relative, char *buffer, size_t size) {
+    int fd = openat(dir_fd, relative, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    ssize_t n = read(fd, buffer, size - 1);
+    close(fd);
+    if (n > 0) buffer[n] = '\0';
+    return n;
+}
+
+// CPU percentage and bookkeeping of a freshly read stat line
+static void apply_stat(ProcessStats *proc, const char *buffer, long page_kb, double ticks_per_sec,
+                       double elapsed_sec) {
+    if (!parse_stat(proc, buffer, page_kb)) {
+        proc->valid = false;
+        return;
+    }
+
+    // A recycled pid shows up as a drop in CPU time; start over
+    if (proc->has_prev && elapsed_sec > 0 && proc->cpu_ticks >= proc->prev_cpu_ticks) {
+        double ticks = (double)(proc->cpu_ticks - proc->prev_cpu_ticks);
+        proc->cpu_percent = ticks / ticks_per_sec / elapsed_sec * 100.0;
+    } else {
+        proc->cpu_percent = 0.0;
+    }
+
+    proc->prev_cpu_ticks = proc->cpu_ticks;
+    proc->has_prev = true;
+    proc->valid = true;
+}
+
+int process_update_all(StatTable *processes, ProcessScan *scan, const char *proc_root,
+                       unsigned long long elapsed_ns) {
+    if (!processes || !proc_root) return 0;
+
+    DIR *dir = opendir(proc_root);
+    if (!dir) return stat_table_count(processes);
+
+    int dir_fd = dirfd(dir);
+    long page_kb = sysconf(_SC_PAGESIZE) / 1024;
+    double ticks_per_sec = (double)sysconf(_SC_CLK_TCK);
+    double elapsed_sec = elapsed_ns / 1e9;
+    int batched = 0;
+
+    stat_table_begin(processes);
+
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (!isdigit((unsigned char)entry->d_name[0])) continue;
+
+        // Open relative to the proc directory to skip repeated path walks
+        char relative[sizeof(entry->d_name) + 8];
+        snprintf(relative, sizeof(relative), "%s/stat", entry->d_name);
+
+        bool created;
+        int slot;
+        ProcessStats *proc = stat_table_upsert(processes, entry->d_name, &created, &slot);
+        if (!proc) continue;
+        proc->pid = atoi(entry->d_name);
+
+        // Known processes reuse their descriptor; new ones get one while
+        // the budget lasts
+        int fd = scan && slot < scan->capacity ? scan->fds[slot] : -1;
+        if (scan && fd < 0 && scan->open_count < scan->max_open && reserve_slots(scan, slot + 1)) {
+            fd = openat(dir_fd, relative, O_RDONLY | O_CLOEXEC);
+            if (fd < 0) {
+                stat_table_cancel(processes, slot, created); // Exited since readdir
+                continue;
+            }
+            scan->fds[slot] = fd;
+            scan->open_count++;
+        }
+
+        if (fd < 0) {
+            char buffer[PROCESS_STAT_SIZE];
+            if (read_stat_once(dir_fd, relative, buffer, sizeof(buffer)) <= 0) {
+                stat_table_cancel(processes, slot, created);
+                continue;
+            }
+            apply_stat(proc, buffer, page_kb, ticks_per_sec, elapsed_sec);
+        } else if (reserve_reads(scan, batched + 1)) {
+            scan->reads[batched].fd = fd;
+            scan->reads[batched].size = PROCESS_STAT_SIZE;
+            scan->read_slots[batched++] = slot;
+        } else {
+            proc->valid = false;
+        }
+    }
+
+    // Every cached stat file in one batch
+    if (scan && batched > 0) {
+        // Buffers are assigned last, as the arena may have moved while growing
+        for (int i = 0; i < batched; i++) {
+            scan->reads[i].buffer = scan->buffers + (size_t)i * PROCESS_STAT_SIZE;
+        }
+        batch_read_run(&scan->reader, scan->reads, batched);
+        for (int i = 0; i < batched; i++) {
+            int slot = scan->read_slots[i];
+            ProcessStats *proc = stat_table_entry(processes, slot);
+            BatchRead *read = &scan->reads[i];
+
+            // The process behind the descriptor is gone: the pid was reused,
+            // or it exited since readdir. A process found under the pid is a
+            // new one, so nothing measured from the old one carries over.
+            if (read->result <= 0) {
+                char relative[24];
+                close_slot(scan, slot);
+                snprintf(relative, sizeof(relative), "%d/stat", proc->pid);
+                if (read_stat_once(dir_fd, relative, read->buffer, read->size) <= 0) {
+                    proc->valid = false;
+                    continue;
+                }
+                proc->has_prev = false;
+                memset(proc->detail_ns, 0, sizeof(proc->detail_ns));
+                proc->detail_valid = 0;
+            }
+            apply_stat(proc, read->buffer, page_kb, ticks_per_sec, elapsed_sec);
+        }
+    }
+
+    closedir(dir);
+
+    // Release processes that exited, and their descriptors
+    stat_table_end(processes);
+    for (int slot = 0; scan && slot < scan->capacity; slot++) {
+        if (scan->fds[slot] >= 0 && !processes->slots[slot].in_use) close_slot(scan, slot);
+    }
+    return stat_table_count(processes);
+}
+
+static const unsigned long long detail_ttl_ns[PROCESS_DETAIL_COUNT] = {
+    [PROCESS_DETAIL_MEMORY] = PROCESS_TTL_MEMORY_NS,
+    [PROCESS_DETAIL_IO]     = PROCESS_TTL_IO_NS,
+    [PROCESS_DETAIL_FDS]    = PROCESS_TTL_FDS_NS,
+};
+
+// Read a small /proc/[pid] file in one go
+static bool read_pid_file(const char *proc_root, int pid, const char *name, char *buffer, size_t size) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%d/%s", proc_root, pid, name);
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+
+    ssize_t n = read(fd, buffer, size - 1);
+    close(fd);
+    if (n <= 0) return false;
+
+    buffer[n] = '\0';
+    return true;
+}
+
+// Value of a "Key: value" line, or -1 when missing
+static long long find_field(const char *buffer, const char *key) {
+    size_t len = strlen(key);
+    const char *p = buffer;
+    while (p) {
+        if (strncmp(p, key, len) == 0 && p[len] == ':') {
+            return strtoll(p + len + 1, NULL, 10);
+        }
+        p = strchr(p, '\n');
+        if (p) p++;
+    }
+    return -1;
+}
+
+static bool fetch_memory(ProcessStats *proc, const char *proc_root) {
+    char buffer[2048];
+    if (!read_pid_file(proc_root, proc->pid, "smaps_rollup", buffer, sizeof(buffer))) return false;
+
+    long long pss = find_field(buffer, "Pss");
+    long long swap = find_field(buffer, "Swap");
+    if (pss < 0) return false;
+
+    proc->pss_kb = (long)pss;
+    proc->swap_kb = swap > 0 ? (long)swap : 0;
+    return true;
+}
+
+static bool fetch_io(ProcessStats *proc, const char *proc_root) {
+    char buffer[512];
+    if (!read_pid_file(proc_root, proc->pid, "io", buffer, sizeof(buffer))) return false;
+
+    long long read_bytes = find_field(buffer, "read_bytes");
+    long long write_bytes = find_field(buffer, "write_bytes");
+    if (read_bytes < 0 || write_bytes < 0) return false;
+
+    proc->read_bytes = (unsigned long long)read_bytes;
+    proc->write_bytes = (unsigned long long)write_bytes;
+    return true;
+}
+
+static bool fetch_fds(ProcessStats *proc, const char *proc_root) {
+    char path[512];
+    snprintf(path, sizeof(path), "%s/%d/fd", proc_root, proc->pid);
+
+    DIR *dir = opendir(path);
+    if (!dir) return false;
+
+    int count = 0;
+    struct dirent *entry;
+    while ((entry = readdir(dir)) != NULL) {
+        if (entry->d_name[0] != '.') count++;
+    }
+
+    closedir(dir);
+    proc->fd_count = count;
+    return true;
+}
+
+unsigned int process_fetch_details(ProcessStats *proc, const char *proc_root,
+                                   unsigned int mask, unsigned long long now_ns) {
+    if (!proc || !proc_root) return 0;
+
+    for (int detail = 0; detail < PROCESS_DETAIL_COUNT; detail++) {
+        unsigned int bit = PROCESS_DETAIL_MASK(detail);
+        if (!(mask & bit)) continue;
+
+        // Unreadable fields are retried on the same schedule as readable ones
+        if (proc->detail_ns[detail] && now_ns - proc->detail_ns[detail] < detail_ttl_ns[detail]) {
+            continue;
+        }
+
+        bool ok = false;
+        switch ((ProcessDetail)detail) {
+            case PROCESS_DETAIL_MEMORY: ok = fetch_memory(proc, proc_root); break;
+            case PROCESS_DETAIL_IO:     ok = fetch_io(proc, proc_root); break;
+            case PROCESS_DETAIL_FDS:    ok = fetch_fds(proc, proc_root); break;
+            case PROCESS_DETAIL_COUNT:  break;
+        }
+
+        proc->detail_ns[detail] = now_ns ? now_ns : 1;
+        if (ok) {
+            proc->detail_valid |= bit;
+        } else {
+            proc->detail_valid &= ~bit;
+        }
+    }
+
+    return proc->detail_valid & mask;
+}
@@ -0,0 +1,65 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "procfile.h"
+#include <stdlib.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+ssize_t procfile_read(const char *path, char **buffer, size_t *capacity) {
+    if (!path || !buffer || !capacity) return -1;
+
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return -1;
+
+    size_t length = 0;
+    for (;;) {
+        if (*capacity - length < 4096) {
+            size_t grown = *capacity ? *capacity * 2 : 16384;
+            char *text = realloc(*buffer, grown);
+            if (!text) {
+                close(fd);
+                return -1;
+            }
+            *buffer = text;
+            *capacity = grown;
+        }
+
+        ssize_t n = read(fd, *buffer + length, *capacity - length - 1);
+        if (n < 0) {
+            close(fd);
+            return -1;
+        }
+        if (n == 0) break;
+        length += n;
+    }
+
+    close(fd);
+    (*buffer)[length] = '\0';
+    return (ssize_t)length;
+}
+
+ssize_t procfile_pread(int fd, char **buffer, size_t *capacity) {
+    if (fd < 0 || !buffer || !capacity) return -1;
+
+    for (;;) {
+        if (*capacity < 4096) {
+            char *text = realloc(*buffer, 16384);
+            if (!text) return -1;
+            *buffer = text;
+            *capacity = 16384;
+        }
+
+        ssize_t n = pread(fd, *buffer, *capacity - 1, 0);
+        if (n < 0) return -1;
+
+        // A full buffer may have cut the file short; grow and read again
+        if ((size_t)n < *capacity - 1) {
+            (*buffer)[n] = '\0';
+            return n;
+        }
+        char *text = realloc(*buffer, *capacity * 2);
+        if (!text) return -1;
+        *buffer = text;
+        *capacity *= 2;
+    }
+}
@@ -0,0 +1,546 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "query.h"
+#include <stdlib.h>
+#include <string.h>
+#include <ctype.h>
+#include <errno.h>
+#include <math.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+
+#define NS_PER_SEC 1000000000ULL
+
+// Running aggregate of one column within one group
+typedef struct {
+    unsigned long long count;             // May trail the group's when a ring lacks the column
+    double sum;
+    float min;
+    float max;
+    float *values;                        // Kept only when a percentile is asked for
+    size_t size;
+    size_t capacity;
+} QueryCell;
+
+typedef struct {
+    unsigned long long count;
+    unsigned long long first_ns;          // Earliest sample, labels an unbucketed group
+} QueryGroup;
+
+// Where the spec's metrics sit in one ring, -1 when not recorded there
+typedef struct {
+    int columns[RECORDER_MAX_COLUMNS];
+    int conditions[QUERY_MAX_CONDITIONS];
+} QueryLayout;
+
+// Recorded metric by name, -1 if unknown or not recorded
+static int recorded_metric(const char *name) {
+    const MetricDesc *metric = metric_find(name);
+    if (!metric || !(metric->flags & METRIC_RECORDED)) return -1;
+    return (int)(metric - metric_table);
+}
+
+static unsigned long long clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (unsigned long long)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+bool query_parse_columns(QuerySpec *spec, const char *list) {
+    if (!spec || !list || !*list) return false;
+
+    const char *start = list;
+    while (*start) {
+        const char *end = strchr(start, ',');
+        size_t length = end ? (size_t)(end - start) : strlen(start);
+        char name[32];
+        if (length == 0 || length >= sizeof(name) || spec->column_count >= RECORDER_MAX_COLUMNS) return false;
+
+        memcpy(name, start, length);
+        name[length] = '\0';
+        int metric = recorded_metric(name);
+        if (metric < 0) return false;
+        spec->columns[spec->column_count++] = metric;
+
+        start += length;
+        if (*start == ',') start++;
+    }
+    return true;
+}
+
+bool query_parse_aggregates(QuerySpec *spec, const char *list) {
+    if (!spec || !list || !*list) return false;
+
+    const char *start = list;
+    while (*start) {
+        const char *end = strchr(start, ',');
+        size_t length = end ? (size_t)(end - start) : strlen(start);
+        char name[16];
+        if (length == 0 || length >= sizeof(name) || spec->aggregate_count >= QUERY_MAX_AGGREGATES) return false;
+
+        memcpy(name, start, length);
+        name[length] = '\0';
+        QueryAggregate *aggregate = &spec->aggregates[spec->aggregate_count];
+        if (strcmp(name, "min") == 0) {
+            aggregate->function = QUERY_MIN;
+        } else if (strcmp(name, "max") == 0) {
+            aggregate->function = QUERY_MAX;
+        } else if (strcmp(name, "avg") == 0) {
+            aggregate->function = QUERY_AVG;
+        } else if (name[0] == 'p' && name[1]) {
+            char *rest;
+            aggregate->function = QUERY_PERCENTILE;
+            aggregate->percentile = strtod(name + 1, &rest);
+            if (*rest || aggregate->percentile < 0.0 || aggregate->percentile > 100.0) return false;
+        } else {
+            return false;
+        }
+        spec->aggregate_count++;
+
+        start += length;
+        if (*start == ',') start++;
+    }
+    return true;
+}
+
+bool query_parse_condition(QuerySpec *spec, const char *text) {
+    if (!spec || !text || spec->condition_count >= QUERY_MAX_CONDITIONS) return false;
+
+    size_t length = 0;
+    while (isalnum((unsigned char)text[length]) || text[length] == '_' || text[length] == '.') length++;
+
+    char name[32];
+    if (length == 0 || length >= sizeof(name)) return false;
+    memcpy(name, text, length);
+    name[length] = '\0';
+
+    QueryCondition *condition = &spec->conditions[spec->condition_count];
+    condition->metric = recorded_metric(name);
+    if (condition->metric < 0) return false;
+
+    const char *op = text + length;
+    if (op[0] == '<') {
+        condition->op = op[1] == '=' ? QUERY_LESS_EQUAL : QUERY_LESS;
+    } else if (op[0] == '>') {
+        condition->op = op[1] == '=' ? QUERY_GREATER_EQUAL : QUERY_GREATER;
+    } else {
+        return false;
+    }
+
+    const char *number = op + (op[1] == '=' ? 2 : 1);
+    char *rest;
+    condition->value = strtod(number, &rest);
+    if (rest == number || *rest) return false;
+
+    spec->condition_count++;
+    return true;
+}
+
+// Clock time "HH:MM[:SS]", the whole of text
+static bool parse_clock(const char *text, struct tm *tm) {
+    int hour, minute, second = 0, used = 0;
+
+    if (sscanf(text, "%2d:%2d%n", &hour, &minute, &used) != 2) return false;
+    if (text[used] == ':') {
+        int more = 0;
+        if (sscanf(text + used + 1, "%2d%n", &second, &more) != 1) return false;
+        used += 1 + more;
+    }
+    if (text[used] || hour > 23 || minute > 59 || second > 60 || hour < 0 || minute < 0 || second < 0) return false;
+
+    tm->tm_hour = hour;
+    tm->tm_min = minute;
+    tm->tm_sec = second;
+    return true;
+}
+
+bool query_parse_time(const char *text, unsigned long long now_ns, unsigned long long *wall_ns) {
+    if (!text || !wall_ns) return false;
+
+    if (text[0] == '-') {
+        unsigned long long ago;
+        if (!sysmon_parse_duration(text + 1, &ago) || ago > now_ns) return false;
+        *wall_ns = now_ns - ago;
+        return true;
+    }
+    if (text[0] == '@') {
+        char *rest;
+        unsigned long long seconds = strtoull(text + 1, &rest, 10);
+        if (rest == text + 1 || *rest) return false;
+        *wall_ns = seconds * NS_PER_SEC;
+        return true;
+    }
+
+    time_t now = (time_t)(now_ns / NS_PER_SEC);
+    struct tm tm;
+    if (!localtime_r(&now, &tm)) return false;
+
+    int year, month, day, used = 0;
+    if (sscanf(text, "%4d-%2d-%2d%n", &year, &month, &day, &used) == 3) {
+        if (month < 1 || month > 12 || day < 1 || day > 31) return false;
+        tm.tm_year = year - 1900;
+        tm.tm_mon = month - 1;
+        tm.tm_mday = day;
+        tm.tm_hour = tm.tm_min = tm.tm_sec = 0;
+        if (text[used] == ' ' || text[used] == 'T') {
+            if (!parse_clock(text + used + 1, &tm)) return false;
+        } else if (text[used]) {
+            return false;
+        }
+    } else if (!parse_clock(text, &tm)) {
+        return false;
+    }
+
+    tm.tm_isdst = -1;
+    time_t wall = mktime(&tm);
+    if (wall == (time_t)-1) return false;
+    *wall_ns = (unsigned long long)wall * NS_PER_SEC;
+    return true;
+}
+
+// Offset of local time from UTC at wall, in seconds
+static long long local_offset(time_t wall) {
+    struct tm utc;
+    if (!gmtime_r(&wall, &utc)) return 0;
+    utc.tm_isdst = -1;
+    time_t as_local = mktime(&utc);
+    return as_local == (time_t)-1 ? 0 : (long long)(wall - as_local);
+}
+
+static bool holds(const QueryCondition *condition, float value) {
+    switch (condition->op) {
+        case QUERY_LESS:          return value < condition->value;
+        case QUERY_LESS_EQUAL:    return value <= condition->value;
+        case QUERY_GREATER:       return value > condition->value;
+        case QUERY_GREATER_EQUAL: return value >= condition->value;
+    }
+    return false;
+}
+
+// Whether any value within a block's bounds of a column can satisfy the condition
+static bool may_hold(const QueryCondition *condition, const RecorderBlock *block, int column) {
+    switch (condition->op) {
+        case QUERY_LESS:          return block->min[column] < condition->value;
+        case QUERY_LESS_EQUAL:    return block->min[column] <= condition->value;
+        case QUERY_GREATER:       return block->max[column] > condition->value;
+        case QUERY_GREATER_EQUAL: return block->max[column] >= condition->value;
+    }
+    return true;
+}
+
+static bool block_relevant(const QuerySpec *spec, const QueryLayout *layout, const RecorderBlock *block,
+                           unsigned long long from_ns, unsigned long long to_ns) {
+    if (block->first_ns == 0 || block->last_ns < from_ns || block->first_ns >= to_ns) return false;
+
+    for (int i = 0; i < spec->condition_count; i++) {
+        int column = layout->conditions[i];
+        if (column < 0 || !may_hold(&spec->conditions[i], block, column)) return false;
+    }
+    return true;
+}
+
+static void layout_view(const QuerySpec *spec, const RecorderView *view, QueryLayout *layout) {
+    for (int c = 0; c < spec->column_count; c++) {
+        layout->columns[c] = recorder_view_column(view, metric_table[spec->columns[c]].name);
+    }
+    for (int i = 0; i < spec->condition_count; i++) {
+        layout->conditions[i] = recorder_view_column(view, metric_table[spec->conditions[i].metric].name);
+    }
+}
+
+static bool cell_push(QueryCell *cell, float value) {
+    if (cell->size == cell->capacity) {
+        size_t capacity = cell->capacity ? cell->capacity * 2 : 1024;
+        float *values = realloc(cell->values, capacity * sizeof(float));
+        if (!values) return false;
+        cell->values = values;
+        cell->capacity = capacity;
+    }
+    cell->values[cell->size++] = value;
+    return true;
+}
+
+// k-th smallest of values, reordering them (Hoare quickselect)
+static float select_kth(float *values, size_t count, size_t k) {
+    ptrdiff_t low = 0, high = (ptrdiff_t)count - 1;
+
+    while (low < high) {
+        float pivot = values[low + (high - low) / 2];
+        ptrdiff_t i = low, j = high;
+        while (i <= j) {
+            while (values[i] < pivot) i++;
+            while (values[j] > pivot) j--;
+            if (i <= j) {
+                float swap = values[i];
+                values[i++] = values[j];
+                values[j--] = swap;
+            }
+        }
+        if ((ptrdiff_t)k <= j) {
+            high = j;
+        } else if ((ptrdiff_t)k >= i) {
+            low = i;
+        } else {
+            break;
+        }
+    }
+    return values[k];
+}
+
+static double cell_result(QueryCell *cell, const QueryAggregate *aggregate) {
+    switch (aggregate->function) {
+        case QUERY_MIN: return cell->min;
+        case QUERY_MAX: return cell->max;
+        case QUERY_AVG: return cell->sum / cell->count;
+        case QUERY_PERCENTILE: {
+            size_t rank = (size_t)ceil(aggregate->percentile / 100.0 * cell->size);
+            return select_kth(cell->values, cell->size, rank > 0 ? rank - 1 : 0);
+        }
+    }
+    return 0.0;
+}
+
+static void aggregate_name(const QueryAggregate *aggregate, char *buffer, size_t buffer_size) {
+    switch (aggregate->function) {
+        case QUERY_MIN: snprintf(buffer, buffer_size, "min"); break;
+        case QUERY_MAX: snprintf(buffer, buffer_size, "max"); break;
+        case QUERY_AVG: snprintf(buffer, buffer_size, "avg"); break;
+        case QUERY_PERCENTILE: snprintf(buffer, buffer_size, "p%g", aggregate->percentile); break;
+    }
+}
+
+static void format_time(unsigned long long wall_ns, char *buffer, size_t buffer_size) {
+    time_t seconds = (time_t)(wall_ns / NS_PER_SEC);
+    struct tm local;
+
+    if (!localtime_r(&seconds, &local) || strftime(buffer, buffer_size, "%Y-%m-%d %H:%M:%S", &local) == 0) {
+        snprintf(buffer, buffer_size, "?");
+    }
+}
+
+static void print_results(const QuerySpec *spec, const QueryGroup *groups, QueryCell *cells, size_t group_count,
+                          unsigned long long start_ns, FILE *out) {
+    char name[64];
+    int width[RECORDER_MAX_COLUMNS * QUERY_MAX_AGGREGATES];
+
+    fprintf(out, spec->csv ? "time,samples" : "%-19s %9s", "time", "samples");
+    for (int c = 0; c < spec->column_count; c++) {
+        for (int a = 0; a < spec->aggregate_count; a++) {
+            char function[16];
+            aggregate_name(&spec->aggregates[a], function, sizeof(function));
+            int length = snprintf(name, sizeof(name), spec->csv ? "%s_%s" : "%s.%s",
+                                  metric_table[spec->columns[c]].name, function);
+            width[c * spec->aggregate_count + a] = length > 12 ? length : 12;
+            if (spec->csv) {
+                fprintf(out, ",%s", name);
+            } else {
+                fprintf(out, " %*s", width[c * spec->aggregate_count + a], name);
+            }
+        }
+    }
+    fputc('\n', out);
+
+    for (size_t g = 0; g < group_count; g++) {
+        if (groups[g].count == 0) continue;
+
+        char stamp[32];
+        format_time(spec->bucket_ns ? start_ns + g * spec->bucket_ns : groups[g].first_ns, stamp, sizeof(stamp));
+        fprintf(out, spec->csv ? "%s,%llu" : "%-19s %9llu", stamp, groups[g].count);
+
+        for (int c = 0; c < spec->column_count; c++) {
+            QueryCell *cell = &cells[g * spec->column_count + c];
+            for (int a = 0; a < spec->aggregate_count; a++) {
+                int column_width = width[c * spec->aggregate_count + a];
+                if (cell->count == 0 && spec->csv) {
+                    fputc(',', out);
+                } else if (cell->count == 0) {
+                    fprintf(out, " %*s", column_width, "-");
+                } else if (spec->csv) {
+                    fprintf(out, ",%.3f", cell_result(cell, &spec->aggregates[a]));
+                } else {
+                    fprintf(out, " %*.1f", column_width, cell_result(cell, &spec->aggregates[a]));
+                }
+            }
+        }
+        fputc('\n', out);
+    }
+}
+
+// Groups and cells of one query run, and the range they cover
+typedef struct {
+    QueryGroup *groups;
+    QueryCell *cells;                     // group_count x column_count
+    size_t group_count;
+    unsigned long long start_ns;          // Start of the first bucket
+    unsigned long long from_ns;
+    unsigned long long to_ns;
+    bool keep_values;
+} QueryState;
+
+static void free_state(QueryState *state, int column_count) {
+    if (state->cells) {
+        for (size_t i = 0; i < state->group_count * column_count; i++) {
+            free(state->cells[i].values);
+        }
+    }
+    free(state->cells);
+    free(state->groups);
+}
+
+// Close the open ends of the range on the recorded data, from the indexes
+// alone, and lay out the groups. Returns false with errno set.
+static bool plan_groups(const QuerySpec *spec, const RecorderView *views, const QueryLayout *layouts,
+                        int view_count, QueryState *state) {
+    unsigned long long from_ns = spec->from_ns, to_ns = spec->to_ns ? spec->to_ns : ~0ULL;
+    unsigned long long first_ns = ~0ULL, last_ns = 0;
+
+    for (int f = 0; f < view_count; f++) {
+        const RecorderHeader *header = views[f].header;
+        for (uint32_t b = 0; b < header->block_count; b++) {
+            const RecorderBlock *block = &header->blocks[b];
+            if (!block_relevant(spec, &layouts[f], block, from_ns, to_ns)) continue;
+            if (block->first_ns < first_ns) first_ns = block->first_ns;
+            if (block->last_ns > last_ns) last_ns = block->last_ns;
+        }
+    }
+    if (first_ns > from_ns) from_ns = first_ns;
+    if (last_ns < to_ns) to_ns = last_ns + 1;
+
+    state->from_ns = from_ns;
+    state->to_ns = to_ns;
+    state->start_ns = from_ns;
+    state->group_count = 0;
+    if (from_ns < to_ns) {
+        state->group_count = 1;
+        if (spec->bucket_ns) {
+            // Buckets fall on local clock multiples: hours on the hour, days at midnight
+            long long offset = local_offset((time_t)(from_ns / NS_PER_SEC)) * (long long)NS_PER_SEC;
+            long long shifted = (long long)from_ns + offset;
+            state->start_ns = (unsigned long long)(shifted - shifted % (long long)spec->bucket_ns - offset);
+            unsigned long long buckets = (to_ns - state->start_ns + spec->bucket_ns - 1) / spec->bucket_ns;
+            if (buckets > QUERY_MAX_BUCKETS) {
+                errno = E2BIG;
+                return false;
+            }
+            state->group_count = (size_t)buckets;
+        }
+    }
+
+    for (int a = 0; a < spec->aggregate_count; a++) {
+        if (spec->aggregates[a].function == QUERY_PERCENTILE) state->keep_values = true;
+    }
+
+    size_t groups = state->group_count ? state->group_count : 1;
+    size_t columns = spec->column_count ? (size_t)spec->column_count : 1;
+    state->groups = calloc(groups, sizeof(QueryGroup));
+    state->cells = calloc(groups * columns, sizeof(QueryCell));
+    return state->groups && state->cells;
+}
+
+// Fold the matching samples of one ring into the groups. Returns false
+// when out of memory.
+static bool scan_view(const QuerySpec *spec, const RecorderView *view, const QueryLayout *layout,
+                      QueryState *state, QueryStats *stats) {
+    const RecorderHeader *header = view->header;
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    stats->blocks += header->block_count;
+
+    for (uint32_t b = 0; b < header->block_count; b++) {
+        if (!block_relevant(spec, layout, &header->blocks[b], state->from_ns, state->to_ns)) continue;
+        stats->blocks_read++;
+
+        uint32_t first = b * header->block_slots;
+        uint32_t end = first + header->block_slots < header->slot_count ? first + header->block_slots
+                                                                         : header->slot_count;
+
+        // Start reading the whole block in while the first slots are checked
+        const unsigned char *base = (const unsigned char *)recorder_view_slot(view, first);
+        size_t skew = (size_t)(base - view->map) % page;
+        posix_madvise((void *)(base - skew), (size_t)(end - first) * RECORDER_SLOT_SIZE + skew,
+                      POSIX_MADV_WILLNEED);
+
+        for (uint32_t i = first; i < end; i++) {
+            const RecorderSlot *slot = recorder_view_slot(view, i);
+            if (slot->seq == 0 || !recorder_slot_intact(slot)) continue;
+            stats->samples++;
+            if (slot->wall_ns < state->from_ns || slot->wall_ns >= state->to_ns) continue;
+
+            bool match = true;
+            for (int k = 0; k < spec->condition_count && match; k++) {
+                match = holds(&spec->conditions[k], slot->values[layout->conditions[k]]);
+            }
+            if (!match) continue;
+            stats->matched++;
+
+            size_t g = spec->bucket_ns ? (size_t)((slot->wall_ns - state->start_ns) / spec->bucket_ns) : 0;
+            QueryGroup *group = &state->groups[g];
+            if (group->count == 0 || slot->wall_ns < group->first_ns) group->first_ns = slot->wall_ns;
+
+            // Only the requested columns are read out of the slot
+            QueryCell *row = &state->cells[g * spec->column_count];
+            for (int c = 0; c < spec->column_count; c++) {
+                if (layout->columns[c] < 0) continue;
+                float value = slot->values[layout->columns[c]];
+                if (isnan(value)) continue; // Unavailable in this sample
+                QueryCell *cell = &row[c];
+                if (cell->count == 0 || value < cell->min) cell->min = value;
+                if (cell->count == 0 || value > cell->max) cell->max = value;
+                cell->sum += value;
+                cell->count++;
+                if (state->keep_values && !cell_push(cell, value)) return false;
+            }
+            group->count++;
+        }
+    }
+    return true;
+}
+
+int query_run(const QuerySpec *spec, const char *const *paths, int path_count, FILE *out, QueryStats *stats) {
+    if (!spec || !paths || path_count <= 0 || !out || !stats) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(stats, 0, sizeof(QueryStats));
+    unsigned long long started = clock_ns(CLOCK_MONOTONIC);
+
+    RecorderView *views = calloc((size_t)path_count, sizeof(RecorderView));
+    QueryLayout *layouts = calloc((size_t)path_count, sizeof(QueryLayout));
+    if (!views || !layouts) {
+        free(views);
+        free(layouts);
+        return -1;
+    }
+
+    int result = 0;
+    for (int f = 0; f < path_count && result == 0; f++) {
+        if (recorder_view_open(&views[f], paths[f]) != 0) {
+            stats->failed_path = paths[f];
+            result = -1;
+        } else {
+            layout_view(spec, &views[f], &layouts[f]);
+            stats->files++;
+        }
+    }
+
+    QueryState state;
+    memset(&state, 0, sizeof(state));
+    if (result == 0 && !plan_groups(spec, views, layouts, path_count, &state)) result = -1;
+
+    for (int f = 0; f < path_count && result == 0 && state.group_count > 0; f++) {
+        if (!scan_view(spec, &views[f], &layouts[f], &state, stats)) result = -1;
+    }
+
+    if (result == 0) {
+        print_results(spec, state.groups, state.cells, state.group_count, state.start_ns, out);
+        stats->elapsed_ns = clock_ns(CLOCK_MONOTONIC) - started;
+    }
+
+    free_state(&state, spec->column_count);
+    for (int f = 0; f < path_count; f++) {
+        recorder_view_close(&views[f]);
+    }
+    free(views);
+    free(layouts);
+    return result;
+}
@@ -0,0 +1,515 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "recorder.h"
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+
+#define NS_PER_SEC 1000000000ULL
+
+// A sample must fit its slot, and the header with its index the header pages
+typedef char recorder_slot_fits[sizeof(RecorderSlot) <= RECORDER_SLOT_SIZE ? 1 : -1];
+typedef char recorder_header_fits[sizeof(RecorderHeader) <= RECORDER_HEADER_SIZE ? 1 : -1];
+typedef char recorder_slot_words[RECORDER_SLOT_SIZE % (4 * sizeof(uint64_t)) == 0 ? 1 : -1];
+
+typedef char recorder_columns_fit[RECORDER_COLUMN_COUNT <= RECORDER_MAX_COLUMNS ? 1 : -1];
+typedef char recorder_anomaly_bits[RECORDER_MAX_COLUMNS <= 32 && RECORDER_DEVICES <= 8 ? 1 : -1];
+
+static unsigned long long clock_ns(clockid_t clock) {
+    struct timespec ts;
+    clock_gettime(clock, &ts);
+    return (unsigned long long)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+static RecorderSlot* slot_at(unsigned char *map, uint32_t index) {
+    return (RecorderSlot *)(map + RECORDER_HEADER_SIZE + (size_t)index * RECORDER_SLOT_SIZE);
+}
+
+// FNV-1a over the slot's words in four interleaved lanes, folded at the
+// end, reading the checksum field as zero. Every step is a bijection of its
+// lane, so any one changed word changes the result; the lanes keep the
+// multiplies independent, so a full scan of a large ring stays cheap.
+static uint64_t slot_checksum(const RecorderSlot *slot) {
+    const unsigned char *bytes = (const unsigned char *)slot;
+    const size_t skip = offsetof(RecorderSlot, checksum);
+    const uint64_t prime = 1099511628211ULL;
+    uint64_t lanes[4] = { 14695981039346656037ULL, 14695981039346656037ULL,
+                          14695981039346656037ULL, 14695981039346656037ULL };
+
+    for (size_t i = 0; i < RECORDER_SLOT_SIZE; i += 4 * sizeof(uint64_t)) {
+        for (size_t lane = 0; lane < 4; lane++) {
+            size_t offset = i + lane * sizeof(uint64_t);
+            uint64_t word = 0;
+            if (offset != skip) memcpy(&word, bytes + offset, sizeof(word));
+            lanes[lane] = (lanes[lane] ^ word) * prime;
+        }
+    }
+    return (((lanes[0] * prime) ^ lanes[1]) * prime ^ lanes[2]) * prime ^ lanes[3];
+}
+
+bool recorder_slot_intact(const RecorderSlot *slot) {
+    return slot->seq != 0 && slot->checksum == slot_checksum(slot);
+}
+
+static bool header_valid(const RecorderHeader *header, off_t file_size) {
+    return memcmp(header->magic, RECORDER_MAGIC, sizeof(header->magic)) == 0 &&
+           header->version == RECORDER_VERSION &&
+           header->header_size == RECORDER_HEADER_SIZE &&
+           header->slot_size == RECORDER_SLOT_SIZE &&
+           header->slot_count >= RECORDER_MIN_SLOTS &&
+           header->block_slots > 0 && header->block_count <= RECORDER_BLOCKS &&
+           header->column_count <= RECORDER_MAX_COLUMNS &&
+           (uint64_t)header->block_slots * header->block_count >= header->slot_count &&
+           file_size == (off_t)(RECORDER_HEADER_SIZE + (off_t)header->slot_count * RECORDER_SLOT_SIZE);
+}
+
+// Write back the slots stored since the last sync, page aligned
+static void sync_slots(Recorder *rec, uint32_t first, uint32_t count) {
+    size_t page = (size_t)sysconf(_SC_PAGESIZE);
+    size_t start = RECORDER_HEADER_SIZE + (size_t)first * RECORDER_SLOT_SIZE;
+    size_t end = start + (size_t)count * RECORDER_SLOT_SIZE;
+
+    start -= start % page;
+    msync(rec->map + start, end - start, MS_SYNC);
+}
+
+static void sync_dirty(Recorder *rec) {
+    if (rec->dirty_count == 0) return;
+
+    uint32_t first = rec->dirty_first;
+    uint32_t count = rec->dirty_count;
+    if (first + count > rec->slot_count) {
+        sync_slots(rec, 0, first + count - rec->slot_count);
+        count = rec->slot_count - first;
+    }
+    sync_slots(rec, first, count);
+    msync(rec->map, RECORDER_HEADER_SIZE, MS_SYNC);
+    rec->dirty_count = 0;
+}
+
+// Extend the dirty range, which starts at dirty_first, to cover count
+// slots from index
+static void mark_dirty(Recorder *rec, uint32_t index, uint32_t count) {
+    if (rec->dirty_count == 0) {
+        rec->dirty_first = index;
+        rec->dirty_count = count;
+        return;
+    }
+
+    uint64_t end = (uint64_t)(index + rec->slot_count - rec->dirty_first) % rec->slot_count + count;
+    if (end > rec->slot_count) end = rec->slot_count;
+    if (end > rec->dirty_count) rec->dirty_count = (uint32_t)end;
+}
+
+// Ring column of every metric this build records, by name
+static void map_columns(Recorder *rec, const RecorderHeader *header) {
+    int column = 0;
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        if (!(metric_table[i].flags & METRIC_RECORDED)) continue;
+
+        rec->columns[column] = -1;
+        for (uint32_t c = 0; c < header->column_count; c++) {
+            if (strncmp(header->columns[c], metric_table[i].name, RECORDER_COLUMN_NAME) == 0) {
+                rec->columns[column] = (int)c;
+                break;
+            }
+        }
+        if (rec->columns[column] < 0) rec->missing++;
+        column++;
+    }
+}
+
+int recorder_open(Recorder *rec, const char *path, unsigned long long size,
+                  unsigned long long interval_ns, unsigned long long sync_ns) {
+    if (!rec || !path) return -1;
+
+    memset(rec, 0, sizeof(Recorder));
+    rec->fd = -1;
+    rec->sync_ns = sync_ns;
+
+    unsigned long long slots = size > RECORDER_HEADER_SIZE ? (size - RECORDER_HEADER_SIZE) / RECORDER_SLOT_SIZE : 0;
+    if (slots < RECORDER_MIN_SLOTS || slots > UINT32_MAX) return -1;
+
+    int fd = open(path, O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    RecorderHeader header;
+    bool existing = false;
+    if (fstat(fd, &st) != 0) {
+        close(fd);
+        return -1;
+    }
+
+    // Never overwrite a file that is not a ring: it may be anything
+    if (st.st_size > 0) {
+        if (pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) || !header_valid(&header, st.st_size)) {
+            close(fd);
+            errno = EEXIST;
+            return -1;
+        }
+        existing = true;
+        rec->slot_count = header.slot_count;
+        rec->block_slots = header.block_slots;
+    } else {
+        // Preallocate, so stores into the map can never fault on a full disk
+        rec->slot_count = (uint32_t)slots;
+        uint32_t per_block = (rec->slot_count + RECORDER_BLOCKS - 1) / RECORDER_BLOCKS;
+        rec->block_slots = (per_block + RECORDER_BLOCK_ALIGN - 1) / RECORDER_BLOCK_ALIGN * RECORDER_BLOCK_ALIGN;
+        int err = posix_fallocate(fd, 0, RECORDER_HEADER_SIZE + (off_t)slots * RECORDER_SLOT_SIZE);
+        if (err != 0) {
+            int truncated = ftruncate(fd, 0);
+            (void)truncated;
+            close(fd);
+            errno = err;
+            return -1;
+        }
+    }
+
+    rec->map_size = RECORDER_HEADER_SIZE + (size_t)rec->slot_count * RECORDER_SLOT_SIZE;
+    void *map = mmap(NULL, rec->map_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (map == MAP_FAILED) {
+        close(fd);
+        return -1;
+    }
+    rec->map = map;
+    rec->fd = fd;
+
+    if (existing) {
+        map_columns(rec, (const RecorderHeader *)rec->map);
+
+        // Continue after the newest intact sample
+        for (uint32_t i = 0; i < rec->slot_count; i++) {
+            const RecorderSlot *slot = slot_at(rec->map, i);
+            if (slot->seq > rec->seq && recorder_slot_intact(slot)) {
+                rec->seq = slot->seq;
+            }
+        }
+    } else {
+        RecorderHeader *fresh = (RecorderHeader *)rec->map;
+        memcpy(fresh->magic, RECORDER_MAGIC, sizeof(fresh->magic));
+        fresh->version = RECORDER_VERSION;
+        fresh->header_size = RECORDER_HEADER_SIZE;
+        fresh->slot_size = RECORDER_SLOT_SIZE;
+        fresh->slot_count = rec->slot_count;
+        fresh->block_slots = rec->block_slots;
+        fresh->block_count = (rec->slot_count + rec->block_slots - 1) / rec->block_slots;
+        fresh->created_ns = clock_ns(CLOCK_REALTIME);
+        fresh->interval_ns = interval_ns;
+        gethostname(fresh->hostname, sizeof(fresh->hostname) - 1);
+        for (int i = 0; i < METRIC_COUNT; i++) {
+            if (!(metric_table[i].flags & METRIC_RECORDED)) continue;
+            rec->columns[fresh->column_count] = (int)fresh->column_count;
+            strncpy(fresh->columns[fresh->column_count++], metric_table[i].name, RECORDER_COLUMN_NAME - 1);
+        }
+        msync(rec->map, RECORDER_HEADER_SIZE, MS_SYNC);
+    }
+
+    rec->last_sync_ns = clock_ns(CLOCK_MONOTONIC);
+    return 0;
+}
+
+void recorder_close(Recorder *rec) {
+    if (!rec || !rec->map) return;
+
+    sync_dirty(rec);
+    munmap(rec->map, rec->map_size);
+    close(rec->fd);
+    rec->map = NULL;
+    rec->fd = -1;
+}
+
+// Insert index into the first `count` of best[], ordered by value descending
+static int rank_insert(int *best, double *values, int count, int index, double value) {
+    int k = count < RECORDER_DEVICES ? count : RECORDER_DEVICES - 1;
+    if (count >= RECORDER_DEVICES && value <= values[k]) return count;
+
+    while (k > 0 && values[k - 1] < value) {
+        best[k] = best[k - 1];
+        values[k] = values[k - 1];
+        k--;
+    }
+    best[k] = index;
+    values[k] = value;
+    return count < RECORDER_DEVICES ? count + 1 : count;
+}
+
+static void copy_name(RecorderDevice *device, const char *name) {
+    strncpy(device->name, name, sizeof(device->name) - 1);
+}
+
+void recorder_write(Recorder *rec, const SystemMonitor *mon) {
+    if (!rec || !rec->map || !mon) return;
+
+    RecorderSlot sample;
+    memset(&sample, 0, sizeof(sample));
+    sample.wall_ns = clock_ns(CLOCK_REALTIME);
+    sample.mono_ns = mon->sample_ns;
+
+    // Unavailable is not zero: NAN keeps it out of bounds and aggregates.
+    // Ring columns this build does not record stay NAN too.
+    const RecorderHeader *header = (const RecorderHeader *)rec->map;
+    for (uint32_t c = 0; c < header->column_count; c++) {
+        sample.values[c] = NAN;
+    }
+    int column = 0;
+    for (int i = 0; i < METRIC_COUNT; i++) {
+        const MetricDesc *metric = &metric_table[i];
+        if (!(metric->flags & METRIC_RECORDED)) continue;
+        int target = rec->columns[column++];
+        if (target >= 0 && metric_available(mon, metric)) {
+            sample.values[target] = (float)metric_value(mon, metric, NULL);
+            if (metric_anomalous(mon, metric, -1)) sample.anomalies |= 1u << target;
+        }
+    }
+
+    // Fullest disks and busiest interfaces, when there are more than fit
+    int best[RECORDER_DEVICES];
+    double values[RECORDER_DEVICES];
+    int count = 0;
+    for (int row = 0; row < mon->disk_count; row++) {
+        const DiskStats *disk = sysmon_get_disk(mon, row);
+        if (disk && disk->valid) count = rank_insert(best, values, count, row, disk->usage_percent);
+    }
+    for (int k = 0; k < count; k++) {
+        const DiskStats *disk = sysmon_get_disk(mon, best[k]);
+        copy_name(&sample.disks[k], disk->mount_point);
+        sample.disks[k].value[0] = disk->usage_percent;
+        if (metric_entry_anomalous(mon, METRIC_GROUP_DISK, best[k])) {
+            sample.device_anomalies |= (uint16_t)(1u << k);
+        }
+    }
+    sample.disk_count = (uint8_t)count;
+
+    count = 0;
+    for (int row = 0; row < mon->interface_count; row++) {
+        const NetworkStats *net = sysmon_get_interface(mon, row);
+        if (net && net->valid) count = rank_insert(best, values, count, row, net->rx_rate_mbps + net->tx_rate_mbps);
+    }
+    for (int k = 0; k < count; k++) {
+        const NetworkStats *net = sysmon_get_interface(mon, best[k]);
+        copy_name(&sample.interfaces[k], net->interface_name);
+        sample.interfaces[k].value[0] = (float)net->rx_rate_mbps;
+        sample.interfaces[k].value[1] = (float)net->tx_rate_mbps;
+        if (metric_entry_anomalous(mon, METRIC_GROUP_NETWORK, best[k])) {
+            sample.device_anomalies |= (uint16_t)(1u << (RECORDER_DEVICES + k));
+        }
+    }
+    sample.interface_count = (uint8_t)count;
+
+    recorder_append(rec, &sample);
+}
+
+void recorder_append(Recorder *rec, const RecorderSlot *sample) {
+    if (!rec || !rec->map || !sample) return;
+
+    RecorderHeader *header = (RecorderHeader *)rec->map;
+    uint32_t index = (uint32_t)(rec->seq % rec->slot_count);
+    RecorderBlock *block = &header->blocks[index / rec->block_slots];
+
+    // Entering a block recycles it whole: clear its slots before its entry,
+    // so the entry never describes less than the block holds
+    if (index % rec->block_slots == 0) {
+        uint32_t count = rec->slot_count - index < rec->block_slots ? rec->slot_count - index : rec->block_slots;
+        memset(slot_at(rec->map, index), 0, (size_t)count * RECORDER_SLOT_SIZE);
+        block->first_ns = 0;
+        mark_dirty(rec, index, count);
+    }
+
+    // Widen the entry before the sample lands
+    if (block->first_ns == 0) {
+        memcpy(block->min, sample->values, sizeof(block->min));
+        memcpy(block->max, sample->values, sizeof(block->max));
+        block->last_ns = sample->wall_ns;
+        block->first_ns = sample->wall_ns;
+    } else {
+        for (int c = 0; c < RECORDER_MAX_COLUMNS; c++) {
+            float value = sample->values[c];
+            if (isnan(value)) continue;
+            if (isnan(block->min[c]) || value < block->min[c]) block->min[c] = value;
+            if (isnan(block->max[c]) || value > block->max[c]) block->max[c] = value;
+        }
+        if (sample->wall_ns < block->first_ns) block->first_ns = sample->wall_ns;
+        if (sample->wall_ns > block->last_ns) block->last_ns = sample->wall_ns;
+    }
+
+    RecorderSlot *slot = slot_at(rec->map, index);
+    memcpy(slot, sample, sizeof(RecorderSlot));
+    slot->seq = ++rec->seq;
+    slot->checksum = slot_checksum(slot);
+    mark_dirty(rec, index, 1);
+
+    if (rec->sync_ns > 0 && sample->mono_ns - rec->last_sync_ns >= rec->sync_ns) {
+        sync_dirty(rec);
+        rec->last_sync_ns = sample->mono_ns;
+    }
+}
+
+int recorder_metric_column(MetricId metric) {
+    if (metric < 0 || metric >= METRIC_COUNT || !(metric_table[metric].flags & METRIC_RECORDED)) return -1;
+
+    int column = 0;
+    for (int i = 0; i < (int)metric; i++) {
+        if (metric_table[i].flags & METRIC_RECORDED) column++;
+    }
+    return column;
+}
+
+int recorder_view_open(RecorderView *view, const char *path) {
+    if (!view || !path) {
+        errno = EINVAL;
+        return -1;
+    }
+    memset(view, 0, sizeof(RecorderView));
+
+    int fd = open(path, O_RDONLY | O_CLOEXEC);
+    if (fd < 0) return -1;
+
+    struct stat st;
+    RecorderHeader header;
+    if (fstat(fd, &st) != 0 || pread(fd, &header, sizeof(header), 0) != (ssize_t)sizeof(header) ||
+        !header_valid(&header, st.st_size)) {
+        close(fd);
+        errno = EINVAL;
+        return -1;
+    }
+
+    void *map = mmap(NULL, (size_t)st.st_size, PROT_READ, MAP_SHARED, fd, 0);
+    close(fd);
+    if (map == MAP_FAILED) return -1;
+
+    view->map = map;
+    view->map_size = (size_t)st.st_size;
+    view->header = (const RecorderHeader *)view->map;
+    return 0;
+}
+
+void recorder_view_close(RecorderView *view) {
+    if (!view || !view->map) return;
+
+    munmap(view->map, view->map_size);
+    view->map = NULL;
+    view->header = NULL;
+}
+
+const RecorderSlot* recorder_view_slot(const RecorderView *view, uint32_t index) {
+    return slot_at(view->map, index);
+}
+
+int recorder_view_column(const RecorderView *view, const char *name) {
+    const RecorderHeader *header = view->header;
+    for (uint32_t c = 0; c < header->column_count; c++) {
+        if (strncmp(header->columns[c], name, RECORDER_COLUMN_NAME) == 0) return (int)c;
+    }
+    return -1;
+}
+
+// Dump width and precision of a column, by the unit of its metric
+static void dump_format(const char *name, int *width, int *precision) {
+    const MetricDesc *metric = metric_find(name);
+    *precision = metric && metric->unit == METRIC_PERCENT ? 1 : 0;
+    *width = (int)strnlen(name, RECORDER_COLUMN_NAME);
+    if (*width < 8) *width = 8;
+}
+
+static int compare_seq(const void *a, const void *b) {
+    uint64_t left = (*(const RecorderSlot * const *)a)->seq;
+    uint64_t right = (*(const RecorderSlot * const *)b)->seq;
+    return (left > right) - (left < right);
+}
+
+static void format_wall(uint64_t wall_ns, char *buffer, size_t buffer_size) {
+    time_t seconds = (time_t)(wall_ns / NS_PER_SEC);
+    struct tm local;
+    char stamp[32] = "?";
+
+    if (localtime_r(&seconds, &local)) {
+        strftime(stamp, sizeof(stamp), "%Y-%m-%d %H:%M:%S", &local);
+    }
+    snprintf(buffer, buffer_size, "%s.%03llu", stamp, (unsigned long long)(wall_ns % NS_PER_SEC / 1000000ULL));
+}
+
+// Values the detectors flagged carry a trailing '*'
+static void dump_slot(const RecorderHeader *header, const RecorderSlot *slot, FILE *out) {
+    char stamp[48];
+    format_wall(slot->wall_ns, stamp, sizeof(stamp));
+
+    fprintf(out, "%s %10llu", stamp, (unsigned long long)slot->seq);
+    for (uint32_t c = 0; c < header->column_count; c++) {
+        int width, precision;
+        dump_format(header->columns[c], &width, &precision);
+        if (isnan(slot->values[c])) {
+            fprintf(out, " %*s", width, "-");
+            continue;
+        }
+        char value[48];
+        snprintf(value, sizeof(value), "%.*f%s", precision, slot->values[c],
+                 slot->anomalies & (1u << c) ? "*" : "");
+        fprintf(out, " %*s", width, value);
+    }
+
+    for (int k = 0; k < slot->disk_count && k < RECORDER_DEVICES; k++) {
+        fprintf(out, " disk:%.*s=%.1f%%%s", (int)sizeof(slot->disks[k].name), slot->disks[k].name,
+                slot->disks[k].value[0], slot->device_anomalies & (1u << k) ? "*" : "");
+    }
+    for (int k = 0; k < slot->interface_count && k < RECORDER_DEVICES; k++) {
+        fprintf(out, " net:%.*s=%.3f/%.3f%s", (int)sizeof(slot->interfaces[k].name), slot->interfaces[k].name,
+                slot->interfaces[k].value[0], slot->interfaces[k].value[1],
+                slot->device_anomalies & (1u << (RECORDER_DEVICES + k)) ? "*" : "");
+    }
+    fputc('\n', out);
+}
+
+int recorder_dump(const char *path, FILE *out) {
+    if (!path || !out) return -1;
+
+    RecorderView view;
+    if (recorder_view_open(&view, path) != 0) return -1;
+
+    const RecorderHeader *header = view.header;
+    const RecorderSlot **order = malloc(header->slot_count * sizeof(*order));
+    if (!order) {
+        recorder_view_close(&view);
+        return -1;
+    }
+
+    uint32_t intact = 0, torn = 0;
+    for (uint32_t i = 0; i < header->slot_count; i++) {
+        const RecorderSlot *slot = recorder_view_slot(&view, i);
+        if (recorder_slot_intact(slot)) {
+            order[intact++] = slot;
+        } else if (slot->seq != 0 || slot->checksum != 0) {
+            torn++;
+        }
+    }
+    qsort(order, intact, sizeof(*order), compare_seq);
+
+    char created[48], interval[16];
+    format_wall(header->created_ns, created, sizeof(created));
+    sysmon_format_duration(header->interval_ns, interval, sizeof(interval));
+    fprintf(out, "# ring %s: host %.*s, created %s, %u slots, sampled every %s\n", path,
+            (int)sizeof(header->hostname), header->hostname, created, header->slot_count, interval);
+    fprintf(out, "# %u samples, %u torn slots; * = flagged anomalous\n", intact, torn);
+
+    fprintf(out, "%-23s %10s", "# time", "seq");
+    for (uint32_t c = 0; c < header->column_count; c++) {
+        int width, precision;
+        dump_format(header->columns[c], &width, &precision);
+        fprintf(out, " %*.*s", width, RECORDER_COLUMN_NAME, header->columns[c]);
+    }
+    fprintf(out, " devices\n");
+
+    for (uint32_t i = 0; i < intact; i++) {
+        dump_slot(header, order[i], out);
+    }
+
+    free(order);
+    recorder_view_close(&view);
+    return 0;
+}
@@ -0,0 +1,372 @@
+#include "render.h"
+#include "sysmon.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+void render_table_init(RenderTable *table, const RenderColumn *columns, int num_columns) {
+    if (!table) return;
+
+    if (num_columns > RENDER_MAX_COLS) {
+        num_columns = RENDER_MAX_COLS;
+    }
+
+    table->columns = columns;
+    table->num_columns = num_columns;
+    table->num_rows = 0;
+    table->show_header = false;
+    table->sortable = false;
+    table->message = NULL;
+    table->row_header[0] = '\0';
+}
+
+RenderRow* render_table_add_row(RenderTable *table) {
+    if (!table || table->num_rows >= RENDER_MAX_ROWS) {
+        return NULL;
+    }
+
+    RenderRow *row = &table->rows[table->num_rows++];
+    memset(row, 0, sizeof(RenderRow));
+    return row;
+}
+
+void render_table_set_message(RenderTable *table, const char *message) {
+    if (!table) return;
+    table->message = message;
+}
+
+void render_cell_text(RenderRow *row, int col, const char *text) {
+    if (!row || col < 0 || col >= RENDER_MAX_COLS) return;
+    row->cells[col].type = CELL_TEXT;
+    row->cells[col].v.text = text;
+}
+
+void render_cell_int(RenderRow *row, int col, long long value) {
+    if (!row || col < 0 || col >= RENDER_MAX_COLS) return;
+    row->cells[col].type = CELL_INT;
+    row->cells[col].v.i = value;
+}
+
+void render_cell_percent(RenderRow *row, int col, double value) {
+    if (!row || col < 0 || col >= RENDER_MAX_COLS) return;
+    row->cells[col].type = CELL_PERCENT;
+    row->cells[col].v.f = value;
+}
+
+void render_cell_bytes(RenderRow *row, int col, unsigned long long value) {
+    if (!row || col < 0 || col >= RENDER_MAX_COLS) return;
+    row->cells[col].type = CELL_BYTES;
+    row->cells[col].v.bytes = value;
+}
+
+void render_cell_rate(RenderRow *row, int col, double rate_mbps) {
+    if (!row || col < 0 || col >= RENDER_MAX_COLS) return;
+    row->cells[col].type = CELL_RATE;
+    row->cells[col].v.f = rate_mbps;
+}
+
+void render_cell_duration(RenderRow *row, int col, unsigned long long ns) {
+    if (!row || col < 0 || col >= RENDER_MAX_COLS) return;
+    row->cells[col].type = CELL_DURATION;
+    row->cells[col].v.ns = ns;
+}
+
+void render_cell_anomaly(RenderRow *row, int col, bool anomaly) {
+    if (!row || col < 0 || col >= RENDER_MAX_COLS) return;
+    row->cells[col].anomaly = anomaly;
+}
+
+bool render_cell_is_numeric(const RenderCell *cell) {
+    return cell && cell->type != CELL_EMPTY && cell->type != CELL_TEXT;
+}
+
+double render_cell_value(const RenderCell *cell) {
+    if (!cell) return 0.0;
+
+    switch (cell->type) {
+        case CELL_INT:
+            return (double)cell->v.i;
+        case CELL_PERCENT:
+        case CELL_RATE:
+            return cell->v.f;
+        case CELL_BYTES:
+            return (double)cell->v.bytes;
+        case CELL_DURATION:
+            return (double)cell->v.ns;
+        default:
+            return 0.0;
+    }
+}
+
+int render_cell_compare(const RenderCell *a, const RenderCell *b) {
+    // Empty cells always sort last
+    if (a->type == CELL_EMPTY || b->type == CELL_EMPTY) {
+        return (a->type == CELL_EMPTY) - (b->type == CELL_EMPTY);
+    }
+
+    if (a->type == CELL_TEXT && b->type == CELL_TEXT) {
+        return strcmp(a->v.text ? a->v.text : "", b->v.text ? b->v.text : "");
+    }
+
+    if ((a->type == CELL_BYTES || a->type == CELL_DURATION) && a->type == b->type) {
+        return (a->v.bytes > b->v.bytes) - (a->v.bytes < b->v.bytes);
+    }
+
+    double va = render_cell_value(a);
+    double vb = render_cell_value(b);
+    return (va > vb) - (va < vb);
+}
+
+int render_format_cell(const RenderCell *cell, char *buffer, size_t buffer_size) {
+    if (!cell || !buffer || buffer_size == 0) return 0;
+
+    switch (cell->type) {
+        case CELL_TEXT:
+            return snprintf(buffer, buffer_size, "%s", cell->v.text ? cell->v.text : "");
+        case CELL_INT:
+            return snprintf(buffer, buffer_size, "%lld", cell->v.i);
+        case CELL_PERCENT:
+            return snprintf(buffer, buffer_size, "%.1f%%", cell->v.f);
+        case CELL_BYTES:
+            sysmon_format_bytes(cell->v.bytes, buffer, buffer_size);
+            return (int)strlen(buffer);
+        case CELL_RATE:
+            sysmon_format_rate(cell->v.f, buffer, buffer_size);
+            return (int)strlen(buffer);
+        case CELL_DURATION:
+            sysmon_format_duration(cell->v.ns, buffer, buffer_size);
+            return (int)strlen(buffer);
+        default:
+            buffer[0] = '\0';
+            return 0;
+    }
+}
+
+void render_list_init(RenderList *list, const RenderColumn *columns, int num_columns,
+                      int num_rows, RenderRowFn fill_row, void *ctx) {
+    if (!list) return;
+
+    if (num_columns > RENDER_MAX_COLS) {
+        num_columns = RENDER_MAX_COLS;
+    }
+
+    list->columns = columns;
+    list->num_columns = num_columns;
+    list->num_rows = num_rows > 0 ? num_rows : 0;
+    list->fill_row = fill_row;
+    list->fill_key = NULL;
+    list->ctx = ctx;
+    list->show_header = false;
+    list->sortable = false;
+    list->partial_order = false;
+    list->tiebreak_column = -1;
+    list->message = NULL;
+    list->row_header = NULL;
+}
+
+// Row callback serving a materialized table
+static void fill_table_row(void *ctx, int index, RenderRow *row) {
+    const RenderTable *table = ctx;
+    *row = table->rows[index];
+}
+
+void render_list_from_table(RenderList *list, const RenderTable *table) {
+    if (!list || !table) return;
+
+    render_list_init(list, table->columns, table->num_columns, table->num_rows,
+                     fill_table_row, (void *)table);
+    list->show_header = table->show_header;
+    list->sortable = table->sortable;
+    list->message = table->message;
+    list->row_header = table->row_header[0] ? table->row_header : NULL;
+}
+
+// Sort scratch space, grown on demand and kept for the next frame
+static int *order_buffer = NULL;
+static int *merge_buffer = NULL;
+static RenderCell *key_buffer = NULL;
+static RenderCell *tie_buffer = NULL;
+static int order_capacity = 0;
+
+static bool reserve_order_buffers(int count) {
+    if (count <= order_capacity) return true;
+
+    int capacity = order_capacity ? order_capacity : 64;
+    while (capacity < count) capacity *= 2;
+
+    int *order = realloc(order_buffer, capacity * sizeof(int));
+    if (order) order_buffer = order;
+    int *merge = realloc(merge_buffer, capacity * sizeof(int));
+    if (merge) merge_buffer = merge;
+    RenderCell *keys = realloc(key_buffer, capacity * sizeof(RenderCell));
+    if (keys) key_buffer = keys;
+    RenderCell *ties = realloc(tie_buffer, capacity * sizeof(RenderCell));
+    if (ties) tie_buffer = ties;
+
+    if (!order || !merge || !keys || !ties) return false;
+
+    order_capacity = capacity;
+    return true;
+}
+
+// Row ordering for sorting; empty cells stay last in both directions
+static int compare_sort_cells(const RenderCell *a, const RenderCell *b, bool descending) {
+    if (a->type == CELL_EMPTY || b->type == CELL_EMPTY) {
+        return (a->type == CELL_EMPTY) - (b->type == CELL_EMPTY);
+    }
+
+    int cmp = render_cell_compare(a, b);
+    return descending ? -cmp : cmp;
+}
+
+const int* render_list_order(const RenderList *list, int column, bool descending) {
+    if (!list || !list->fill_row || list->num_rows == 0) return NULL;
+    if (!reserve_order_buffers(list->num_rows)) return NULL;
+
+    int count = list->num_rows;
+    for (int i = 0; i < count; i++) {
+        order_buffer[i] = i;
+    }
+
+    if (column < 0 || column >= list->num_columns) {
+        return order_buffer;
+    }
+
+    // Extract the sort keys once; no text is formatted here
+    RenderRowFn fill = list->fill_key ? list->fill_key : list->fill_row;
+    RenderRow row;
+    for (int i = 0; i < count; i++) {
+        memset(&row, 0, sizeof(row));
+        fill(list->ctx, i, &row);
+        key_buffer[i] = row.cells[column];
+    }
+
+    // Bottom-up merge sort keeps equal keys in collection order
+    int *src = order_buffer;
+    int *dst = merge_buffer;
+    for (int width = 1; width < count; width *= 2) {
+        for (int lo = 0; lo < count; lo += 2 * width) {
+            int mid = lo + width < count ? lo + width : count;
+            int hi = lo + 2 * width < count ? lo + 2 * width : count;
+            int i = lo, j = mid, k = lo;
+
+            while (i < mid && j < hi) {
+                if (compare_sort_cells(&key_buffer[src[j]], &key_buffer[src[i]], descending) < 0) {
+                    dst[k++] = src[j++];
+                } else {
+                    dst[k++] = src[i++];
+                }
+            }
+            while (i < mid) dst[k++] = src[i++];
+            while (j < hi) dst[k++] = src[j++];
+        }
+
+        int *tmp = src;
+        src = dst;
+        dst = tmp;
+    }
+
+    // Keep the result in order_buffer so the caller sees a stable pointer
+    if (src != order_buffer) {
+        memcpy(order_buffer, src, count * sizeof(int));
+    }
+
+    return order_buffer;
+}
+
+// Rank of row a against row b for partial ordering: sort key, then the
+// tiebreak column ascending, then collection order
+static int compare_ranked_rows(int a, int b, bool descending, bool tiebreak) {
+    int cmp = compare_sort_cells(&key_buffer[a], &key_buffer[b], descending);
+    if (cmp == 0 && tiebreak) {
+        cmp = compare_sort_cells(&tie_buffer[a], &tie_buffer[b], false);
+    }
+    if (cmp == 0) {
+        cmp = (a > b) - (a < b);
+    }
+    return cmp;
+}
+
+// Restore the max-heap property below position pos; the root is the
+// lowest-ranked row kept so far
+static void heap_sift_down(int *heap, int size, int pos, bool descending, bool tiebreak) {
+    for (;;) {
+        int largest = pos;
+        int left = 2 * pos + 1;
+        int right = left + 1;
+
+        if (left < size && compare_ranked_rows(heap[left], heap[largest], descending, tiebreak) > 0) {
+            largest = left;
+        }
+        if (right < size && compare_ranked_rows(heap[right], heap[largest], descending, tiebreak) > 0) {
+            largest = right;
+        }
+        if (largest == pos) return;
+
+        int tmp = heap[pos];
+        heap[pos] = heap[largest];
+        heap[largest] = tmp;
+        pos = largest;
+    }
+}
+
+static void heap_sift_up(int *heap, int pos, bool descending, bool tiebreak) {
+    while (pos > 0) {
+        int parent = (pos - 1) / 2;
+        if (compare_ranked_rows(heap[pos], heap[parent], descending, tiebreak) <= 0) return;
+
+        int tmp = heap[pos];
+        heap[pos] = heap[parent];
+        heap[parent] = tmp;
+        pos = parent;
+    }
+}
+
+const int* render_list_top(const RenderList *list, int column, bool descending, int limit) {
+    if (!list || !list->fill_row || list->num_rows == 0) return NULL;
+    if (!reserve_order_buffers(list->num_rows)) return NULL;
+
+    int count = list->num_rows;
+    if (column < 0 || column >= list->num_columns) {
+        for (int i = 0; i < count; i++) {
+            order_buffer[i] = i;
+        }
+        return order_buffer;
+    }
+    if (limit > count) limit = count;
+    if (limit <= 0) return order_buffer;
+
+    int tie_column = list->tiebreak_column;
+    bool tiebreak = tie_column >= 0 && tie_column < list->num_columns && tie_column != column;
+
+    // One pass over the keys through a bounded heap of the best rows
+    RenderRowFn fill = list->fill_key ? list->fill_key : list->fill_row;
+    int *heap = merge_buffer;
+    int size = 0;
+    RenderRow row;
+    for (int i = 0; i < count; i++) {
+        memset(&row, 0, sizeof(row));
+        fill(list->ctx, i, &row);
+        key_buffer[i] = row.cells[column];
+        if (tiebreak) {
+            tie_buffer[i] = row.cells[tie_column];
+        }
+
+        if (size < limit) {
+            heap[size] = i;
+            heap_sift_up(heap, size++, descending, tiebreak);
+        } else if (compare_ranked_rows(i, heap[0], descending, tiebreak) < 0) {
+            heap[0] = i;
+            heap_sift_down(heap, size, 0, descending, tiebreak);
+        }
+    }
+
+    // Drain worst-first into the tail, leaving the best row first
+    while (size > 0) {
+        order_buffer[--size] = heap[0];
+        heap[0] = heap[size];
+        heap_sift_down(heap, size, 0, descending, tiebreak);
+    }
+
+    return order_buffer;
+}
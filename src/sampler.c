@@ -0,0 +1,137 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "sampler.h"
+#include "selfstat.h"
+#include <string.h>
+#include <errno.h>
+#include <time.h>
+#include <poll.h>
+#include <unistd.h>
+#ifdef __linux__
+#include <sys/timerfd.h>
+#endif
+
+#define NS_PER_SEC 1000000000ULL
+#define NS_PER_MS 1000000ULL
+
+static unsigned long long realtime_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_REALTIME, &ts);
+    return (unsigned long long)ts.tv_sec * NS_PER_SEC + ts.tv_nsec;
+}
+
+// First wall-clock multiple of the interval after now, on the monotonic
+// clock. The wall offset is read again each time, so NTP steps realign.
+static unsigned long long next_boundary(const Sampler *sampler, unsigned long long now) {
+    unsigned long long wall = realtime_now();
+    unsigned long long boundary = (wall / sampler->interval_ns + 1) * sampler->interval_ns;
+    return now + (boundary - wall);
+}
+
+static void arm(Sampler *sampler) {
+#ifdef __linux__
+    if (sampler->fd < 0) return;
+
+    struct itimerspec spec;
+    memset(&spec, 0, sizeof(spec));
+    spec.it_value.tv_sec = sampler->deadline_ns / NS_PER_SEC;
+    spec.it_value.tv_nsec = sampler->deadline_ns % NS_PER_SEC;
+    timerfd_settime(sampler->fd, TFD_TIMER_ABSTIME, &spec, NULL);
+#else
+    (void)sampler;
+#endif
+}
+
+int sampler_init(Sampler *sampler, unsigned long long interval_ns) {
+    if (!sampler || interval_ns < SAMPLER_MIN_INTERVAL_NS || interval_ns > SAMPLER_MAX_INTERVAL_NS) return -1;
+
+    memset(sampler, 0, sizeof(Sampler));
+    sampler->interval_ns = interval_ns;
+    sampler->fd = -1;
+#ifdef __linux__
+    // selfstat_now reads CLOCK_MONOTONIC, so deadlines share its time base
+    sampler->fd = timerfd_create(CLOCK_MONOTONIC, TFD_NONBLOCK | TFD_CLOEXEC);
+#endif
+
+    // The caller has just sampled; the first deadline is the next boundary
+    sampler->deadline_ns = next_boundary(sampler, selfstat_now());
+    arm(sampler);
+    return 0;
+}
+
+void sampler_free(Sampler *sampler) {
+    if (!sampler) return;
+
+    if (sampler->fd >= 0) {
+        close(sampler->fd);
+    }
+    memset(sampler, 0, sizeof(Sampler));
+    sampler->fd = -1;
+}
+
+void sampler_defer(Sampler *sampler, unsigned long long until_ns) {
+    if (!sampler || until_ns <= sampler->deadline_ns + sampler->interval_ns / 2) return;
+
+    // Whole intervals keep the deadline on its wall-clock boundary
+    unsigned long long skip = (until_ns - sampler->deadline_ns - sampler->interval_ns / 2 +
+                               sampler->interval_ns - 1) / sampler->interval_ns;
+    sampler->deadline_ns += skip * sampler->interval_ns;
+    arm(sampler);
+}
+
+void sampler_trigger(Sampler *sampler) {
+    if (!sampler) return;
+
+    sampler->deadline_ns = selfstat_now();
+    arm(sampler);
+}
+
+bool sampler_wait(Sampler *sampler, int input_fd) {
+    if (!sampler) return false;
+
+    unsigned long long now = selfstat_now();
+    if (now < sampler->deadline_ns) {
+        struct pollfd fds[2];
+        int nfds = 0;
+        int timeout = -1;
+
+        if (input_fd >= 0) {
+            fds[nfds].fd = input_fd;
+            fds[nfds].events = POLLIN;
+            nfds++;
+        }
+        if (sampler->fd >= 0) {
+            fds[nfds].fd = sampler->fd;
+            fds[nfds].events = POLLIN;
+            nfds++;
+        } else {
+            // Round up, so the wake-up is never early
+            timeout = (int)((sampler->deadline_ns - now + NS_PER_MS - 1) / NS_PER_MS);
+        }
+
+        // Signals (resize, quit) end the wait early; the caller looks again
+        if (poll(fds, nfds, timeout) < 0 && errno != EINTR) return false;
+        now = selfstat_now();
+        if (now < sampler->deadline_ns) return false;
+    }
+
+    if (sampler->fd >= 0) {
+        unsigned long long expirations;
+        ssize_t drained = read(sampler->fd, &expirations, sizeof(expirations));
+        (void)drained;
+    }
+
+    sampler->sample_ns = sampler->deadline_ns;
+    sampler->jitter_ns = (long long)(now - sampler->deadline_ns);
+
+    // Next boundary after the one just served; an overrunning sample skips
+    // the deadlines it covered rather than bursting to catch up
+    unsigned long long next = next_boundary(sampler, now);
+    if (next < sampler->deadline_ns + sampler->interval_ns / 2) {
+        next += sampler->interval_ns;
+    }
+    sampler->missed += (next - sampler->deadline_ns - sampler->interval_ns / 2) / sampler->interval_ns;
+    sampler->deadline_ns = next;
+    arm(sampler);
+    return true;
+}
@@ -0,0 +1,164 @@
+#define _POSIX_C_SOURCE 200809L
+
+#include "selfstat.h"
+#include "sysmon.h"
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+#include <sys/resource.h>
+
+static const char *stage_names[SELFSTAT_STAGE_COUNT] = {
+    "cpu", "memory", "kernel", "disk", "network", "process", "interrupts", "netstack", "sockets", "numa",
+    "display", "refresh", "jitter"
+};
+
+unsigned long long selfstat_now(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (unsigned long long)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+// syscr + syscw from /proc/self/io (needs task I/O accounting)
+static bool read_syscalls(unsigned long long *syscalls) {
+    FILE *fp = fopen("/proc/self/io", "r");
+    if (!fp) return false;
+
+    char line[128];
+    unsigned long long value, total = 0;
+    int found = 0;
+
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "syscr: %llu", &value) == 1 ||
+            sscanf(line, "syscw: %llu", &value) == 1) {
+            total += value;
+            found++;
+        }
+    }
+
+    fclose(fp);
+    *syscalls = total;
+    return found == 2;
+}
+
+static long read_rss_kb(void) {
+    FILE *fp = fopen("/proc/self/statm", "r");
+    if (!fp) return 0;
+
+    long size = 0, resident = 0;
+    int ret = fscanf(fp, "%ld %ld", &size, &resident);
+    fclose(fp);
+
+    if (ret != 2) return 0;
+    return resident * (sysconf(_SC_PAGESIZE) / 1024);
+}
+
+static void take_snapshot(SelfUsageSnapshot *snap, unsigned long long ticks) {
+    struct rusage usage;
+
+    snap->wall_ns = selfstat_now();
+    snap->cpu_ns = 0;
+    if (getrusage(RUSAGE_SELF, &usage) == 0) {
+        snap->cpu_ns = (unsigned long long)(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) * 1000000000ULL +
+                       (unsigned long long)(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec) * 1000ULL;
+    }
+    snap->has_syscalls = read_syscalls(&snap->syscalls);
+    snap->ticks = ticks;
+}
+
+// Usage between two snapshots
+static void usage_between(const SelfUsageSnapshot *from, const SelfUsageSnapshot *to, SelfProcessStats *stats) {
+    unsigned long long wall = to->wall_ns - from->wall_ns;
+    unsigned long long ticks = to->ticks - from->ticks;
+
+    stats->ticks = ticks;
+    stats->cpu_percent = wall > 0 ? 100.0 * (double)(to->cpu_ns - from->cpu_ns) / wall : 0.0;
+    stats->syscalls_per_tick = (ticks > 0 && from->has_syscalls && to->has_syscalls)
+                             ? (double)(to->syscalls - from->syscalls) / ticks : 0.0;
+    stats->rss_kb = read_rss_kb();
+    stats->valid = true;
+}
+
+void selfstat_init(SelfStat *stat) {
+    if (!stat) return;
+
+    for (int i = 0; i < SELFSTAT_STAGE_COUNT; i++) {
+        histogram_reset(&stat->stages[i]);
+    }
+
+    stat->ticks = 0;
+    take_snapshot(&stat->start_usage, 0);
+    stat->last_usage = stat->start_usage;
+}
+
+void selfstat_record(SelfStat *stat, SelfStatStage stage, unsigned long long elapsed_ns) {
+    if (!stat || (int)stage < 0 || stage >= SELFSTAT_STAGE_COUNT) return;
+    histogram_record(&stat->stages[stage], elapsed_ns);
+}
+
+const Histogram* selfstat_histogram(const SelfStat *stat, SelfStatStage stage) {
+    if (!stat || (int)stage < 0 || stage >= SELFSTAT_STAGE_COUNT) return NULL;
+    return &stat->stages[stage];
+}
+
+const char* selfstat_stage_name(SelfStatStage stage) {
+    if ((int)stage < 0 || stage >= SELFSTAT_STAGE_COUNT) return "unknown";
+    return stage_names[stage];
+}
+
+void selfstat_tick(SelfStat *stat) {
+    if (stat) stat->ticks++;
+}
+
+bool selfstat_sample_process(SelfStat *stat, SelfProcessStats *stats) {
+    if (!stat || !stats) return false;
+
+    SelfUsageSnapshot now;
+    take_snapshot(&now, stat->ticks);
+
+    // Nothing new since the last sample, keep reporting the previous one
+    if (now.ticks == stat->last_usage.ticks) {
+        return false;
+    }
+
+    usage_between(&stat->last_usage, &now, stats);
+    stat->last_usage = now;
+    return true;
+}
+
+void selfstat_dump(const SelfStat *stat, FILE *fp) {
+    if (!stat || !fp) return;
+
+    SelfUsageSnapshot now;
+    take_snapshot(&now, stat->ticks);
+
+    SelfProcessStats total;
+    usage_between(&stat->start_usage, &now, &total);
+
+    fprintf(fp, "pisysmon self statistics: %llu ticks over %.1f s\n",
+            total.ticks, (now.wall_ns - stat->start_usage.wall_ns) / 1e9);
+    fprintf(fp, "%-10s %8s %10s %10s %10s %10s\n", "stage", "count", "mean", "p50", "p99", "max");
+
+    for (int i = 0; i < SELFSTAT_STAGE_COUNT; i++) {
+        const Histogram *hist = &stat->stages[i];
+        char mean[16], p50[16], p99[16], max[16];
+
+        sysmon_format_duration((unsigned long long)histogram_mean(hist), mean, sizeof(mean));
+        sysmon_format_duration(histogram_percentile(hist, 0.50), p50, sizeof(p50));
+        sysmon_format_duration(histogram_percentile(hist, 0.99), p99, sizeof(p99));
+        sysmon_format_duration(hist->max, max, sizeof(max));
+
+        fprintf(fp, "%-10s %8llu %10s %10s %10s %10s\n",
+                stage_names[i], hist->total, mean, p50, p99, max);
+    }
+
+    char rss[32];
+    sysmon_format_bytes(total.rss_kb * 1024ULL, rss, sizeof(rss));
+
+    if (now.has_syscalls) {
+        fprintf(fp, "syscalls/tick: %.1f (read/write family)\n", total.syscalls_per_tick);
+    } else {
+        fprintf(fp, "syscalls/tick: unavailable (no /proc/self/io)\n");
+    }
+    fprintf(fp, "rss: %s\n", rss);
+    fprintf(fp, "cpu: %.2f%%\n", total.cpu_percent);
+}
@@ -0,0 +1,190 @@
+#define _DEFAULT_SOURCE
+
+#include "sockdiag.h"
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+#include <errno.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <linux/netlink.h>
+#include <linux/sock_diag.h>
+#include <linux/inet_diag.h>
+
+// One receive drains a few thousand sockets; no extensions are requested,
+// so each socket is a bare inet_diag_msg
+#define SOCKDIAG_BUFFER_SIZE (256 * 1024)
+#define NUM_PORTS 65536
+
+static const char *state_names[TCP_STATE_COUNT] = {
+    [TCP_STATE_ESTABLISHED]  = "ESTABLISHED",
+    [TCP_STATE_SYN_SENT]     = "SYN_SENT",
+    [TCP_STATE_SYN_RECV]     = "SYN_RECV",
+    [TCP_STATE_FIN_WAIT1]    = "FIN_WAIT1",
+    [TCP_STATE_FIN_WAIT2]    = "FIN_WAIT2",
+    [TCP_STATE_TIME_WAIT]    = "TIME_WAIT",
+    [TCP_STATE_CLOSE]        = "CLOSE",
+    [TCP_STATE_CLOSE_WAIT]   = "CLOSE_WAIT",
+    [TCP_STATE_LAST_ACK]     = "LAST_ACK",
+    [TCP_STATE_LISTEN]       = "LISTEN",
+    [TCP_STATE_CLOSING]      = "CLOSING",
+    [TCP_STATE_NEW_SYN_RECV] = "NEW_SYN_RECV",
+};
+
+int sockdiag_init(SockDiagStats *stats) {
+    if (!stats) return -1;
+
+    memset(stats, 0, sizeof(SockDiagStats));
+    stats->fd = -1;
+    stats->buffer = malloc(SOCKDIAG_BUFFER_SIZE);
+    stats->port_counts = calloc(NUM_PORTS, sizeof(unsigned int));
+    if (!stats->buffer || !stats->port_counts) {
+        sockdiag_free(stats);
+        return -1;
+    }
+    stats->buffer_size = SOCKDIAG_BUFFER_SIZE;
+    return 0;
+}
+
+void sockdiag_free(SockDiagStats *stats) {
+    if (!stats) return;
+
+    if (stats->fd >= 0) {
+        close(stats->fd);
+    }
+    free(stats->buffer);
+    free(stats->port_counts);
+    memset(stats, 0, sizeof(SockDiagStats));
+    stats->fd = -1;
+}
+
+static bool open_socket(SockDiagStats *stats) {
+    if (stats->fd >= 0) return true;
+
+    stats->fd = socket(AF_NETLINK, SOCK_DGRAM | SOCK_CLOEXEC, NETLINK_SOCK_DIAG);
+    if (stats->fd < 0) return false;
+
+    // Let the kernel queue a whole batch between receives
+    int size = SOCKDIAG_BUFFER_SIZE;
+    setsockopt(stats->fd, SOL_SOCKET, SO_RCVBUF, &size, sizeof(size));
+    return true;
+}
+
+static ListenPort* find_port(SockDiagStats *stats, unsigned short port) {
+    for (int i = 0; i < stats->num_ports; i++) {
+        if (stats->ports[i].port == port) return &stats->ports[i];
+    }
+    if (stats->num_ports >= SOCKDIAG_MAX_PORTS) return NULL;
+
+    ListenPort *entry = &stats->ports[stats->num_ports++];
+    memset(entry, 0, sizeof(ListenPort));
+    entry->port = port;
+    return entry;
+}
+
+// Fold one socket into the aggregates; nothing per socket is kept
+static void account(SockDiagStats *stats, const struct inet_diag_msg *msg) {
+    unsigned int state = msg->idiag_state;
+    unsigned short port = ntohs(msg->id.idiag_sport);
+
+    if (state < TCP_STATE_COUNT) {
+        stats->states[state]++;
+    }
+    stats->total++;
+
+    if (state == TCP_STATE_LISTEN) {
+        // For listeners the queues are the accept queue and its limit
+        ListenPort *entry = find_port(stats, port);
+        if (entry) {
+            entry->listeners++;
+            entry->accept_queue += msg->idiag_rqueue;
+            entry->backlog += msg->idiag_wqueue;
+        }
+    } else {
+        stats->port_counts[port]++;
+    }
+}
+
+// Request a dump of one address family and fold in every reply
+static bool dump_family(SockDiagStats *stats, unsigned char family) {
+    struct {
+        struct nlmsghdr header;
+        struct inet_diag_req_v2 request;
+    } message;
+
+    memset(&message, 0, sizeof(message));
+    message.header.nlmsg_len = sizeof(message);
+    message.header.nlmsg_type = SOCK_DIAG_BY_FAMILY;
+    message.header.nlmsg_flags = NLM_F_REQUEST | NLM_F_DUMP;
+    message.request.sdiag_family = family;
+    message.request.sdiag_protocol = IPPROTO_TCP;
+    message.request.idiag_states = ~0U;
+
+    struct sockaddr_nl kernel = { .nl_family = AF_NETLINK };
+    if (sendto(stats->fd, &message, sizeof(message), 0, (struct sockaddr *)&kernel, sizeof(kernel)) < 0) {
+        return false;
+    }
+
+    for (;;) {
+        ssize_t length = recv(stats->fd, stats->buffer, stats->buffer_size, 0);
+        if (length < 0) {
+            if (errno == EINTR) continue;
+            return false;
+        }
+
+        int remaining = (int)length;
+        for (struct nlmsghdr *header = (struct nlmsghdr *)stats->buffer; NLMSG_OK(header, remaining);
+             header = NLMSG_NEXT(header, remaining)) {
+            if (header->nlmsg_type == NLMSG_DONE) return true;
+            if (header->nlmsg_type == NLMSG_ERROR) return false;
+            if (header->nlmsg_len < NLMSG_LENGTH(sizeof(struct inet_diag_msg))) continue;
+
+            account(stats, NLMSG_DATA(header));
+        }
+    }
+}
+
+static int compare_ports(const void *a, const void *b) {
+    const ListenPort *pa = a;
+    const ListenPort *pb = b;
+
+    if (pa->connections != pb->connections) return pa->connections < pb->connections ? 1 : -1;
+    return (int)pa->port - (int)pb->port;
+}
+
+bool sockdiag_update(SockDiagStats *stats) {
+    if (!stats || !stats->buffer) return false;
+
+    if (!open_socket(stats)) {
+        stats->valid = false;
+        return false;
+    }
+
+    memset(stats->states, 0, sizeof(stats->states));
+    memset(stats->port_counts, 0, NUM_PORTS * sizeof(unsigned int));
+    stats->total = 0;
+    stats->num_ports = 0;
+
+    bool ok = dump_family(stats, AF_INET);
+    ok = ok && dump_family(stats, AF_INET6);
+    if (!ok) {
+        // A half-read dump leaves replies queued; start over on a new socket
+        close(stats->fd);
+        stats->fd = -1;
+        stats->valid = false;
+        return false;
+    }
+
+    for (int i = 0; i < stats->num_ports; i++) {
+        stats->ports[i].connections = stats->port_counts[stats->ports[i].port];
+    }
+    qsort(stats->ports, stats->num_ports, sizeof(ListenPort), compare_ports);
+
+    stats->valid = true;
+    return true;
+}
+
+const char* sockdiag_state_name(TcpState state) {
+    if ((int)state <= 0 || state >= TCP_STATE_COUNT) return "unknown";
+    return state_names[state];
+}
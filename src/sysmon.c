@@ -1,245 +1,895 @@
 #define _POSIX_C_SOURCE 200809L
 
 #include "sysmon.h"
+#include "selfstat.h"
+#include "procfile.h"
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 #include <unistd.h>
 #include <time.h>
+#include <stddef.h>
+#include <errno.h>
+#include <sys/statvfs.h>
 
-// Global system monitor instance
-SystemMonitor g_sysmon = {0};
+#define NS_PER_MS 1000000ULL
+#define NS_PER_SEC 1000000000ULL
 
-// Static variables for CPU calculation
-static long prev_user = 0, prev_nice = 0, prev_system = 0, prev_idle = 0;
-static long prev_iowait = 0, prev_irq = 0, prev_softirq = 0, prev_steal = 0;
-static bool cpu_initialized = false;
+// Smallest deviation worth flagging: percentage points for usage series,
+// Mbps for interface rates
+#define ANOMALY_FLOOR_PERCENT 1.0
+#define ANOMALY_FLOOR_MBPS 1.0
 
-// Static variables for network rate calculation
-static NetworkStats prev_network_stats[16];
-static time_t prev_network_time = 0;
-static bool network_initialized = false;
+// Adaptive sampling reads usage changes in points and interface throughput
+// relative to at least 1 Mbps, so an idle link's noise never counts
+#define ADAPTIVE_FLOOR_PERCENT 100.0
+#define ADAPTIVE_FLOOR_MBPS 1.0
 
-int sysmon_init(void) {
-    memset(&g_sysmon, 0, sizeof(SystemMonitor));
-    g_sysmon.update_interval_ms = 1000;
-    g_sysmon.running = true;
-    
-    // Initialize previous stats
-    cpu_initialized = false;
-    network_initialized = false;
-    prev_network_time = 0;
+#define SAMPLED(which) (1u << (which))
+
+// Bounds a corrupt cpuN id; well above the largest hosts
+#define SYSMON_MAX_CPUS 8192
+
+// Headline series names, as in alert rules
+static const char *system_series_names[SYSTEM_WINDOW_COUNT] = {
+    "cpu.usage", "mem.usage", "mem.swap_usage"
+};
+
+// Counters of the aggregate cpu line of /proc/stat
+typedef enum {
+    CPU_COUNTER_USER = 0,
+    CPU_COUNTER_NICE,
+    CPU_COUNTER_SYSTEM,
+    CPU_COUNTER_IDLE,
+    CPU_COUNTER_IOWAIT,
+    CPU_COUNTER_IRQ,
+    CPU_COUNTER_SOFTIRQ,
+    CPU_COUNTER_STEAL,
+    CPU_COUNTER_COUNT
+} CpuCounter;
+
+// Counters kept per interface slot in the interface counter bank
+typedef enum {
+    NET_COUNTER_RX_BYTES = 0,
+    NET_COUNTER_TX_BYTES,
+    NET_COUNTER_RX_PACKETS,
+    NET_COUNTER_TX_PACKETS,
+    NET_COUNTER_COUNT
+} NetCounter;
+
+int sysmon_init(SystemMonitor *mon) {
+    if (!mon) return -1;
+
+    memset(mon, 0, sizeof(SystemMonitor));
+    mon->update_interval_ns = NS_PER_SEC;
+    mon->running = true;
+    sysmon_set_roots(mon, "/proc", "/sys");
+    mon->window_ns = SYSMON_DEFAULT_WINDOW_NS;
+    sysmon_set_adaptive(mon, 0.0);
+    selfstat_init(&mon->selfstat);
+
+    // Every member is freed by sysmon_cleanup on failure, whether its init
+    // ran or not; zeroed descriptors would read as stdin
+    mon->sockets.fd = -1;
+    mon->process_scan.reader.ring_fd = -1;
+
+    // Previous samples live in counter banks next to the stats they feed
+    if (counter_bank_init(&mon->cpu.counters, CPU_COUNTER_COUNT) != 0 ||
+        counter_bank_init(&mon->cpu.per_cpu, 0) != 0 ||
+        counter_bank_init(&mon->kernel.counters, KERNEL_COUNTER_COUNT) != 0 ||
+        counter_bank_init(&mon->interface_counters, 0) != 0 ||
+        interrupts_init(&mon->interrupts) != 0 ||
+        netstack_init(&mon->netstack) != 0 ||
+        sockdiag_init(&mon->sockets) != 0 ||
+        numa_init(&mon->numa) != 0 ||
+        process_scan_init(&mon->process_scan, false) != 0) {
+        sysmon_cleanup(mon);
+        return -1;
+    }
+
+    // Windows are sized for the default interval until sysmon_set_window
+    unsigned long long interval_ns = mon->update_interval_ns;
+    if (window_bank_init(&mon->windows, mon->window_ns, interval_ns) != 0 ||
+        window_bank_reserve(&mon->windows, SYSTEM_WINDOW_COUNT) != 0 ||
+        window_bank_init(&mon->disk_windows, mon->window_ns, interval_ns) != 0 ||
+        window_bank_init(&mon->interface_windows, mon->window_ns, interval_ns) != 0 ||
+        sysmon_set_anomaly(mon, ANOMALY_DEFAULT_Z, false) != 0) {
+        sysmon_cleanup(mon);
+        return -1;
+    }
+
+    // Device tables grow on demand and keep entries stable across samples
+    if (stat_table_init(&mon->disks, sizeof(DiskStats),
+                        offsetof(DiskStats, mount_point), sizeof(((DiskStats *)0)->mount_point)) != 0 ||
+        stat_table_init(&mon->interfaces, sizeof(NetworkStats),
+                        offsetof(NetworkStats, interface_name), sizeof(((NetworkStats *)0)->interface_name)) != 0 ||
+        stat_table_init(&mon->processes, sizeof(ProcessStats),
+                        offsetof(ProcessStats, pid_key), sizeof(((ProcessStats *)0)->pid_key)) != 0) {
+        sysmon_cleanup(mon);
+        return -1;
+    }
     
     return 0;
 }
 
-void sysmon_cleanup(void) {
-    g_sysmon.running = false;
+void sysmon_cleanup(SystemMonitor *mon) {
+    if (!mon) return;
+
+    mon->running = false;
+    stat_table_free(&mon->disks);
+    stat_table_free(&mon->interfaces);
+    stat_table_free(&mon->processes);
+    process_scan_free(&mon->process_scan);
+    counter_bank_free(&mon->cpu.counters);
+    counter_bank_free(&mon->cpu.per_cpu);
+    free(mon->cpu.cpu_percent);
+    free(mon->cpu.text);
+    mon->cpu.cpu_percent = NULL;
+    mon->cpu.cpu_slots = 0;
+    mon->cpu.text = NULL;
+    mon->cpu.text_capacity = 0;
+    counter_bank_free(&mon->kernel.counters);
+    counter_bank_free(&mon->interface_counters);
+    interrupts_free(&mon->interrupts);
+    netstack_free(&mon->netstack);
+    sockdiag_free(&mon->sockets);
+    numa_free(&mon->numa);
+    window_bank_free(&mon->windows);
+    window_bank_free(&mon->disk_windows);
+    window_bank_free(&mon->interface_windows);
+    anomaly_bank_free(&mon->anomalies);
+    anomaly_bank_free(&mon->disk_anomalies);
+    anomaly_bank_free(&mon->interface_anomalies);
+    mon->disk_count = 0;
+    mon->interface_count = 0;
+    mon->process_count = 0;
 }
 
-void sysmon_update_all(void) {
-    if (!g_sysmon.running) return;
-    
-    // Update all system statistics
-    sysmon_update_cpu(&g_sysmon.cpu);
-    sysmon_update_memory(&g_sysmon.memory);
-    g_sysmon.disk_count = sysmon_update_disks(g_sysmon.disks, 8);
-    g_sysmon.interface_count = sysmon_update_network(g_sysmon.interfaces, 16);
+void sysmon_set_roots(SystemMonitor *mon, const char *proc_root, const char *sys_root) {
+    if (proc_root) {
+        strncpy(mon->proc_root, proc_root, sizeof(mon->proc_root) - 1);
+        mon->proc_root[sizeof(mon->proc_root) - 1] = '\0';
+    }
+    if (sys_root) {
+        strncpy(mon->sys_root, sys_root, sizeof(mon->sys_root) - 1);
+        mon->sys_root[sizeof(mon->sys_root) - 1] = '\0';
+    }
 }
 
-bool sysmon_update_cpu(CPUStats *cpu) {
-    if (!cpu) return false;
-    
-    FILE *fp = fopen("/proc/stat", "r");
-    if (!fp) {
-        cpu->valid = false;
-        return false;
+const char* sysmon_proc_path(const SystemMonitor *mon, const char *relative, char *buffer, size_t buffer_size) {
+    snprintf(buffer, buffer_size, "%s/%s", mon->proc_root, relative);
+    return buffer;
+}
+
+const char* sysmon_sys_path(const SystemMonitor *mon, const char *relative, char *buffer, size_t buffer_size) {
+    snprintf(buffer, buffer_size, "%s/%s", mon->sys_root, relative);
+    return buffer;
+}
+
+int sysmon_set_window(SystemMonitor *mon, unsigned long long span_ns) {
+    if (span_ns == 0) return -1;
+
+    unsigned long long interval_ns = mon->update_interval_ns;
+    mon->window_ns = span_ns;
+    if (window_bank_set_span(&mon->windows, span_ns, interval_ns) != 0 ||
+        window_bank_set_span(&mon->disk_windows, span_ns, interval_ns) != 0 ||
+        window_bank_set_span(&mon->interface_windows, span_ns, interval_ns) != 0) {
+        return -1;
     }
-    
-    char line[256];
-    long user, nice, system, idle, iowait, irq, softirq, steal;
-    
-    // Read the first line (overall CPU stats)
-    if (fgets(line, sizeof(line), fp) == NULL) {
-        fclose(fp);
-        cpu->valid = false;
-        return false;
+    return 0;
+}
+
+int sysmon_set_anomaly(SystemMonitor *mon, double threshold, bool seasonal) {
+    unsigned long long interval_ns = mon->update_interval_ns;
+
+    anomaly_bank_free(&mon->anomalies);
+    anomaly_bank_free(&mon->disk_anomalies);
+    anomaly_bank_free(&mon->interface_anomalies);
+    if (anomaly_bank_init(&mon->anomalies, interval_ns, threshold, ANOMALY_FLOOR_PERCENT, seasonal) != 0 ||
+        anomaly_bank_reserve(&mon->anomalies, SYSTEM_WINDOW_COUNT) != 0 ||
+        anomaly_bank_init(&mon->disk_anomalies, interval_ns, threshold, ANOMALY_FLOOR_PERCENT, seasonal) != 0 ||
+        anomaly_bank_init(&mon->interface_anomalies, interval_ns, threshold, ANOMALY_FLOOR_MBPS, seasonal) != 0) {
+        return -1;
     }
-    
-    // Parse CPU stats
-    int ret = sscanf(line, "cpu %ld %ld %ld %ld %ld %ld %ld %ld",
-                     &user, &nice, &system, &idle, &iowait, &irq, &softirq, &steal);
-    
+    return 0;
+}
+
+bool sysmon_set_io_uring(SystemMonitor *mon, bool enabled) {
+    if (!mon) return false;
+
+    batch_reader_free(&mon->process_scan.reader);
+    batch_reader_init(&mon->process_scan.reader, enabled);
+    return batch_reader_uses_uring(&mon->process_scan.reader);
+}
+
+void sysmon_set_adaptive(SystemMonitor *mon, double delta) {
+    mon->adaptive = delta > 0.0;
+    mon->adaptive_delta = delta;
+    for (int i = 0; i < SYSMON_CADENCE_COUNT; i++) {
+        cadence_reset(&mon->cadences[i]);
+    }
+}
+
+bool sysmon_wake(SystemMonitor *mon) {
+    bool backed_off = false;
+    for (int i = 0; i < SYSMON_CADENCE_COUNT; i++) {
+        backed_off |= cadence_wake(&mon->cadences[i]);
+    }
+    return backed_off;
+}
+
+unsigned long long sysmon_next_due(const SystemMonitor *mon) {
+    unsigned long long interval_ns = mon->update_interval_ns;
+    if (!mon->adaptive) return mon->sample_ns + interval_ns;
+
+    unsigned long long due = mon->cadences[0].due_ns;
+    for (int i = 1; i < SYSMON_CADENCE_COUNT; i++) {
+        if (mon->cadences[i].due_ns < due) due = mon->cadences[i].due_ns;
+    }
+    return due;
+}
+
+unsigned long long sysmon_stage_interval(const SystemMonitor *mon, SelfStatStage stage) {
+    SysmonCadence which;
+
+    switch (stage) {
+    case SELFSTAT_CPU:
+    case SELFSTAT_KERNEL:
+    case SELFSTAT_PROCESS:
+    case SELFSTAT_INTERRUPTS:
+    case SELFSTAT_NUMA:
+        which = SYSMON_CADENCE_CPU;
+        break;
+    case SELFSTAT_MEMORY:
+        which = SYSMON_CADENCE_MEMORY;
+        break;
+    case SELFSTAT_DISK:
+        which = SYSMON_CADENCE_DISK;
+        break;
+    case SELFSTAT_NETWORK:
+    case SELFSTAT_NETSTACK:
+    case SELFSTAT_SOCKETS:
+        which = SYSMON_CADENCE_NETWORK;
+        break;
+    default:
+        return 0;
+    }
+
+    unsigned long long interval_ns = mon->update_interval_ns;
+    return mon->adaptive ? mon->cadences[which].stride * interval_ns : interval_ns;
+}
+
+// Schedule each collector sampled this update from how much its activity
+// moved: CPU and memory usage, summed disk usage, total interface throughput
+static void observe_cadences(SystemMonitor *mon) {
+    unsigned long long now = mon->sample_ns;
+    unsigned long long interval_ns = mon->update_interval_ns;
+    double delta = mon->adaptive_delta;
+
+    if (mon->sampled & SAMPLED(SYSMON_CADENCE_CPU)) {
+        cadence_observe(&mon->cadences[SYSMON_CADENCE_CPU], mon->cpu.usage_percent,
+                        ADAPTIVE_FLOOR_PERCENT, delta, now, interval_ns);
+    }
+    if (mon->sampled & SAMPLED(SYSMON_CADENCE_MEMORY)) {
+        cadence_observe(&mon->cadences[SYSMON_CADENCE_MEMORY], mon->memory.usage_percent,
+                        ADAPTIVE_FLOOR_PERCENT, delta, now, interval_ns);
+    }
+    if (mon->sampled & SAMPLED(SYSMON_CADENCE_DISK)) {
+        double usage = 0.0;
+        for (int row = 0; row < mon->disk_count; row++) {
+            const DiskStats *disk = sysmon_get_disk(mon, row);
+            if (disk && disk->valid) usage += disk->usage_percent;
+        }
+        cadence_observe(&mon->cadences[SYSMON_CADENCE_DISK], usage, ADAPTIVE_FLOOR_PERCENT, delta, now, interval_ns);
+    }
+    if (mon->sampled & SAMPLED(SYSMON_CADENCE_NETWORK)) {
+        double rate = 0.0;
+        for (int row = 0; row < mon->interface_count; row++) {
+            const NetworkStats *net = sysmon_get_interface(mon, row);
+            if (net && net->valid) rate += net->rx_rate_mbps + net->tx_rate_mbps;
+        }
+        cadence_observe(&mon->cadences[SYSMON_CADENCE_NETWORK], rate, ADAPTIVE_FLOOR_MBPS, delta, now, interval_ns);
+    }
+}
+
+// Feed the windows and anomaly detectors from the collectors sampled this
+// update; a collector that backed off adds nothing rather than repeating its
+// last value. Device series are indexed by table slot and tagged with the
+// slot generation, so a reused slot starts over.
+static void update_series(SystemMonitor *mon) {
+    unsigned long long now = mon->sample_ns;
+
+    // Seasonal slots follow local time of day, where load patterns live
+    time_t wall = time(NULL);
+    struct tm local;
+    if (localtime_r(&wall, &local)) {
+        long long of_day = local.tm_hour * 3600LL + local.tm_min * 60LL + local.tm_sec;
+        anomaly_bank_begin(&mon->anomalies, of_day);
+        anomaly_bank_begin(&mon->disk_anomalies, of_day);
+        anomaly_bank_begin(&mon->interface_anomalies, of_day);
+    }
+
+    if ((mon->sampled & SAMPLED(SYSMON_CADENCE_CPU)) && mon->cpu.valid) {
+        window_bank_push(&mon->windows, SYSTEM_WINDOW_CPU_USAGE, 0, mon->cpu.usage_percent, now);
+        anomaly_bank_push(&mon->anomalies, SYSTEM_WINDOW_CPU_USAGE, 0, mon->cpu.usage_percent);
+    }
+    if ((mon->sampled & SAMPLED(SYSMON_CADENCE_MEMORY)) && mon->memory.valid) {
+        window_bank_push(&mon->windows, SYSTEM_WINDOW_MEMORY_USAGE, 0, mon->memory.usage_percent, now);
+        window_bank_push(&mon->windows, SYSTEM_WINDOW_SWAP_USAGE, 0, mon->memory.swap_percent, now);
+        anomaly_bank_push(&mon->anomalies, SYSTEM_WINDOW_MEMORY_USAGE, 0, mon->memory.usage_percent);
+        anomaly_bank_push(&mon->anomalies, SYSTEM_WINDOW_SWAP_USAGE, 0, mon->memory.swap_percent);
+    }
+
+    for (int row = 0; (mon->sampled & SAMPLED(SYSMON_CADENCE_DISK)) && row < mon->disk_count; row++) {
+        const DiskStats *disk = sysmon_get_disk(mon, row);
+        int slot = stat_table_slot(&mon->disks, row);
+        if (!disk || !disk->valid || window_bank_reserve(&mon->disk_windows, slot + 1) != 0 ||
+            anomaly_bank_reserve(&mon->disk_anomalies, slot + 1) != 0) {
+            continue;
+        }
+
+        unsigned int generation = stat_table_generation(&mon->disks, slot);
+        window_bank_push(&mon->disk_windows, slot, generation, disk->usage_percent, now);
+        anomaly_bank_push(&mon->disk_anomalies, slot, generation, disk->usage_percent);
+    }
+
+    for (int row = 0; (mon->sampled & SAMPLED(SYSMON_CADENCE_NETWORK)) && row < mon->interface_count; row++) {
+        const NetworkStats *net = sysmon_get_interface(mon, row);
+        int slot = stat_table_slot(&mon->interfaces, row);
+        if (!net || !net->valid || window_bank_reserve(&mon->interface_windows, slot * 2 + 2) != 0 ||
+            anomaly_bank_reserve(&mon->interface_anomalies, slot * 2 + 2) != 0) {
+            continue;
+        }
+
+        unsigned int generation = stat_table_generation(&mon->interfaces, slot);
+        window_bank_push(&mon->interface_windows, slot * 2, generation, net->rx_rate_mbps, now);
+        window_bank_push(&mon->interface_windows, slot * 2 + 1, generation, net->tx_rate_mbps, now);
+        anomaly_bank_push(&mon->interface_anomalies, slot * 2, generation, net->rx_rate_mbps);
+        anomaly_bank_push(&mon->interface_anomalies, slot * 2 + 1, generation, net->tx_rate_mbps);
+    }
+}
+
+// Bank and index of a named series among those present now, NULL if none
+static AnomalyBank* find_series(SystemMonitor *mon, const char *name, int *index) {
+    for (int i = 0; i < SYSTEM_WINDOW_COUNT; i++) {
+        if (strcmp(name, system_series_names[i]) == 0) {
+            *index = i;
+            return &mon->anomalies;
+        }
+    }
+
+    char series[320];
+    for (int row = 0; row < mon->disk_count; row++) {
+        const DiskStats *disk = sysmon_get_disk(mon, row);
+        snprintf(series, sizeof(series), "disk.%s.usage", disk->mount_point);
+        if (strcmp(name, series) == 0) {
+            *index = stat_table_slot(&mon->disks, row);
+            return &mon->disk_anomalies;
+        }
+    }
+
+    for (int row = 0; row < mon->interface_count; row++) {
+        const NetworkStats *net = sysmon_get_interface(mon, row);
+        for (int transmit = 0; transmit < 2; transmit++) {
+            snprintf(series, sizeof(series), "net.%s.%s", net->interface_name, transmit ? "tx_rate" : "rx_rate");
+            if (strcmp(name, series) == 0) {
+                *index = stat_table_slot(&mon->interfaces, row) * 2 + transmit;
+                return &mon->interface_anomalies;
+            }
+        }
+    }
+
+    return NULL;
+}
+
+int sysmon_load_baseline(SystemMonitor *mon, const char *path) {
+    FILE *fp = fopen(path, "r");
+    if (!fp) return -1;
+
+    char line[512];
+    char name[320];
+    int slot;
+    unsigned int count;
+    double mean, var;
+
+    while (fgets(line, sizeof(line), fp)) {
+        if (sscanf(line, "%319s %d %u %lf %lf", name, &slot, &count, &mean, &var) != 5) continue;
+
+        int index;
+        AnomalyBank *bank = find_series(mon, name, &index);
+        if (bank) {
+            anomaly_bank_load(bank, index, slot, count, mean, var);
+        }
+    }
+
     fclose(fp);
+    return 0;
+}
+
+int sysmon_save_baseline(const SystemMonitor *mon, const char *path) {
+    FILE *fp = fopen(path, "w");
+    if (!fp) return -1;
+
+    int result = 0;
+    char series[320];
+
+    for (int i = 0; i < SYSTEM_WINDOW_COUNT; i++) {
+        result |= anomaly_bank_save(&mon->anomalies, i, system_series_names[i], fp);
+    }
+
+    for (int row = 0; row < mon->disk_count; row++) {
+        const DiskStats *disk = sysmon_get_disk(mon, row);
+        snprintf(series, sizeof(series), "disk.%s.usage", disk->mount_point);
+        result |= anomaly_bank_save(&mon->disk_anomalies, stat_table_slot(&mon->disks, row), series, fp);
+    }
+
+    for (int row = 0; row < mon->interface_count; row++) {
+        const NetworkStats *net = sysmon_get_interface(mon, row);
+        int slot = stat_table_slot(&mon->interfaces, row);
+        snprintf(series, sizeof(series), "net.%s.rx_rate", net->interface_name);
+        result |= anomaly_bank_save(&mon->interface_anomalies, slot * 2, series, fp);
+        snprintf(series, sizeof(series), "net.%s.tx_rate", net->interface_name);
+        result |= anomaly_bank_save(&mon->interface_anomalies, slot * 2 + 1, series, fp);
+    }
+
+    if (fclose(fp) != 0) result = -1;
+    return result ? -1 : 0;
+}
+
+void sysmon_update_all(SystemMonitor *mon) {
+    if (!mon || !mon->running) return;
     
-    if (ret != 8) {
-        cpu->valid = false;
+    // Update the statistics that are due, timing each collector
+    unsigned long long start = selfstat_now();
+    unsigned long long end;
+    unsigned long long interval_ns = mon->update_interval_ns;
+    mon->sample_ns = start;
+
+    mon->sampled = 0;
+    for (int i = 0; i < SYSMON_CADENCE_COUNT; i++) {
+        if (!mon->adaptive || cadence_due(&mon->cadences[i], start, interval_ns)) {
+            mon->sampled |= SAMPLED(i);
+        }
+    }
+    bool cpu_due = mon->sampled & SAMPLED(SYSMON_CADENCE_CPU);
+    bool network_due = mon->sampled & SAMPLED(SYSMON_CADENCE_NETWORK);
+
+    if (cpu_due) {
+        sysmon_update_cpu(mon);
+        end = selfstat_now();
+        selfstat_record(&mon->selfstat, SELFSTAT_CPU, end - start);
+        start = end;
+    }
+
+    if (mon->sampled & SAMPLED(SYSMON_CADENCE_MEMORY)) {
+        sysmon_update_memory(mon);
+        end = selfstat_now();
+        selfstat_record(&mon->selfstat, SELFSTAT_MEMORY, end - start);
+        start = end;
+    }
+
+    if (cpu_due) {
+        sysmon_update_kernel(mon);
+        end = selfstat_now();
+        selfstat_record(&mon->selfstat, SELFSTAT_KERNEL, end - start);
+        start = end;
+    }
+
+    if (mon->sampled & SAMPLED(SYSMON_CADENCE_DISK)) {
+        sysmon_update_disks(mon);
+        end = selfstat_now();
+        selfstat_record(&mon->selfstat, SELFSTAT_DISK, end - start);
+        start = end;
+    }
+
+    if (network_due) {
+        sysmon_update_network(mon);
+        end = selfstat_now();
+        selfstat_record(&mon->selfstat, SELFSTAT_NETWORK, end - start);
+        start = end;
+    }
+
+    if (cpu_due && mon->collect_processes) {
+        sysmon_update_processes(mon);
+        end = selfstat_now();
+        selfstat_record(&mon->selfstat, SELFSTAT_PROCESS, end - start);
+        start = end;
+    }
+
+    if (cpu_due && mon->collect_interrupts) {
+        sysmon_update_interrupts(mon);
+        end = selfstat_now();
+        selfstat_record(&mon->selfstat, SELFSTAT_INTERRUPTS, end - start);
+        start = end;
+    }
+
+    if (network_due && mon->collect_netstack) {
+        sysmon_update_netstack(mon);
+        end = selfstat_now();
+        selfstat_record(&mon->selfstat, SELFSTAT_NETSTACK, end - start);
+        start = end;
+    }
+
+    if (network_due && mon->collect_sockets) {
+        sysmon_update_sockets(mon);
+        end = selfstat_now();
+        selfstat_record(&mon->selfstat, SELFSTAT_SOCKETS, end - start);
+        start = end;
+    }
+
+    if (cpu_due && mon->collect_numa) {
+        sysmon_update_numa(mon);
+        selfstat_record(&mon->selfstat, SELFSTAT_NUMA, selfstat_now() - start);
+    }
+
+    if (mon->adaptive) {
+        observe_cadences(mon);
+    }
+    update_series(mon);
+    selfstat_tick(&mon->selfstat);
+}
+
+// Eight tick counters after the name of a cpu line; false if fewer
+static bool parse_cpu_ticks(const char *p, unsigned long long *ticks) {
+    for (int i = 0; i < CPU_COUNTER_COUNT; i++) {
+        char *end;
+        ticks[i] = strtoull(p, &end, 10);
+        if (end == p) return false;
+        p = end;
+    }
+    return true;
+}
+
+// Busy and total ticks of one cpuN line. A CPU seen for the first time
+// starts from its current ticks instead of reporting them all as a delta.
+static void set_per_cpu(CounterBank *bank, long cpu, const char *p) {
+    unsigned long long ticks[CPU_COUNTER_COUNT];
+    if (cpu < 0 || cpu >= SYSMON_MAX_CPUS || !parse_cpu_ticks(p, ticks)) return;
+
+    int base = (int)cpu * CPU_TICKS_COUNT;
+    bool fresh = base >= bank->count;
+    if (counter_bank_reserve(bank, base + CPU_TICKS_COUNT) != 0) return;
+
+    unsigned long long total = 0;
+    for (int i = 0; i < CPU_COUNTER_COUNT; i++) {
+        total += ticks[i];
+    }
+    unsigned long long busy = total - ticks[CPU_COUNTER_IDLE] - ticks[CPU_COUNTER_IOWAIT];
+    if (fresh) {
+        counter_bank_set_fresh(bank, base + CPU_TICKS_BUSY, busy);
+        counter_bank_set_fresh(bank, base + CPU_TICKS_TOTAL, total);
+    } else {
+        counter_bank_set(bank, base + CPU_TICKS_BUSY, busy);
+        counter_bank_set(bank, base + CPU_TICKS_TOTAL, total);
+    }
+}
+
+// One pass over /proc/stat for both the CPU and the kernel collectors:
+// the aggregate cpu line goes to ticks and the cpuN lines to the per-CPU
+// bank (both skipped when ticks is NULL), ctxt, intr and processes to the
+// kernel's stat_counters, which are then pending. The intr line can run
+// to many kilobytes, so every line is only looked at up to its first
+// value. False when the file cannot be read.
+static bool read_proc_stat(SystemMonitor *mon, unsigned long long *ticks, bool *has_ticks) {
+    KernelStats *kernel = &mon->kernel;
+    char path[512];
+    *has_ticks = false;
+    kernel->stat_pending = false;
+    if (procfile_read(sysmon_proc_path(mon, "stat", path, sizeof(path)),
+                      &mon->cpu.text, &mon->cpu.text_capacity) < 0) {
         return false;
     }
-    
-    // Calculate current totals
-    long total_time = user + nice + system + idle + iowait + irq + softirq + steal;
-    long idle_time = idle + iowait;
-    
-    cpu->user_time = user;
-    cpu->system_time = system;
-    cpu->idle_time = idle;
-    cpu->total_time = total_time;
-    
-    // Calculate usage percentage if we have previous data
-    if (cpu_initialized) {
-        long prev_total = prev_user + prev_nice + prev_system + prev_idle + prev_iowait + prev_irq + prev_softirq + prev_steal;
-        long prev_idle_total = prev_idle + prev_iowait;
-        
-        long total_diff = total_time - prev_total;
-        long idle_diff = idle_time - prev_idle_total;
-        
-        if (total_diff > 0) {
-            cpu->usage_percent = 100.0 * (1.0 - (float)idle_diff / total_diff);
+
+    // CPUs missing from the file (offline) hold still
+    CounterBank *per_cpu = &mon->cpu.per_cpu;
+    if (ticks) {
+        counter_bank_begin(per_cpu);
+        memcpy(per_cpu->current, per_cpu->previous, per_cpu->count * sizeof(unsigned long long));
+    }
+
+    int found = 0;
+    for (char *line = mon->cpu.text; line && *line; ) {
+        char *eol = strchr(line, '\n');
+        if (eol) *eol = '\0';
+
+        if (line[0] == 'c' && line[1] == 'p') {
+            if (ticks && line[2] == 'u' && line[3] == ' ') {
+                *has_ticks = parse_cpu_ticks(line + 4, ticks);
+            } else if (ticks && line[2] == 'u' && line[3] >= '0' && line[3] <= '9') {
+                char *p;
+                long cpu = strtol(line + 3, &p, 10);
+                set_per_cpu(per_cpu, cpu, p);
+            }
         } else {
-            cpu->usage_percent = 0.0;
+            char *space = strchr(line, ' ');
+            if (space) {
+                *space = '\0';
+                unsigned long long value = strtoull(space + 1, NULL, 10);
+                if (strcmp(line, "ctxt") == 0) {
+                    kernel->stat_counters[KERNEL_CONTEXT_SWITCHES] = value;
+                    found++;
+                } else if (strcmp(line, "intr") == 0) {
+                    kernel->stat_counters[KERNEL_INTERRUPTS] = value;
+                    found++;
+                } else if (strcmp(line, "processes") == 0) {
+                    kernel->stat_counters[KERNEL_FORKS] = value;
+                    found++;
+                } else if (strcmp(line, "procs_running") == 0) {
+                    kernel->procs_running = (long)value;
+                } else if (strcmp(line, "procs_blocked") == 0) {
+                    kernel->procs_blocked = (long)value;
+                }
+            }
         }
+
+        line = eol ? eol + 1 : NULL;
+    }
+
+    if (ticks) {
+        counter_bank_commit(per_cpu, selfstat_now());
+    }
+    kernel->stat_pending = found == 3;
+    return true;
+}
+
+// Usage of every CPU id over the last interval, from the per-CPU bank
+static void update_cpu_percent(CPUStats *cpu) {
+    int slots = cpu->per_cpu.count / CPU_TICKS_COUNT;
+    if (slots > cpu->cpu_slots) {
+        float *percent = realloc(cpu->cpu_percent, slots * sizeof(float));
+        if (!percent) return;
+        cpu->cpu_percent = percent;
+        cpu->cpu_slots = slots;
+    }
+
+    for (int i = 0; i < cpu->cpu_slots; i++) {
+        unsigned long long total = counter_bank_delta(&cpu->per_cpu, i * CPU_TICKS_COUNT + CPU_TICKS_TOTAL);
+        unsigned long long busy = counter_bank_delta(&cpu->per_cpu, i * CPU_TICKS_COUNT + CPU_TICKS_BUSY);
+        cpu->cpu_percent[i] = total > 0 ? 100.0f * (float)busy / (float)total : 0.0f;
+    }
+}
+
+bool sysmon_update_cpu(SystemMonitor *mon) {
+    if (!mon) return false;
+
+    CPUStats *cpu = &mon->cpu;
+
+    unsigned long long ticks[CPU_COUNTER_COUNT];
+    bool has_ticks;
+    if (!read_proc_stat(mon, ticks, &has_ticks) || !has_ticks) {
+        cpu->valid = false;
+        return false;
+    }
+
+    CounterBank *bank = &cpu->counters;
+    counter_bank_begin(bank);
+    unsigned long long total = 0;
+    for (int i = 0; i < CPU_COUNTER_COUNT; i++) {
+        counter_bank_set(bank, i, ticks[i]);
+        total += ticks[i];
+    }
+    counter_bank_commit(bank, selfstat_now());
+
+    cpu->user_time = (long)ticks[CPU_COUNTER_USER];
+    cpu->system_time = (long)ticks[CPU_COUNTER_SYSTEM];
+    cpu->idle_time = (long)ticks[CPU_COUNTER_IDLE];
+    cpu->total_time = (long)total;
+    update_cpu_percent(cpu);
+    
+    // Usage over the interval, from the tick deltas
+    unsigned long long total_diff = 0;
+    for (int i = 0; i < CPU_COUNTER_COUNT; i++) {
+        total_diff += counter_bank_delta(bank, i);
+    }
+    unsigned long long idle_diff = counter_bank_delta(bank, CPU_COUNTER_IDLE) +
+                                   counter_bank_delta(bank, CPU_COUNTER_IOWAIT);
+
+    if (total_diff > 0) {
+        cpu->usage_percent = 100.0 * (1.0 - (float)idle_diff / total_diff);
     } else {
         cpu->usage_percent = 0.0;
-        cpu_initialized = true;
     }
     
-    // Save current values for next calculation
-    prev_user = user;
-    prev_nice = nice;
-    prev_system = system;
-    prev_idle = idle;
-    prev_iowait = iowait;
-    prev_irq = irq;
-    prev_softirq = softirq;
-    prev_steal = steal;
-    
     cpu->valid = true;
     return true;
 }
 
-bool sysmon_update_memory(MemoryStats *memory) {
-    if (!memory) return false;
+// Key names in the same (strcmp) order as the enum, for binary search
+static const char *meminfo_names[MEMINFO_KEY_COUNT] = {
+#define MEMINFO_NAME(id, key) key,
+    MEMINFO_KEYS(MEMINFO_NAME)
+#undef MEMINFO_NAME
+};
+
+static int compare_meminfo_name(const void *key, const void *entry) {
+    return strcmp(key, *(const char *const *)entry);
+}
+
+bool sysmon_update_memory(SystemMonitor *mon) {
+    if (!mon) return false;
+
+    MemoryStats *memory = &mon->memory;
     
-    FILE *fp = fopen("/proc/meminfo", "r");
+    char path[512];
+    FILE *fp = fopen(sysmon_proc_path(mon, "meminfo", path, sizeof(path)), "r");
     if (!fp) {
         memory->valid = false;
         return false;
     }
+
+    memset(memory->values, 0, sizeof(memory->values));
+    memset(memory->present, 0, sizeof(memory->present));
     
+    // One table lookup per line: "Key:   value kB"
     char line[256];
-    long total = 0, free = 0, available = 0, buffers = 0, cached = 0;
-    
-    // Parse memory information
     while (fgets(line, sizeof(line), fp)) {
-        if (sscanf(line, "MemTotal: %ld kB", &total) == 1) {
-            continue;
-        }
-        if (sscanf(line, "MemFree: %ld kB", &free) == 1) {
-            continue;
-        }
-        if (sscanf(line, "MemAvailable: %ld kB", &available) == 1) {
-            continue;
-        }
-        if (sscanf(line, "Buffers: %ld kB", &buffers) == 1) {
-            continue;
-        }
-        if (sscanf(line, "Cached: %ld kB", &cached) == 1) {
-            continue;
-        }
+        char *colon = strchr(line, ':');
+        if (!colon) continue;
+        *colon = '\0';
+
+        const char **name = bsearch(line, meminfo_names, MEMINFO_KEY_COUNT,
+                                    sizeof(meminfo_names[0]), compare_meminfo_name);
+        if (!name) continue;
+
+        int key = (int)(name - meminfo_names);
+        memory->values[key] = strtoull(colon + 1, NULL, 10);
+        memory->present[key] = true;
     }
     
     fclose(fp);
-    
+
+    const unsigned long long *v = memory->values;
+    long total = (long)v[MEMINFO_MEM_TOTAL];
     if (total <= 0) {
         memory->valid = false;
         return false;
     }
-    
-    // Calculate memory statistics
+
+    // Derived figures as free(1) reports them
     memory->total_kb = total;
-    memory->free_kb = free;
-    memory->available_kb = available;
-    memory->buffers_kb = buffers;
-    memory->cached_kb = cached;
-    memory->used_kb = total - free - buffers - cached;
+    memory->free_kb = (long)v[MEMINFO_MEM_FREE];
+    memory->buffers_kb = (long)v[MEMINFO_BUFFERS];
+    memory->cached_kb = (long)(v[MEMINFO_CACHED] + v[MEMINFO_SRECLAIMABLE]);
+    memory->shared_kb = (long)v[MEMINFO_SHMEM];
+
+    // Kernels before 3.14 have no MemAvailable
+    if (memory->present[MEMINFO_MEM_AVAILABLE] && (long)v[MEMINFO_MEM_AVAILABLE] <= total) {
+        memory->available_kb = (long)v[MEMINFO_MEM_AVAILABLE];
+        memory->used_kb = total - memory->available_kb;
+    } else {
+        memory->available_kb = memory->free_kb;
+        memory->used_kb = total - memory->free_kb - memory->buffers_kb - memory->cached_kb;
+    }
+    if (memory->used_kb < 0) {
+        memory->used_kb = total - memory->free_kb;
+    }
     memory->usage_percent = (float)memory->used_kb / total * 100.0;
+
+    memory->swap_total_kb = (long)v[MEMINFO_SWAP_TOTAL];
+    memory->swap_free_kb = (long)v[MEMINFO_SWAP_FREE];
+    memory->swap_used_kb = memory->swap_total_kb - memory->swap_free_kb;
+    memory->swap_percent = memory->swap_total_kb > 0
+                         ? (float)memory->swap_used_kb / memory->swap_total_kb * 100.0f : 0.0f;
+
     memory->valid = true;
-    
     return true;
 }
 
-int sysmon_update_disks(DiskStats *disks, int max_disks) {
-    if (!disks || max_disks <= 0) return 0;
+unsigned long long sysmon_meminfo(const MemoryStats *memory, MeminfoKey key) {
+    if (!memory || (int)key < 0 || key >= MEMINFO_KEY_COUNT) return 0;
+    return memory->values[key];
+}
+
+const char* sysmon_meminfo_name(MeminfoKey key) {
+    if ((int)key < 0 || key >= MEMINFO_KEY_COUNT) return "unknown";
+    return meminfo_names[key];
+}
+
+// Decode the octal escapes (\040 for space) used in the mounts table
+static void unescape_mount_field(char *field) {
+    char *src = field, *dst = field;
+
+    while (*src) {
+        if (src[0] == '\\' && src[1] >= '0' && src[1] <= '3' &&
+            src[2] >= '0' && src[2] <= '7' && src[3] >= '0' && src[3] <= '7') {
+            *dst++ = (char)(((src[1] - '0') << 6) | ((src[2] - '0') << 3) | (src[3] - '0'));
+            src += 4;
+        } else {
+            *dst++ = *src++;
+        }
+    }
+
+    *dst = '\0';
+}
+
+int sysmon_update_disks(SystemMonitor *mon) {
+    if (!mon) return 0;
+
+    StatTable *disks = &mon->disks;
     
-    FILE *fp = popen("df -k 2>/dev/null", "r");
-    if (!fp) return 0;
+    // Mount table plus statvfs, instead of spawning df every sample
+    char path[512];
+    FILE *fp = fopen(sysmon_proc_path(mon, "mounts", path, sizeof(path)), "r");
+    if (!fp) return mon->disk_count;
     
     char line[512];
-    int count = 0;
-    
-    // Skip header line
-    if (fgets(line, sizeof(line), fp) == NULL) {
-        pclose(fp);
-        return 0;
-    }
+    stat_table_begin(disks);
     
     // Parse each filesystem
-    while (fgets(line, sizeof(line), fp) && count < max_disks) {
+    while (fgets(line, sizeof(line), fp)) {
         char device[64], mount_point[128];
-        long total, used, available;
-        int usage_percent;
-        
-        // Parse the df output
-        int ret = sscanf(line, "%63s %ld %ld %ld %d%% %127s",
-                         device, &total, &used, &available, &usage_percent, mount_point);
         
-        if (ret == 6) {
-            // Skip special filesystems
-            if (strncmp(device, "/dev/", 5) != 0 && 
-                strncmp(device, "tmpfs", 5) != 0 &&
-                strncmp(device, "udev", 4) != 0) {
-                continue;
-            }
-            
-            // Fill disk stats
-            strncpy(disks[count].device, device, sizeof(disks[count].device) - 1);
-            disks[count].device[sizeof(disks[count].device) - 1] = '\0';
-            
-            strncpy(disks[count].mount_point, mount_point, sizeof(disks[count].mount_point) - 1);
-            disks[count].mount_point[sizeof(disks[count].mount_point) - 1] = '\0';
-            
-            disks[count].total_kb = total;
-            disks[count].used_kb = used;
-            disks[count].available_kb = available;
-            disks[count].usage_percent = usage_percent;
-            disks[count].valid = true;
-            
-            count++;
+        // Parse the mounts entry
+        if (sscanf(line, "%63s %127s", device, mount_point) != 2) {
+            continue;
+        }
+
+        // Skip special filesystems
+        if (strncmp(device, "/dev/", 5) != 0 && 
+            strncmp(device, "tmpfs", 5) != 0 &&
+            strncmp(device, "udev", 4) != 0) {
+            continue;
         }
+
+        unescape_mount_field(device);
+        unescape_mount_field(mount_point);
+
+        struct statvfs fs;
+        if (statvfs(mount_point, &fs) != 0 || fs.f_blocks == 0) {
+            continue;
+        }
+            
+        DiskStats *disk = stat_table_upsert(disks, mount_point, NULL, NULL);
+        if (!disk) continue;
+
+        // Fill disk stats
+        strncpy(disk->device, device, sizeof(disk->device) - 1);
+        disk->device[sizeof(disk->device) - 1] = '\0';
+
+        // Same figures as df -k
+        unsigned long long frsize = fs.f_frsize ? fs.f_frsize : fs.f_bsize;
+        long total = (long)(fs.f_blocks * frsize / 1024);
+        long used = (long)((fs.f_blocks - fs.f_bfree) * frsize / 1024);
+        long available = (long)(fs.f_bavail * frsize / 1024);
+
+        disk->total_kb = total;
+        disk->used_kb = used;
+        disk->available_kb = available;
+        disk->usage_percent = (used + available) > 0 ? 100.0f * used / (used + available) : 0.0f;
+        disk->valid = true;
     }
     
-    pclose(fp);
-    return count;
+    fclose(fp);
+
+    // Release mounts that went away
+    stat_table_end(disks);
+    mon->disk_count = stat_table_count(disks);
+    return mon->disk_count;
 }
 
-int sysmon_update_network(NetworkStats *interfaces, int max_interfaces) {
-    if (!interfaces || max_interfaces <= 0) return 0;
+int sysmon_update_network(SystemMonitor *mon) {
+    if (!mon) return 0;
+
+    StatTable *interfaces = &mon->interfaces;
+    CounterBank *counters = &mon->interface_counters;
     
-    FILE *fp = fopen("/proc/net/dev", "r");
-    if (!fp) return 0;
+    char path[512];
+    FILE *fp = fopen(sysmon_proc_path(mon, "net/dev", path, sizeof(path)), "r");
+    if (!fp) return mon->interface_count;
     
     char line[256];
-    int count = 0;
-    time_t current_time = time(NULL);
-    double time_diff = network_initialized ? (double)(current_time - prev_network_time) : 1.0;
     
     // Skip first two header lines
-    fgets(line, sizeof(line), fp);
-    fgets(line, sizeof(line), fp);
+    if (fgets(line, sizeof(line), fp) == NULL || fgets(line, sizeof(line), fp) == NULL) {
+        fclose(fp);
+        return mon->interface_count;
+    }
+
+    stat_table_begin(interfaces);
+    counter_bank_begin(counters);
     
     // Parse network interface data
-    while (fgets(line, sizeof(line), fp) && count < max_interfaces) {
+    while (fgets(line, sizeof(line), fp)) {
         char interface_name[32];
         unsigned long long rx_bytes, tx_bytes, rx_packets, tx_packets;
         unsigned long long dummy;
@@ -257,55 +907,236 @@ int sysmon_update_network(NetworkStats *interfaces, int max_interfaces) {
             // Skip loopback interface
             if (strcmp(interface_name, "lo") == 0) continue;
             
-            // Fill interface stats
-            strncpy(interfaces[count].interface_name, interface_name, sizeof(interfaces[count].interface_name) - 1);
-            interfaces[count].interface_name[sizeof(interfaces[count].interface_name) - 1] = '\0';
-            
-            interfaces[count].rx_bytes = rx_bytes;
-            interfaces[count].tx_bytes = tx_bytes;
-            interfaces[count].rx_packets = rx_packets;
-            interfaces[count].tx_packets = tx_packets;
-            
-            // Calculate rates if we have previous data
-            if (network_initialized && time_diff > 0) {
-                // Find previous stats for this interface
-                NetworkStats *prev = NULL;
-                for (int i = 0; i < 16; i++) {
-                    if (strcmp(prev_network_stats[i].interface_name, interface_name) == 0) {
-                        prev = &prev_network_stats[i];
-                        break;
-                    }
-                }
-                
-                if (prev) {
-                    // Calculate byte rate in Mbps
-                    unsigned long long rx_diff = rx_bytes - prev->rx_bytes;
-                    unsigned long long tx_diff = tx_bytes - prev->tx_bytes;
-                    
-                    interfaces[count].rx_rate_mbps = (double)rx_diff / time_diff / 1024.0 / 1024.0 * 8.0;
-                    interfaces[count].tx_rate_mbps = (double)tx_diff / time_diff / 1024.0 / 1024.0 * 8.0;
-                } else {
-                    interfaces[count].rx_rate_mbps = 0.0;
-                    interfaces[count].tx_rate_mbps = 0.0;
-                }
+            // Entries persist across samples and keep their slot, which
+            // also indexes their counters in the bank
+            bool created;
+            int slot;
+            NetworkStats *net = stat_table_upsert(interfaces, interface_name, &created, &slot);
+            if (!net) continue;
+
+            int base = slot * NET_COUNTER_COUNT;
+            if (counter_bank_reserve(counters, base + NET_COUNTER_COUNT) != 0) continue;
+
+            net->rx_bytes = rx_bytes;
+            net->tx_bytes = tx_bytes;
+            net->rx_packets = rx_packets;
+            net->tx_packets = tx_packets;
+
+            if (created) {
+                counter_bank_set_fresh(counters, base + NET_COUNTER_RX_BYTES, rx_bytes);
+                counter_bank_set_fresh(counters, base + NET_COUNTER_TX_BYTES, tx_bytes);
+                counter_bank_set_fresh(counters, base + NET_COUNTER_RX_PACKETS, rx_packets);
+                counter_bank_set_fresh(counters, base + NET_COUNTER_TX_PACKETS, tx_packets);
             } else {
-                interfaces[count].rx_rate_mbps = 0.0;
-                interfaces[count].tx_rate_mbps = 0.0;
+                counter_bank_set(counters, base + NET_COUNTER_RX_BYTES, rx_bytes);
+                counter_bank_set(counters, base + NET_COUNTER_TX_BYTES, tx_bytes);
+                counter_bank_set(counters, base + NET_COUNTER_RX_PACKETS, rx_packets);
+                counter_bank_set(counters, base + NET_COUNTER_TX_PACKETS, tx_packets);
             }
-            
-            interfaces[count].valid = true;
-            count++;
+            net->valid = true;
         }
     }
     
     fclose(fp);
-    
-    // Save current stats for next calculation
-    memcpy(prev_network_stats, interfaces, sizeof(NetworkStats) * count);
-    prev_network_time = current_time;
-    network_initialized = true;
-    
-    return count;
+
+    // Release interfaces that went away
+    stat_table_end(interfaces);
+
+    // Rates for every interface in one pass over the bank
+    counter_bank_commit(counters, selfstat_now());
+    for (int row = 0; row < stat_table_count(interfaces); row++) {
+        NetworkStats *net = stat_table_row(interfaces, row);
+        int base = stat_table_slot(interfaces, row) * NET_COUNTER_COUNT;
+
+        // Byte rate in Mbps
+        net->rx_rate_mbps = counter_bank_rate(counters, base + NET_COUNTER_RX_BYTES) / 1024.0 / 1024.0 * 8.0;
+        net->tx_rate_mbps = counter_bank_rate(counters, base + NET_COUNTER_TX_BYTES) / 1024.0 / 1024.0 * 8.0;
+    }
+
+    mon->interface_count = stat_table_count(interfaces);
+    return mon->interface_count;
+}
+
+int sysmon_update_processes(SystemMonitor *mon) {
+    if (!mon) return 0;
+
+    // The first scan after a pause only sets the CPU baseline
+    unsigned long long now = selfstat_now();
+    unsigned long long elapsed = mon->process_sample_ns ? now - mon->process_sample_ns : 0;
+    mon->process_sample_ns = now;
+
+    mon->process_count = process_update_all(&mon->processes, &mon->process_scan, mon->proc_root, elapsed);
+    return mon->process_count;
+}
+
+bool sysmon_update_interrupts(SystemMonitor *mon) {
+    return mon && interrupts_update(&mon->interrupts, mon->proc_root, selfstat_now());
+}
+
+bool sysmon_update_netstack(SystemMonitor *mon) {
+    return mon && netstack_update(&mon->netstack, mon->proc_root, selfstat_now());
+}
+
+// Sockets come from netlink, so the proc root does not apply
+bool sysmon_update_sockets(SystemMonitor *mon) {
+    return mon && sockdiag_update(&mon->sockets);
+}
+
+bool sysmon_update_numa(SystemMonitor *mon) {
+    return mon && numa_update(&mon->numa, mon->sys_root, mon->cpu.cpu_percent, mon->cpu.cpu_slots,
+                              selfstat_now());
+}
+
+static const char *kernel_counter_names[KERNEL_COUNTER_COUNT] = {
+    [KERNEL_CONTEXT_SWITCHES] = "Context switches",
+    [KERNEL_INTERRUPTS]       = "Interrupts",
+    [KERNEL_FORKS]            = "Forks",
+    [KERNEL_PAGE_FAULTS]      = "Page faults",
+    [KERNEL_MAJOR_FAULTS]     = "Major faults",
+    [KERNEL_SWAP_IN]          = "Swap in",
+    [KERNEL_SWAP_OUT]         = "Swap out",
+    [KERNEL_PAGES_SCANNED]    = "Pages scanned",
+    [KERNEL_PAGES_STOLEN]     = "Pages reclaimed",
+};
+
+// /proc/vmstat keys feeding each counter. Reclaim is split by reclaimer
+// (and by zone on old kernels), so those are summed by prefix; the anon/file
+// split and direct_throttle would double count.
+typedef struct {
+    const char *key;
+    bool prefix;
+    KernelCounter counter;
+} VmstatKey;
+
+static const VmstatKey vmstat_keys[] = {
+    { "pgfault",           false, KERNEL_PAGE_FAULTS },
+    { "pgmajfault",        false, KERNEL_MAJOR_FAULTS },
+    { "pswpin",            false, KERNEL_SWAP_IN },
+    { "pswpout",           false, KERNEL_SWAP_OUT },
+    { "pgscan_kswapd",     true,  KERNEL_PAGES_SCANNED },
+    { "pgscan_direct",     true,  KERNEL_PAGES_SCANNED },
+    { "pgscan_khugepaged", true,  KERNEL_PAGES_SCANNED },
+    { "pgscan_proactive",  true,  KERNEL_PAGES_SCANNED },
+    { "pgsteal_kswapd",    true,  KERNEL_PAGES_STOLEN },
+    { "pgsteal_direct",    true,  KERNEL_PAGES_STOLEN },
+    { "pgsteal_khugepaged", true, KERNEL_PAGES_STOLEN },
+    { "pgsteal_proactive", true,  KERNEL_PAGES_STOLEN },
+};
+
+static bool read_vmstat_counters(const SystemMonitor *mon, unsigned long long *counters) {
+    char path[512];
+    FILE *fp = fopen(sysmon_proc_path(mon, "vmstat", path, sizeof(path)), "r");
+    if (!fp) return false;
+
+    char line[128];
+    while (fgets(line, sizeof(line), fp)) {
+        // Everything of interest starts with "pg" or "ps"
+        if (line[0] != 'p' || (line[1] != 'g' && line[1] != 's')) continue;
+
+        char *space = strchr(line, ' ');
+        if (!space) continue;
+        *space = '\0';
+
+        for (size_t i = 0; i < sizeof(vmstat_keys) / sizeof(vmstat_keys[0]); i++) {
+            const VmstatKey *key = &vmstat_keys[i];
+            bool match = key->prefix ? strncmp(line, key->key, strlen(key->key)) == 0 &&
+                                       strcmp(line, "pgscan_direct_throttle") != 0
+                                     : strcmp(line, key->key) == 0;
+            if (match) {
+                unsigned long long value = strtoull(space + 1, NULL, 10);
+                if (key->prefix) {
+                    counters[key->counter] += value;
+                } else {
+                    counters[key->counter] = value;
+                }
+                break;
+            }
+        }
+    }
+
+    fclose(fp);
+    return true;
+}
+
+bool sysmon_update_kernel(SystemMonitor *mon) {
+    if (!mon) return false;
+
+    KernelStats *kernel = &mon->kernel;
+
+    // The CPU collector's pass normally left the /proc/stat counters
+    if (!kernel->stat_pending) {
+        bool has_ticks;
+        if (!read_proc_stat(mon, NULL, &has_ticks) || !kernel->stat_pending) {
+            kernel->valid = false;
+            return false;
+        }
+    }
+    kernel->stat_pending = false;
+
+    unsigned long long counters[KERNEL_COUNTER_COUNT] = {0};
+    memcpy(counters, kernel->stat_counters, sizeof(counters));
+    kernel->has_vmstat = read_vmstat_counters(mon, counters);
+
+    CounterBank *bank = &kernel->counters;
+    counter_bank_begin(bank);
+    for (int i = 0; i < KERNEL_COUNTER_COUNT; i++) {
+        counter_bank_set(bank, i, counters[i]);
+    }
+    counter_bank_commit(bank, selfstat_now());
+
+    kernel->valid = true;
+    return true;
+}
+
+const char* sysmon_kernel_counter_name(KernelCounter counter) {
+    if ((int)counter < 0 || counter >= KERNEL_COUNTER_COUNT) return "unknown";
+    return kernel_counter_names[counter];
+}
+
+const DiskStats* sysmon_get_disk(const SystemMonitor *mon, int index) {
+    return stat_table_row(&mon->disks, index);
+}
+
+const NetworkStats* sysmon_get_interface(const SystemMonitor *mon, int index) {
+    return stat_table_row(&mon->interfaces, index);
+}
+
+ProcessStats* sysmon_get_process(SystemMonitor *mon, int index) {
+    return stat_table_row(&mon->processes, index);
+}
+
+bool sysmon_window_stats(const SystemMonitor *mon, SystemWindow window, WindowStats *stats) {
+    return window_bank_stats(&mon->windows, window, stats);
+}
+
+bool sysmon_disk_window(const SystemMonitor *mon, int index, WindowStats *stats) {
+    if (index < 0 || index >= mon->disk_count) return false;
+    return window_bank_stats(&mon->disk_windows, stat_table_slot(&mon->disks, index), stats);
+}
+
+bool sysmon_interface_window(const SystemMonitor *mon, int index, bool transmit, WindowStats *stats) {
+    if (index < 0 || index >= mon->interface_count) return false;
+    int slot = stat_table_slot(&mon->interfaces, index);
+    return window_bank_stats(&mon->interface_windows, slot * 2 + (transmit ? 1 : 0), stats);
+}
+
+bool sysmon_anomaly(const SystemMonitor *mon, SystemWindow series, AnomalyState *state) {
+    return anomaly_bank_state(&mon->anomalies, series, state);
+}
+
+bool sysmon_disk_anomaly(const SystemMonitor *mon, int index, AnomalyState *state) {
+    if (index < 0 || index >= mon->disk_count) return false;
+    return anomaly_bank_state(&mon->disk_anomalies, stat_table_slot(&mon->disks, index), state);
+}
+
+bool sysmon_interface_anomaly(const SystemMonitor *mon, int index, bool transmit, AnomalyState *state) {
+    if (index < 0 || index >= mon->interface_count) return false;
+    int slot = stat_table_slot(&mon->interfaces, index);
+    return anomaly_bank_state(&mon->interface_anomalies, slot * 2 + (transmit ? 1 : 0), state);
+}
+
+unsigned int sysmon_process_details(const SystemMonitor *mon, ProcessStats *proc, unsigned int mask) {
+    return process_fetch_details(proc, mon->proc_root, mask, selfstat_now());
 }
 
 void sysmon_format_bytes(unsigned long long bytes, char *buffer, size_t buffer_size) {
@@ -339,6 +1170,63 @@ void sysmon_format_rate(double rate_mbps, char *buffer, size_t buffer_size) {
     }
 }
 
+void sysmon_format_duration(unsigned long long ns, char *buffer, size_t buffer_size) {
+    if (!buffer || buffer_size == 0) return;
+    
+    if (ns < 1000ULL) {
+        snprintf(buffer, buffer_size, "%llu ns", ns);
+    } else if (ns < 1000000ULL) {
+        snprintf(buffer, buffer_size, "%.1f us", ns / 1e3);
+    } else if (ns < 1000000000ULL) {
+        snprintf(buffer, buffer_size, "%.1f ms", ns / 1e6);
+    } else {
+        snprintf(buffer, buffer_size, "%.2f s", ns / 1e9);
+    }
+}
+
+bool sysmon_parse_duration(const char *text, unsigned long long *ns) {
+    if (!text || !ns) return false;
+
+    char *end;
+    errno = 0;
+    double number = strtod(text, &end);
+    if (end == text || errno != 0 || number < 0) return false;
+
+    double scale;
+    if (*end == '\0' || strcmp(end, "s") == 0) scale = NS_PER_SEC;
+    else if (strcmp(end, "ms") == 0) scale = NS_PER_MS;
+    else if (strcmp(end, "m") == 0) scale = 60.0 * NS_PER_SEC;
+    else if (strcmp(end, "h") == 0) scale = 3600.0 * NS_PER_SEC;
+    else return false;
+
+    *ns = (unsigned long long)(number * scale);
+    return true;
+}
+
+bool sysmon_parse_size(const char *text, unsigned long long *bytes) {
+    if (!text || !bytes) return false;
+
+    char *end;
+    errno = 0;
+    double number = strtod(text, &end);
+    if (end == text || errno != 0 || number < 0) return false;
+
+    // Binary multiples, with or without a trailing B
+    double scale = 1.0;
+    switch (*end) {
+        case 'k':
+        case 'K': scale = 1024.0; end++; break;
+        case 'M': scale = 1024.0 * 1024.0; end++; break;
+        case 'G': scale = 1024.0 * 1024.0 * 1024.0; end++; break;
+        default: break;
+    }
+    if (*end == 'B') end++;
+    if (*end != '\0') return false;
+
+    *bytes = (unsigned long long)(number * scale);
+    return true;
+}
+
 const char* sysmon_get_error_string(void) {
     return "System monitoring error";
 }
\ No newline at end of file
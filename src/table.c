@@ -0,0 +1,309 @@
+#include "table.h"
+#include <stdlib.h>
+#include <string.h>
+
+#define STAT_TABLE_MIN_INDEX 64
+
+// FNV-1a over the stored (possibly truncated) form of the key
+static unsigned int hash_key(const char *key, size_t max_len) {
+    unsigned int hash = 2166136261u;
+    for (size_t i = 0; i < max_len && key[i]; i++) {
+        hash ^= (unsigned char)key[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
+
+static char* entry_key(const StatTable *table, int slot) {
+    return (char *)stat_table_entry(table, slot) + table->key_offset;
+}
+
+// Index position holding the key, or -1 when absent
+static int index_find(const StatTable *table, const char *key, unsigned int hash) {
+    if (!table->index) return -1;
+
+    unsigned int mask = table->index_capacity - 1;
+    unsigned int pos = hash & mask;
+
+    while (table->index[pos] >= 0) {
+        int slot = table->index[pos];
+        if (table->slots[slot].hash == hash &&
+            strncmp(entry_key(table, slot), key, table->key_size - 1) == 0) {
+            return (int)pos;
+        }
+        pos = (pos + 1) & mask;
+    }
+
+    return -1;
+}
+
+static void index_insert(StatTable *table, int slot) {
+    unsigned int mask = table->index_capacity - 1;
+    unsigned int pos = table->slots[slot].hash & mask;
+
+    while (table->index[pos] >= 0) {
+        pos = (pos + 1) & mask;
+    }
+
+    table->index[pos] = slot;
+    table->index_used++;
+}
+
+// Linear-probing removal with backward shift, so no tombstones build up
+// when interfaces come and go
+static void index_remove(StatTable *table, int pos) {
+    unsigned int mask = table->index_capacity - 1;
+    unsigned int hole = pos;
+    unsigned int next = pos;
+
+    table->index[hole] = -1;
+    table->index_used--;
+
+    for (;;) {
+        next = (next + 1) & mask;
+        int slot = table->index[next];
+        if (slot < 0) break;
+
+        // Move the entry back if its home position is not between the hole
+        // and its current position
+        unsigned int home = table->slots[slot].hash & mask;
+        bool movable = (hole <= next) ? (home <= hole || home > next)
+                                      : (home <= hole && home > next);
+        if (movable) {
+            table->index[hole] = slot;
+            table->index[next] = -1;
+            hole = next;
+        }
+    }
+}
+
+// Keep the load factor at or below one half
+static bool index_reserve(StatTable *table, int count) {
+    if (table->index && count * 2 <= table->index_capacity) return true;
+
+    int capacity = table->index_capacity ? table->index_capacity : STAT_TABLE_MIN_INDEX;
+    while (count * 2 > capacity) capacity *= 2;
+
+    int *index = malloc(capacity * sizeof(int));
+    if (!index) return false;
+
+    free(table->index);
+    table->index = index;
+    table->index_capacity = capacity;
+    table->index_used = 0;
+    memset(table->index, -1, capacity * sizeof(int));
+
+    for (int slot = 0; slot < table->num_slots; slot++) {
+        if (table->slots[slot].in_use) {
+            index_insert(table, slot);
+        }
+    }
+
+    return true;
+}
+
+// Add one arena chunk and grow the per-slot arrays to match
+static bool add_chunk(StatTable *table) {
+    int capacity = (table->num_chunks + 1) * STAT_TABLE_CHUNK;
+
+    unsigned char **chunks = realloc(table->chunks, (table->num_chunks + 1) * sizeof(unsigned char *));
+    if (!chunks) return false;
+    table->chunks = chunks;
+
+    StatSlot *slots = realloc(table->slots, capacity * sizeof(StatSlot));
+    if (!slots) return false;
+    table->slots = slots;
+    memset(&table->slots[capacity - STAT_TABLE_CHUNK], 0, STAT_TABLE_CHUNK * sizeof(StatSlot));
+
+    int *free_slots = realloc(table->free_slots, capacity * sizeof(int));
+    if (!free_slots) return false;
+    table->free_slots = free_slots;
+
+    int *rows = realloc(table->rows, capacity * sizeof(int));
+    if (!rows) return false;
+    table->rows = rows;
+
+    int *prev_rows = realloc(table->prev_rows, capacity * sizeof(int));
+    if (!prev_rows) return false;
+    table->prev_rows = prev_rows;
+    table->rows_capacity = capacity;
+
+    unsigned char *chunk = calloc(STAT_TABLE_CHUNK, table->entry_size);
+    if (!chunk) return false;
+    table->chunks[table->num_chunks++] = chunk;
+
+    return true;
+}
+
+static int alloc_slot(StatTable *table) {
+    if (table->num_free > 0) {
+        return table->free_slots[--table->num_free];
+    }
+
+    if (table->num_slots >= table->num_chunks * STAT_TABLE_CHUNK && !add_chunk(table)) {
+        return -1;
+    }
+
+    return table->num_slots++;
+}
+
+int stat_table_init(StatTable *table, size_t entry_size, size_t key_offset, size_t key_size) {
+    if (!table || entry_size == 0 || key_size < 2 || key_offset + key_size > entry_size) {
+        return -1;
+    }
+
+    memset(table, 0, sizeof(StatTable));
+    table->entry_size = entry_size;
+    table->key_offset = key_offset;
+    table->key_size = key_size;
+
+    return index_reserve(table, STAT_TABLE_MIN_INDEX / 2) ? 0 : -1;
+}
+
+void stat_table_free(StatTable *table) {
+    if (!table) return;
+
+    for (int i = 0; i < table->num_chunks; i++) {
+        free(table->chunks[i]);
+    }
+
+    free(table->chunks);
+    free(table->slots);
+    free(table->index);
+    free(table->free_slots);
+    free(table->rows);
+    free(table->prev_rows);
+    memset(table, 0, sizeof(StatTable));
+}
+
+void stat_table_begin(StatTable *table) {
+    if (!table) return;
+
+    int *rows = table->prev_rows;
+    table->prev_rows = table->rows;
+    table->rows = rows;
+    table->num_prev_rows = table->num_rows;
+    table->num_rows = 0;
+    table->epoch++;
+}
+
+void* stat_table_upsert(StatTable *table, const char *key, bool *created, int *slot_out) {
+    if (created) *created = false;
+    if (slot_out) *slot_out = -1;
+    if (!table || !key) return NULL;
+
+    unsigned int hash = hash_key(key, table->key_size - 1);
+    int pos = index_find(table, key, hash);
+    int slot;
+
+    if (pos >= 0) {
+        slot = table->index[pos];
+        if (slot_out) *slot_out = slot;
+        if (table->slots[slot].epoch == table->epoch) {
+            return stat_table_entry(table, slot); // Duplicate within a sample
+        }
+    } else {
+        if (!index_reserve(table, table->index_used + 1)) return NULL;
+
+        slot = alloc_slot(table);
+        if (slot < 0) return NULL;
+        if (slot_out) *slot_out = slot;
+
+        unsigned char *entry = stat_table_entry(table, slot);
+        memset(entry, 0, table->entry_size);
+        strncpy((char *)entry + table->key_offset, key, table->key_size - 1);
+
+        table->slots[slot].hash = hash;
+        table->slots[slot].generation++;
+        table->slots[slot].in_use = true;
+        index_insert(table, slot);
+
+        if (created) *created = true;
+    }
+
+    table->slots[slot].epoch = table->epoch;
+    table->rows[table->num_rows++] = slot;
+
+    return stat_table_entry(table, slot);
+}
+
+void stat_table_cancel(StatTable *table, int slot, bool created) {
+    if (!table || table->num_rows == 0 || table->rows[table->num_rows - 1] != slot) return;
+
+    table->num_rows--;
+    StatSlot *meta = &table->slots[slot];
+    if (!created) {
+        // Every known entry was in the previous sample, so the sweep finds it
+        meta->epoch = table->epoch - 1;
+        return;
+    }
+
+    int pos = index_find(table, entry_key(table, slot), meta->hash);
+    if (pos >= 0) {
+        index_remove(table, pos);
+    }
+    meta->in_use = false;
+    table->free_slots[table->num_free++] = slot;
+}
+
+void stat_table_end(StatTable *table) {
+    if (!table) return;
+
+    // Only entries present last time can have departed
+    for (int i = 0; i < table->num_prev_rows; i++) {
+        int slot = table->prev_rows[i];
+        StatSlot *meta = &table->slots[slot];
+
+        if (!meta->in_use || meta->epoch == table->epoch) continue;
+
+        int pos = index_find(table, entry_key(table, slot), meta->hash);
+        if (pos >= 0) {
+            index_remove(table, pos);
+        }
+
+        meta->in_use = false;
+        table->free_slots[table->num_free++] = slot;
+    }
+
+    table->num_prev_rows = 0;
+}
+
+void* stat_table_find(const StatTable *table, const char *key) {
+    int slot = stat_table_find_slot(table, key);
+    return slot >= 0 ? stat_table_entry(table, slot) : NULL;
+}
+
+int stat_table_find_slot(const StatTable *table, const char *key) {
+    if (!table || !key) return -1;
+
+    int pos = index_find(table, key, hash_key(key, table->key_size - 1));
+    return pos >= 0 ? table->index[pos] : -1;
+}
+
+bool stat_table_slot_valid(const StatTable *table, int slot, unsigned int generation) {
+    return table && slot >= 0 && slot < table->num_slots &&
+           table->slots[slot].in_use && table->slots[slot].generation == generation;
+}
+
+unsigned int stat_table_generation(const StatTable *table, int slot) {
+    if (!table || slot < 0 || slot >= table->num_slots) return 0;
+    return table->slots[slot].generation;
+}
+
+int stat_table_count(const StatTable *table) {
+    return table ? table->num_rows : 0;
+}
+
+void* stat_table_row(const StatTable *table, int row) {
+    if (!table || row < 0 || row >= table->num_rows) return NULL;
+    return stat_table_entry(table, table->rows[row]);
+}
+
+void* stat_table_entry(const StatTable *table, int slot) {
+    return table->chunks[slot / STAT_TABLE_CHUNK] + (size_t)(slot % STAT_TABLE_CHUNK) * table->entry_size;
+}
+
+int stat_table_slot(const StatTable *table, int row) {
+    if (!table || row < 0 || row >= table->num_rows) return -1;
+    return table->rows[row];
+}
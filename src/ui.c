@@ -1,13 +1,89 @@
+#define _POSIX_C_SOURCE 200809L
+
 #include "ui.h"
+#include "sysmon.h"
 #include <ncurses.h>
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
 #include <signal.h>
+#include <math.h>
+#include <fcntl.h>
+#include <unistd.h>
+
+// Output rate is measured over windows of at least this length, long enough
+// to take in the catch-up refreshes of held panels
+#define UI_RATE_WINDOW_NS 5000000000ULL
 
 // Global layout manager instance
 UILayout g_layout = {0};
 
+// Low-bandwidth mode, see ui_set_low_bandwidth
+static int frame_byte_cap = 0;
+static double coalesce_percent = 0.0;
+static bool low_bandwidth = false;
+
+// Terminal output meter. ncurses writes straight to the terminal fd, so the
+// bytes are taken from the wchar counter of /proc/self/io around each
+// flush; nothing else in the process writes between the two reads.
+static int io_fd = -1;
+static unsigned long long output_bytes = 0;
+static unsigned long long rate_start_ns = 0;
+static unsigned long long rate_start_bytes = 0;
+static double output_rate = -1.0;
+
+static unsigned long long read_wchar(void) {
+    char buffer[512];
+    ssize_t len = pread(io_fd, buffer, sizeof(buffer) - 1, 0);
+    if (len <= 0) return 0;
+    buffer[len] = '\0';
+
+    unsigned long long value = 0;
+    const char *field = strstr(buffer, "wchar:");
+    if (field) sscanf(field, "wchar: %llu", &value);
+    return value;
+}
+
+// Push pending window updates to the terminal; returns the bytes written
+static unsigned long long ui_flush(void) {
+    if (io_fd < 0) {
+        doupdate();
+        return 0;
+    }
+
+    unsigned long long before = read_wchar();
+    doupdate();
+    unsigned long long written = read_wchar() - before;
+    output_bytes += written;
+    return written;
+}
+
+// Output of a window's pending changes when the meter is missing: one byte
+// per cell on each touched line. Must run before the window is refreshed.
+static unsigned long long ui_estimate_bytes(WINDOW *win) {
+    unsigned long long cells = 0;
+    int rows = getmaxy(win);
+    int cols = getmaxx(win);
+    for (int y = 0; y < rows; y++) {
+        if (is_linetouched(win, y)) cells += (unsigned long long)cols;
+    }
+    return cells;
+}
+
+static void update_output_rate(void) {
+    if (io_fd < 0) return;
+
+    unsigned long long now = selfstat_now();
+    if (rate_start_ns == 0) {
+        rate_start_ns = now;
+        rate_start_bytes = output_bytes;
+    } else if (now - rate_start_ns >= UI_RATE_WINDOW_NS) {
+        output_rate = (output_bytes - rate_start_bytes) * 1e9 / (now - rate_start_ns);
+        rate_start_ns = now;
+        rate_start_bytes = output_bytes;
+    }
+}
+
 // Signal handler for window resize
 void handle_resize(int sig) {
     (void)sig; // Suppress unused parameter warning
@@ -36,6 +112,8 @@ int ui_init(void) {
         init_pair(COLOR_DISK, COLOR_BLUE, COLOR_BLACK);
         init_pair(COLOR_NETWORK, COLOR_YELLOW, COLOR_BLACK);
         init_pair(COLOR_HEADER, COLOR_WHITE, COLOR_BLACK);
+        init_pair(COLOR_WARN, COLOR_YELLOW, COLOR_BLACK);
+        init_pair(COLOR_CRIT, COLOR_RED, COLOR_BLACK);
     }
 
     // Set up signal handler for window resize
@@ -44,13 +122,32 @@ int ui_init(void) {
     // Initialize layout
     g_layout.num_components = 0;
     g_layout.layout_dirty = 1;
+    g_layout.focused = 0;
 
     // Get initial terminal dimensions
     getmaxyx(stdscr, g_layout.terminal_height, g_layout.terminal_width);
 
+    // Output meter; without task I/O accounting the rate stays unknown
+    io_fd = open("/proc/self/io", O_RDONLY | O_CLOEXEC);
+    if (io_fd >= 0 && read_wchar() == 0) {
+        close(io_fd);
+        io_fd = -1;
+    }
+
     return 0;
 }
 
+void ui_set_low_bandwidth(int frame_bytes, double percent) {
+    frame_byte_cap = frame_bytes > 0 ? frame_bytes : 0;
+    coalesce_percent = percent > 0.0 ? percent : 0.0;
+    low_bandwidth = frame_byte_cap > 0 || coalesce_percent > 0.0;
+    g_layout.layout_dirty = 1;
+}
+
+double ui_output_rate(void) {
+    return output_rate;
+}
+
 void ui_cleanup(void) {
     // Clean up all component windows
     for (int i = 0; i < g_layout.num_components; i++) {
@@ -58,10 +155,17 @@ void ui_cleanup(void) {
             delwin(g_layout.components[i].window);
             g_layout.components[i].window = NULL;
         }
+        free(g_layout.components[i].shown);
+        g_layout.components[i].shown = NULL;
     }
 
     // End ncurses
     endwin();
+
+    if (io_fd >= 0) {
+        close(io_fd);
+        io_fd = -1;
+    }
 }
 
 void ui_calculate_layout(void) {
@@ -81,55 +185,61 @@ void ui_calculate_layout(void) {
     int available_width = g_layout.terminal_width - (2 * margin);
     int available_height = g_layout.terminal_height - (2 * margin);
 
-    // For 4 components, arrange in 2x2 grid
-    int component_width = (available_width - component_spacing) / 2;
-    int component_height = (available_height - component_spacing) / 2;
+    // Visible components fill a two-column grid in creation order; with
+    // the default four panels this is the 2x2 grid
+    int visible[MAX_COMPONENTS];
+    int count = 0;
+    for (int i = 0; i < g_layout.num_components; i++) {
+        if (g_layout.components[i].visible) {
+            visible[count++] = i;
+        }
+    }
+
+    int columns = (count > 1) ? 2 : 1;
+    int rows = (count + columns - 1) / columns;
+    if (rows < 1) rows = 1;
+
+    int component_width = (available_width - component_spacing * (columns - 1)) / columns;
+    int component_height = (available_height - component_spacing * (rows - 1)) / rows;
 
     // Ensure minimum component size
     if (component_width < 35) component_width = 35;
-    if (component_height < 8) component_height = 8;
+    if (component_height < 5) component_height = 5;
 
-    // CPU component (top-left)
-    if (g_layout.num_components > COMPONENT_CPU) {
-        g_layout.components[COMPONENT_CPU].x = margin;
-        g_layout.components[COMPONENT_CPU].y = margin;
-        g_layout.components[COMPONENT_CPU].width = component_width;
-        g_layout.components[COMPONENT_CPU].height = component_height;
-    }
+    for (int k = 0; k < count; k++) {
+        UIComponent *comp = &g_layout.components[visible[k]];
+        int row = k / columns;
+        int col = k % columns;
 
-    // Memory component (top-right)
-    if (g_layout.num_components > COMPONENT_MEMORY) {
-        g_layout.components[COMPONENT_MEMORY].x = margin + component_width + component_spacing;
-        g_layout.components[COMPONENT_MEMORY].y = margin;
-        g_layout.components[COMPONENT_MEMORY].width = component_width;
-        g_layout.components[COMPONENT_MEMORY].height = component_height;
-    }
+        comp->x = margin + col * (component_width + component_spacing);
+        comp->y = margin + row * (component_height + component_spacing);
+        comp->width = component_width;
+        comp->height = component_height;
 
-    // Disk component (bottom-left)
-    if (g_layout.num_components > COMPONENT_DISK) {
-        g_layout.components[COMPONENT_DISK].x = margin;
-        g_layout.components[COMPONENT_DISK].y = margin + component_height + component_spacing;
-        g_layout.components[COMPONENT_DISK].width = component_width;
-        g_layout.components[COMPONENT_DISK].height = component_height;
-    }
-
-    // Network component (bottom-right)
-    if (g_layout.num_components > COMPONENT_NETWORK) {
-        g_layout.components[COMPONENT_NETWORK].x = margin + component_width + component_spacing;
-        g_layout.components[COMPONENT_NETWORK].y = margin + component_height + component_spacing;
-        g_layout.components[COMPONENT_NETWORK].width = component_width;
-        g_layout.components[COMPONENT_NETWORK].height = component_height;
+        // A trailing component on its own spans the full row
+        if (k == count - 1 && col == 0 && columns > 1) {
+            comp->width = component_width * columns + component_spacing * (columns - 1);
+        }
     }
 
     // FIXED: Create windows after calculating layout
     for (int i = 0; i < g_layout.num_components; i++) {
         UIComponent *comp = &g_layout.components[i];
 
-        // Delete existing window if it exists
+        // Delete existing window if it exists; what it showed is gone too
         if (comp->window) {
             delwin(comp->window);
             comp->window = NULL;
         }
+        free(comp->shown);
+        comp->shown = NULL;
+        comp->frame_bytes = 0;
+        comp->deferred = 0;
+
+        // Hidden components have no window until shown
+        if (!comp->visible) {
+            continue;
+        }
 
         // Create new window with calculated dimensions
         comp->window = newwin(comp->height, comp->width, comp->y, comp->x);
@@ -137,6 +247,12 @@ void ui_calculate_layout(void) {
             fprintf(stderr, "Warning: Failed to create window for component %d\n", i);
             continue;
         }
+
+        // Coalescing remembers the values on screen; without the memory
+        // every change is drawn
+        if (coalesce_percent > 0.0 && comp->height > 3) {
+            comp->shown = calloc((size_t)(comp->height - 3) * RENDER_MAX_COLS, sizeof(UIShownCell));
+        }
     }
 
     g_layout.layout_dirty = 0;
@@ -157,7 +273,81 @@ void ui_handle_resize(void) {
 
         // Clear and refresh
         clear();
-        refresh();
+        wnoutrefresh(stdscr);
+        ui_flush();
+    }
+}
+
+// Low-bandwidth status on the top margin: measured rate and held panels
+static void ui_draw_status(int deferred) {
+    char rate[32] = "?";
+    char status[128];
+
+    if (output_rate >= 0.0) {
+        sysmon_format_bytes((unsigned long long)(output_rate + 0.5), rate, sizeof(rate));
+    }
+    int len = snprintf(status, sizeof(status), " low bandwidth: %s/s", rate);
+    if (frame_byte_cap > 0 && len > 0 && len < (int)sizeof(status)) {
+        len += snprintf(status + len, sizeof(status) - len, ", %d B/frame", frame_byte_cap);
+    }
+    if (deferred > 0 && len > 0 && len < (int)sizeof(status)) {
+        len += snprintf(status + len, sizeof(status) - len, ", %d held", deferred);
+    }
+    if (len <= 0) return;
+
+    move(0, 0);
+    clrtoeol();
+    mvaddnstr(0, 2, status, g_layout.terminal_width - 4);
+    wnoutrefresh(stdscr);
+}
+
+// Flush panels one at a time against the frame budget: the focused panel
+// always, then the longest-waiting ones while their last cost still fits.
+// A held panel keeps its pending changes and is redrawn from newer data.
+// Without /proc/self/io the cost is estimated from the touched cells.
+static void ui_refresh_budgeted(void) {
+    int order[MAX_COMPONENTS];
+    int count = 0;
+    int deferred = 0;
+
+    if (g_layout.focused < g_layout.num_components && g_layout.components[g_layout.focused].window) {
+        order[count++] = g_layout.focused;
+    }
+    int pinned = count;  // The focused panel, if any, leads and is never held
+    for (int i = 0; i < g_layout.num_components; i++) {
+        if (i == g_layout.focused || !g_layout.components[i].window) continue;
+
+        // Insertion by frames waited, longest first
+        int k = count;
+        while (k > pinned && g_layout.components[order[k - 1]].deferred < g_layout.components[i].deferred) {
+            order[k] = order[k - 1];
+            k--;
+        }
+        order[k] = i;
+        count++;
+    }
+    for (int i = 0; i < count; i++) {
+        if (g_layout.components[order[i]].deferred > 0) deferred++;
+    }
+
+    ui_draw_status(deferred);
+
+    unsigned long long spent = 0;
+    for (int k = 0; k < count; k++) {
+        UIComponent *comp = &g_layout.components[order[k]];
+        if (k >= pinned && frame_byte_cap > 0 && spent + comp->frame_bytes > (unsigned long long)frame_byte_cap &&
+            comp->deferred < UI_MAX_DEFERRED_FRAMES) {
+            comp->deferred++;
+            continue;
+        }
+
+        unsigned long long estimate = io_fd < 0 ? ui_estimate_bytes(comp->window) : 0;
+        wnoutrefresh(comp->window);
+        unsigned long long written = ui_flush();
+        if (io_fd < 0) written = estimate;
+        comp->frame_bytes = (int)written;
+        comp->deferred = 0;
+        spent += written;
     }
 }
 
@@ -165,15 +355,19 @@ void ui_refresh_all(void) {
     // Handle any pending resize
     ui_handle_resize();
 
-    // Refresh all component windows
-    for (int i = 0; i < g_layout.num_components; i++) {
-        if (g_layout.components[i].window) {
-            wrefresh(g_layout.components[i].window);
+    if (low_bandwidth) {
+        ui_refresh_budgeted();
+    } else {
+        // Refresh all component windows in one update
+        for (int i = 0; i < g_layout.num_components; i++) {
+            if (g_layout.components[i].window) {
+                wnoutrefresh(g_layout.components[i].window);
+            }
         }
+        ui_flush();
     }
 
-    // Refresh main screen
-    refresh();
+    update_output_rate();
 }
 
 void ui_clear_all(void) {
@@ -201,6 +395,14 @@ int ui_create_component(const char* title, int color_pair) {
     comp->title[sizeof(comp->title) - 1] = '\0';
     comp->color_pair = color_pair;
     comp->window = NULL; // Will be created during layout calculation
+    comp->visible = true;
+    comp->sort_column = -1;
+    comp->sort_descending = false;
+    comp->table_columns = 0;
+    comp->num_rows = 0;
+    comp->page_rows = 0;
+    comp->scroll_offset = 0;
+    comp->cursor = 0;
 
     g_layout.num_components++;
     g_layout.layout_dirty = 1;
@@ -214,6 +416,9 @@ void ui_update_component(int component_id, const char* content) {
     }
 
     UIComponent *comp = &g_layout.components[component_id];
+    if (!comp->visible) {
+        return;
+    }
     if (!comp->window) {
         fprintf(stderr, "Warning: Component %d window is NULL\n", component_id);
         return;
@@ -238,6 +443,380 @@ void ui_update_component(int component_id, const char* content) {
     }
 }
 
+// Narrowest width a flexible column is allowed to shrink to
+#define UI_FLEX_MIN_WIDTH 6
+
+// Place table columns inside the content area. Columns that do not fit are
+// dropped from the right, so tables list their most important columns first.
+static int ui_layout_columns(const RenderColumn *columns, int num_columns, int content_width,
+                             int *col_x, int *col_w) {
+    int visible = num_columns;
+
+    while (visible > 0) {
+        int used = visible - 1; // One space between columns
+        int flex = -1;
+
+        for (int i = 0; i < visible; i++) {
+            if (columns[i].width == 0 && flex < 0) {
+                flex = i;
+            } else {
+                used += columns[i].width;
+            }
+        }
+
+        int spare = content_width - used;
+        if ((flex >= 0 && spare >= UI_FLEX_MIN_WIDTH) || (flex < 0 && spare >= 0)) {
+            int x = 1; // Account for border
+            for (int i = 0; i < visible; i++) {
+                col_x[i] = x;
+                col_w[i] = (i == flex) ? spare : columns[i].width;
+                x += col_w[i] + 1;
+            }
+            return visible;
+        }
+
+        visible--;
+    }
+
+    return 0;
+}
+
+// Draw a single cell aligned inside its column
+static void ui_draw_cell(WINDOW *win, int y, int x, int width, const RenderColumn *column,
+                         const RenderCell *cell, attr_t row_attrs) {
+    char text[128];
+    int len = render_format_cell(cell, text, sizeof(text));
+    if (len <= 0) return;
+    if (len > (int)sizeof(text) - 1) len = sizeof(text) - 1;
+    if (len > width) len = width;
+
+    int offset = (column->align == ALIGN_RIGHT) ? width - len : 0;
+
+    // Threshold coloring for percentages
+    int color = 0;
+    if (has_colors() && cell->type == CELL_PERCENT) {
+        double value = cell->v.f;
+        if (column->crit > 0 && value >= column->crit) {
+            color = COLOR_CRIT;
+        } else if (column->warn > 0 && value >= column->warn) {
+            color = COLOR_WARN;
+        }
+    }
+
+    // Anomalies stand out even without colours
+    if (cell->anomaly) color = has_colors() ? COLOR_CRIT : 0;
+
+    attr_t attrs = row_attrs;
+    if (color) attrs |= COLOR_PAIR(color) | A_BOLD;
+    if (cell->anomaly) attrs |= A_REVERSE | A_BOLD;
+
+    wattron(win, attrs);
+    mvwaddnstr(win, y, x + offset, text, len);
+    wattroff(win, attrs);
+}
+
+static bool cell_number(const RenderCell *cell, double *value) {
+    switch (cell->type) {
+        case CELL_INT:      *value = (double)cell->v.i; return true;
+        case CELL_PERCENT:
+        case CELL_RATE:     *value = cell->v.f; return true;
+        case CELL_BYTES:    *value = (double)cell->v.bytes; return true;
+        case CELL_DURATION: *value = (double)cell->v.ns; return true;
+        default:            return false;
+    }
+}
+
+// FNV-1a over the formatted first cell, which names the row
+static unsigned int ui_row_key(const RenderCell *cell) {
+    char text[128];
+    int len = render_format_cell(cell, text, sizeof(text));
+    if (len > (int)sizeof(text) - 1) len = sizeof(text) - 1;
+
+    unsigned int hash = 2166136261u;
+    for (int i = 0; i < len; i++) {
+        hash = (hash ^ (unsigned char)text[i]) * 16777619u;
+    }
+    return hash;
+}
+
+// Keep drawing the value on screen until the new one has moved by more
+// than the coalescing threshold, measured against the value shown so the
+// error never builds up. Percentages compare in points.
+static void ui_coalesce_cell(UIShownCell *shown, unsigned int row_key, RenderCell *cell) {
+    double value, last;
+    if (!cell_number(cell, &value)) {
+        shown->valid = false;
+        return;
+    }
+
+    if (shown->valid && shown->row_key == row_key && shown->cell.type == cell->type &&
+        shown->cell.anomaly == cell->anomaly && cell_number(&shown->cell, &last)) {
+        double scale = (cell->type == CELL_PERCENT) ? 100.0 : fabs(last);
+        if (scale > 0.0 && 100.0 * fabs(value - last) <= coalesce_percent * scale) {
+            *cell = shown->cell;
+            return;
+        }
+    }
+
+    shown->cell = *cell;
+    shown->row_key = row_key;
+    shown->valid = true;
+}
+
+// Keep the cursor inside the list and on screen
+static void ui_clamp_scroll(UIComponent *comp) {
+    if (comp->cursor >= comp->num_rows) comp->cursor = comp->num_rows - 1;
+    if (comp->cursor < 0) comp->cursor = 0;
+
+    if (comp->page_rows <= 0) {
+        comp->scroll_offset = 0;
+        return;
+    }
+
+    if (comp->cursor < comp->scroll_offset) {
+        comp->scroll_offset = comp->cursor;
+    } else if (comp->cursor >= comp->scroll_offset + comp->page_rows) {
+        comp->scroll_offset = comp->cursor - comp->page_rows + 1;
+    }
+
+    int max_offset = comp->num_rows - comp->page_rows;
+    if (max_offset < 0) max_offset = 0;
+    if (comp->scroll_offset > max_offset) comp->scroll_offset = max_offset;
+    if (comp->scroll_offset < 0) comp->scroll_offset = 0;
+}
+
+void ui_render_list(int component_id, const RenderList *list) {
+    if (component_id < 0 || component_id >= g_layout.num_components || !list) {
+        return;
+    }
+
+    UIComponent *comp = &g_layout.components[component_id];
+    if (!comp->window) {
+        return;
+    }
+
+    WINDOW *win = comp->window;
+    werase(win);
+    ui_draw_component_border(component_id);
+    ui_draw_component_title(component_id);
+
+    comp->table_columns = list->sortable ? list->num_columns : 0;
+
+    if (list->message || !list->fill_row) {
+        comp->num_rows = 0;
+        ui_clamp_scroll(comp);
+        if (list->message) {
+            ui_wrap_text(win, 2, 1, list->message, ui_get_max_content_width(component_id));
+        }
+        return;
+    }
+
+    // Rows run from under the header to the bottom border
+    comp->num_rows = list->num_rows;
+    comp->page_rows = comp->height - 3;
+    ui_clamp_scroll(comp);
+
+    int col_x[RENDER_MAX_COLS], col_w[RENDER_MAX_COLS];
+    int visible = ui_layout_columns(list->columns, list->num_columns,
+                                    ui_get_max_content_width(component_id), col_x, col_w);
+
+    // Header goes on the spare line under the title
+    if (list->show_header) {
+        for (int c = 0; c < visible; c++) {
+            const RenderColumn *column = &list->columns[c];
+            const char *header = c == 0 && list->row_header ? list->row_header : column->header;
+            if (!header) header = "";
+            int len = strlen(header);
+            if (len > col_w[c]) len = col_w[c];
+
+            attr_t attrs = A_BOLD | A_UNDERLINE;
+            if (list->sortable && c == comp->sort_column) {
+                attrs |= A_REVERSE;
+            }
+
+            int offset = (column->align == ALIGN_RIGHT) ? col_w[c] - len : 0;
+            wattron(win, attrs);
+            mvwaddnstr(win, 1, col_x[c] + offset, header, len);
+            wattroff(win, attrs);
+        }
+    }
+
+    // Only the visible window of rows is filled and formatted
+    bool focused = (component_id == g_layout.focused);
+    int end = comp->scroll_offset + comp->page_rows;
+    if (end > list->num_rows) end = list->num_rows;
+
+    const int *order = NULL;
+    if (list->sortable && comp->sort_column >= 0 && comp->sort_column < list->num_columns) {
+        order = list->partial_order
+              ? render_list_top(list, comp->sort_column, comp->sort_descending, end)
+              : render_list_order(list, comp->sort_column, comp->sort_descending);
+    }
+
+    RenderRow row;
+    for (int r = comp->scroll_offset, y = 2; r < end; r++, y++) {
+        memset(&row, 0, sizeof(row));
+        list->fill_row(list->ctx, order ? order[r] : r, &row);
+
+        attr_t row_attrs = (focused && list->sortable && r == comp->cursor) ? A_REVERSE : A_NORMAL;
+        if (row_attrs != A_NORMAL) {
+            mvwchgat(win, y, 1, comp->width - 2, row_attrs, 0, NULL);
+        }
+
+        if (comp->shown) {
+            UIShownCell *shown = &comp->shown[(y - 2) * RENDER_MAX_COLS];
+            unsigned int key = ui_row_key(&row.cells[0]);
+            for (int c = 1; c < visible; c++) {
+                ui_coalesce_cell(&shown[c], key, &row.cells[c]);
+            }
+        }
+
+        for (int c = 0; c < visible; c++) {
+            ui_draw_cell(win, y, col_x[c], col_w[c], &list->columns[c], &row.cells[c], row_attrs);
+        }
+    }
+
+    // Position indicator on the bottom border when the list overflows
+    if (list->num_rows > comp->page_rows) {
+        char position[32];
+        int len = snprintf(position, sizeof(position), " %d-%d/%d ",
+                           comp->scroll_offset + 1, end, list->num_rows);
+        if (len > 0 && len < comp->width - 2) {
+            mvwaddnstr(win, comp->height - 1, comp->width - 1 - len, position, len);
+        }
+    }
+}
+
+void ui_render_table(int component_id, const RenderTable *table) {
+    if (!table) return;
+
+    RenderList list;
+    render_list_from_table(&list, table);
+    ui_render_list(component_id, &list);
+}
+
+// Move focus to the next visible component in the given direction
+static void ui_focus_next(int direction) {
+    int n = g_layout.num_components;
+    int id = g_layout.focused;
+
+    for (int step = 0; step < n; step++) {
+        id = (id + direction + n) % n;
+        if (g_layout.components[id].visible) {
+            g_layout.focused = id;
+            return;
+        }
+    }
+}
+
+void ui_set_component_alert(int component_id, bool alert) {
+    if (component_id < 0 || component_id >= g_layout.num_components) {
+        return;
+    }
+
+    g_layout.components[component_id].alert = alert;
+}
+
+void ui_set_component_sort(int component_id, int column, bool descending) {
+    if (component_id < 0 || component_id >= g_layout.num_components) {
+        return;
+    }
+
+    g_layout.components[component_id].sort_column = column;
+    g_layout.components[component_id].sort_descending = descending;
+}
+
+void ui_set_component_visible(int component_id, bool visible) {
+    if (component_id < 0 || component_id >= g_layout.num_components) {
+        return;
+    }
+
+    UIComponent *comp = &g_layout.components[component_id];
+    if (comp->visible == visible) {
+        return;
+    }
+
+    comp->visible = visible;
+    g_layout.layout_dirty = 1;
+
+    if (visible) {
+        g_layout.focused = component_id;
+    } else if (g_layout.focused == component_id) {
+        ui_focus_next(1);
+    }
+}
+
+bool ui_is_component_visible(int component_id) {
+    if (component_id < 0 || component_id >= g_layout.num_components) {
+        return false;
+    }
+
+    return g_layout.components[component_id].visible;
+}
+
+bool ui_handle_key(int ch) {
+    if (g_layout.num_components == 0) {
+        return false;
+    }
+
+    UIComponent *comp = &g_layout.components[g_layout.focused];
+
+    switch (ch) {
+        case '\t':
+            ui_focus_next(1);
+            return true;
+        case KEY_BTAB:
+            ui_focus_next(-1);
+            return true;
+        case 's':
+            // Cycle through the columns, then back to collection order
+            if (comp->table_columns == 0) return false;
+            comp->sort_column++;
+            if (comp->sort_column >= comp->table_columns) {
+                comp->sort_column = -1;
+            }
+            return true;
+        case 'S':
+            if (comp->table_columns == 0) return false;
+            comp->sort_descending = !comp->sort_descending;
+            return true;
+        case KEY_UP:
+        case 'k':
+            comp->cursor--;
+            break;
+        case KEY_DOWN:
+        case 'j':
+            comp->cursor++;
+            break;
+        case KEY_PPAGE:
+            comp->cursor -= comp->page_rows > 1 ? comp->page_rows - 1 : 1;
+            break;
+        case KEY_NPAGE:
+        case ' ':
+            comp->cursor += comp->page_rows > 1 ? comp->page_rows - 1 : 1;
+            break;
+        case KEY_HOME:
+        case 'g':
+            comp->cursor = 0;
+            break;
+        case KEY_END:
+        case 'G':
+            comp->cursor = comp->num_rows - 1;
+            break;
+        default:
+            return false;
+    }
+
+    // Navigation keys only matter for components holding rows
+    if (comp->num_rows == 0) {
+        comp->cursor = 0;
+        return false;
+    }
+
+    ui_clamp_scroll(comp);
+    return true;
+}
+
 void ui_draw_component_border(int component_id) {
     if (component_id < 0 || component_id >= g_layout.num_components) {
         return;
@@ -248,18 +827,20 @@ void ui_draw_component_border(int component_id) {
         return;
     }
 
-    // Enable color for this component
-    if (has_colors()) {
-        wattron(comp->window, COLOR_PAIR(comp->color_pair));
+    // Enable color for this component, red and bold while an alert fires
+    attr_t attrs = 0;
+    if (comp->alert) {
+        attrs = A_BOLD | (has_colors() ? COLOR_PAIR(COLOR_CRIT) : A_STANDOUT);
+    } else if (has_colors()) {
+        attrs = COLOR_PAIR(comp->color_pair);
     }
+    wattron(comp->window, attrs);
 
     // Draw border
     box(comp->window, 0, 0);
 
     // Disable color
-    if (has_colors()) {
-        wattroff(comp->window, COLOR_PAIR(comp->color_pair));
-    }
+    wattroff(comp->window, attrs);
 }
 
 void ui_draw_component_title(int component_id) {
@@ -272,18 +853,21 @@ void ui_draw_component_title(int component_id) {
         return;
     }
 
-    // Enable color and bold for title
+    // Enable color and bold for title, reversed when focused
+    attr_t attrs = A_BOLD;
+    if (component_id == g_layout.focused) {
+        attrs |= A_REVERSE;
+    }
     if (has_colors()) {
-        wattron(comp->window, COLOR_PAIR(comp->color_pair) | A_BOLD);
+        attrs |= COLOR_PAIR(comp->color_pair);
     }
+    wattron(comp->window, attrs);
 
     // Draw title centered on top border
     ui_center_text(comp->window, 0, comp->title, comp->width - 2);
 
     // Disable attributes
-    if (has_colors()) {
-        wattroff(comp->window, COLOR_PAIR(comp->color_pair) | A_BOLD);
-    }
+    wattroff(comp->window, attrs);
 }
 
 void ui_center_text(WINDOW* win, int y, const char* text, int width) {
@@ -304,19 +888,9 @@ void ui_wrap_text(WINDOW* win, int start_y, int start_x, const char* text, int m
     int current_x = start_x;
     int text_len = strlen(text);
     int pos = 0;
+    int height = getmaxy(win);
 
-    // Find the component that owns this window for height checking
-    UIComponent *comp = NULL;
-    for (int i = 0; i < g_layout.num_components; i++) {
-        if (g_layout.components[i].window == win) {
-            comp = &g_layout.components[i];
-            break;
-        }
-    }
-
-    if (!comp) return;
-
-    while (pos < text_len && current_y < comp->height - 1) {
+    while (pos < text_len && current_y < height - 1) {
         // Handle newlines in the text
         char *newline = strchr(&text[pos], '\n');
         int line_end = pos + max_width;
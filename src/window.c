@@ -0,0 +1,201 @@
+#include "window.h"
+#include <stdlib.h>
+#include <string.h>
+
+static int capacity_for(unsigned long long span_ns, unsigned long long interval_ns) {
+    unsigned long long samples = interval_ns ? span_ns / interval_ns + 1 : WINDOW_MAX_SAMPLES;
+    if (samples < 2) samples = 2;
+    if (samples > WINDOW_MAX_SAMPLES) samples = WINDOW_MAX_SAMPLES;
+    return (int)samples;
+}
+
+static void release(WindowBank *bank) {
+    free(bank->values);
+    free(bank->times_ms);
+    free(bank->min_deque);
+    free(bank->max_deque);
+    free(bank->buckets);
+    free(bank->state);
+    bank->values = NULL;
+    bank->times_ms = NULL;
+    bank->min_deque = NULL;
+    bank->max_deque = NULL;
+    bank->buckets = NULL;
+    bank->state = NULL;
+    bank->allocated = 0;
+}
+
+int window_bank_init(WindowBank *bank, unsigned long long span_ns, unsigned long long interval_ns) {
+    if (!bank) return -1;
+
+    memset(bank, 0, sizeof(WindowBank));
+    bank->span_ns = span_ns;
+    bank->capacity = capacity_for(span_ns, interval_ns);
+    return 0;
+}
+
+void window_bank_free(WindowBank *bank) {
+    if (!bank) return;
+
+    release(bank);
+    memset(bank, 0, sizeof(WindowBank));
+}
+
+static bool grow(void **array, size_t stripe_size, int old_count, int new_count) {
+    void *grown = realloc(*array, (size_t)new_count * stripe_size);
+    if (!grown) return false;
+
+    memset((unsigned char *)grown + (size_t)old_count * stripe_size, 0,
+           (size_t)(new_count - old_count) * stripe_size);
+    *array = grown;
+    return true;
+}
+
+int window_bank_reserve(WindowBank *bank, int count) {
+    if (!bank || count < 0) return -1;
+
+    if (count > bank->allocated) {
+        int allocated = bank->allocated ? bank->allocated : 4;
+        while (allocated < count) allocated *= 2;
+
+        size_t cap = (size_t)bank->capacity;
+        if (!grow((void **)&bank->values, cap * sizeof(float), bank->allocated, allocated) ||
+            !grow((void **)&bank->times_ms, cap * sizeof(unsigned int), bank->allocated, allocated) ||
+            !grow((void **)&bank->min_deque, cap * sizeof(unsigned short), bank->allocated, allocated) ||
+            !grow((void **)&bank->max_deque, cap * sizeof(unsigned short), bank->allocated, allocated) ||
+            !grow((void **)&bank->buckets, HISTOGRAM_BUCKETS * sizeof(unsigned short), bank->allocated, allocated) ||
+            !grow((void **)&bank->state, sizeof(WindowState), bank->allocated, allocated)) {
+            return -1;
+        }
+        bank->allocated = allocated;
+    }
+
+    if (count > bank->count) {
+        bank->count = count;
+    }
+    return 0;
+}
+
+int window_bank_set_span(WindowBank *bank, unsigned long long span_ns, unsigned long long interval_ns) {
+    if (!bank) return -1;
+
+    int count = bank->count;
+    release(bank);
+    bank->span_ns = span_ns;
+    bank->capacity = capacity_for(span_ns, interval_ns);
+    bank->count = 0;
+    return window_bank_reserve(bank, count);
+}
+
+static int sketch_bucket(double value) {
+    return histogram_bucket(value > 0 ? (unsigned long long)(value * WINDOW_SKETCH_SCALE) : 0);
+}
+
+static void clear(WindowBank *bank, int index) {
+    memset(&bank->buckets[(size_t)index * HISTOGRAM_BUCKETS], 0, HISTOGRAM_BUCKETS * sizeof(unsigned short));
+    memset(&bank->state[index], 0, sizeof(WindowState));
+}
+
+// Drop the oldest sample, and it from the deque fronts if it leads them
+static void evict(WindowBank *bank, int index) {
+    WindowState *w = &bank->state[index];
+    size_t base = (size_t)index * bank->capacity;
+    int oldest = w->head;
+    double value = bank->values[base + oldest];
+
+    w->sum -= value;
+    bank->buckets[(size_t)index * HISTOGRAM_BUCKETS + sketch_bucket(value)]--;
+
+    if (w->min_size > 0 && bank->min_deque[base + w->min_head] == oldest) {
+        w->min_head = (w->min_head + 1) % bank->capacity;
+        w->min_size--;
+    }
+    if (w->max_size > 0 && bank->max_deque[base + w->max_head] == oldest) {
+        w->max_head = (w->max_head + 1) % bank->capacity;
+        w->max_size--;
+    }
+
+    w->head = (w->head + 1) % bank->capacity;
+    if (--w->size == 0) {
+        w->sum = 0.0; // No float drift survives an empty window
+    }
+}
+
+void window_bank_push(WindowBank *bank, int index, unsigned int tag, double value, unsigned long long now_ns) {
+    if (!bank || index < 0 || index >= bank->count) return;
+
+    WindowState *w = &bank->state[index];
+    if (w->tag != tag) {
+        clear(bank, index);
+        w->tag = tag;
+    }
+
+    int cap = bank->capacity;
+    size_t base = (size_t)index * cap;
+    unsigned int now_ms = (unsigned int)(now_ns / 1000000ULL);
+    unsigned int span_ms = (unsigned int)(bank->span_ns / 1000000ULL);
+
+    while (w->size > 0 && now_ms - bank->times_ms[base + w->head] >= span_ms) {
+        evict(bank, index);
+    }
+    if (w->size == cap) {
+        evict(bank, index);
+    }
+
+    int slot = (w->head + w->size) % cap;
+    bank->values[base + slot] = (float)value;
+    bank->times_ms[base + slot] = now_ms;
+    w->size++;
+
+    // Sum and sketch take the stored float, which evict reads back, so a
+    // value rounding across a bucket edge leaves and enters the same bucket
+    float stored = bank->values[base + slot];
+    w->sum += stored;
+    bank->buckets[(size_t)index * HISTOGRAM_BUCKETS + sketch_bucket(stored)]++;
+
+    // Deques keep increasing (min) or decreasing (max) values; anything
+    // the new sample beats can never be the extreme again
+    while (w->min_size > 0 &&
+           bank->values[base + bank->min_deque[base + (w->min_head + w->min_size - 1) % cap]] >= stored) {
+        w->min_size--;
+    }
+    bank->min_deque[base + (w->min_head + w->min_size) % cap] = (unsigned short)slot;
+    w->min_size++;
+
+    while (w->max_size > 0 &&
+           bank->values[base + bank->max_deque[base + (w->max_head + w->max_size - 1) % cap]] <= stored) {
+        w->max_size--;
+    }
+    bank->max_deque[base + (w->max_head + w->max_size) % cap] = (unsigned short)slot;
+    w->max_size++;
+}
+
+bool window_bank_stats(const WindowBank *bank, int index, WindowStats *stats) {
+    if (!bank || !stats || index < 0 || index >= bank->count) return false;
+
+    const WindowState *w = &bank->state[index];
+    if (w->size == 0) return false;
+
+    size_t base = (size_t)index * bank->capacity;
+    stats->min = bank->values[base + bank->min_deque[base + w->min_head]];
+    stats->max = bank->values[base + bank->max_deque[base + w->max_head]];
+    stats->avg = w->sum / w->size;
+    stats->samples = w->size;
+
+    // Walk the sketch to the 95th percentile sample, then keep the bucket
+    // midpoint inside the exact extremes
+    const unsigned short *counts = &bank->buckets[(size_t)index * HISTOGRAM_BUCKETS];
+    int target = (int)(0.95 * w->size + 0.999999);
+    int seen = 0;
+    int bucket = 0;
+    for (; bucket < HISTOGRAM_BUCKETS - 1; bucket++) {
+        seen += counts[bucket];
+        if (seen >= target) break;
+    }
+
+    double p95 = histogram_bucket_value(bucket) / WINDOW_SKETCH_SCALE;
+    if (p95 < stats->min) p95 = stats->min;
+    if (p95 > stats->max) p95 = stats->max;
+    stats->p95 = p95;
+    return true;
+}